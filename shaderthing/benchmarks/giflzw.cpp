@@ -0,0 +1,333 @@
+/*
+ _____________________
+|                     |  This file is part of ShaderThing - A GUI-based live
+|   ___  _________    |  shader editor by Stefan Radman (a.k.a., virmodoetiae).
+|  /\  \/\__    __\   |  For more information, visit:
+|  \ \  \/__/\  \_/   |
+|   \ \__   \ \  \    |  https://github.com/virmodoetiae/shaderthing
+|    \/__/\  \ \  \   |
+|        \ \__\ \__\  |  SPDX-FileCopyrightText:    2025 Stefan Radman
+|  Ↄ|C    \/__/\/__/  |                             sradman@protonmail.com
+|  Ↄ|C                |  SPDX-License-Identifier:   Zlib
+|_____________________|
+
+*/
+
+// Checks that the LZW packer of vir::GifEncoder produces exactly the same TABLE
+// BASED IMAGE DATA bytes as the bit-at-a-time writer of gif-h it replaced, and
+// compares the throughput of the two. Returns a non-zero exit code if any
+// output differs. Usage: benchmark_giflzw [width height [nFrames]]
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "vir/include/vir.h"
+
+namespace
+{
+
+// Exposes the protected LZW encoder of vir::GifEncoder
+struct GifEncoderAccess : vir::GifEncoder
+{
+    using GifEncoder::LZWEncoder;
+};
+
+// Reference LZW writer, as found in GifEncoder::encodeIndexedFrame before the
+// packer was rewritten (i.e., the scheme of https://github.com/charlietangora/
+// gif-h, licensed under the "Unlicense" license), writing to a byte vector
+// instead of a file, and re-mapping indices via indexMap
+void referenceEncode
+(
+    const unsigned char* indices,
+    uint32_t stride,
+    uint32_t width,
+    uint32_t height,
+    bool flipVertically,
+    const unsigned char* indexMap,
+    uint32_t minCodeSize,
+    std::vector<unsigned char>& output
+)
+{
+    typedef struct
+    {
+        uint16_t next[256];
+    } GifLZWNode;
+
+    typedef struct
+    {
+        uint8_t  bitIndex;
+        uint8_t  byte;
+        uint32_t chunkIndex;
+        uint8_t  chunk[256];
+    } GifBitStatus;
+
+    const uint32_t clearCode = 1 << minCodeSize;
+    GifLZWNode* codetree = (GifLZWNode*)malloc(sizeof(GifLZWNode)*4096);
+    memset(codetree, 0, sizeof(GifLZWNode)*4096);
+    int32_t curCode = -1;
+    uint32_t codeSize = (uint32_t)minCodeSize + 1;
+    uint32_t maxCode = clearCode+1;
+    GifBitStatus stat;
+    stat.byte = 0;
+    stat.bitIndex = 0;
+    stat.chunkIndex = 0;
+
+    auto GifWriteBit = [](GifBitStatus* stat, uint32_t bit)
+    {
+        bit = bit & 1;
+        bit = bit << stat->bitIndex;
+        stat->byte |= bit;
+        ++stat->bitIndex;
+        if( stat->bitIndex > 7 )
+        {
+            stat->chunk[stat->chunkIndex++] = stat->byte;
+            stat->bitIndex = 0;
+            stat->byte = 0;
+        }
+    };
+
+    auto GifWriteChunk = [](std::vector<unsigned char>& output, GifBitStatus* stat)
+    {
+        output.push_back((unsigned char)stat->chunkIndex);
+        output.insert(output.end(), stat->chunk, stat->chunk+stat->chunkIndex);
+        stat->bitIndex = 0;
+        stat->byte = 0;
+        stat->chunkIndex = 0;
+    };
+
+    auto GifWriteCode = [GifWriteBit, GifWriteChunk]
+    (
+        std::vector<unsigned char>& output,
+        GifBitStatus* stat,
+        uint32_t code,
+        uint32_t length
+    )
+    {
+        for( uint32_t ii=0; ii<length; ++ii )
+        {
+            GifWriteBit(stat, code);
+            code = code >> 1;
+            if( stat->chunkIndex == 255 )
+                GifWriteChunk(output, stat);
+        }
+    };
+
+    GifWriteCode(output, &stat, clearCode, codeSize);
+    for(uint32_t y=0; y<height; ++y)
+    {
+        for(uint32_t x=0; x<width; ++x)
+        {
+            uint8_t nextValue = indexMap
+            [
+                indices[(flipVertically ? height-1-y : y)*stride+x]
+            ];
+            if( curCode < 0 )
+                curCode = nextValue;
+            else if( codetree[curCode].next[nextValue] )
+                curCode = codetree[curCode].next[nextValue];
+            else
+            {
+                GifWriteCode(output, &stat, (uint32_t)curCode, codeSize);
+                codetree[curCode].next[nextValue] = (uint16_t)++maxCode;
+                if( maxCode >= (1ul << codeSize) )
+                    codeSize++;
+                if( maxCode == 4095 )
+                {
+                    GifWriteCode(output, &stat, clearCode, codeSize);
+                    memset(codetree, 0, sizeof(GifLZWNode)*4096);
+                    codeSize = (uint32_t)(minCodeSize + 1);
+                    maxCode = clearCode+1;
+                }
+                curCode = nextValue;
+            }
+        }
+    }
+    GifWriteCode(output, &stat, (uint32_t)curCode, codeSize);
+    GifWriteCode(output, &stat, clearCode, codeSize);
+    GifWriteCode(output, &stat, clearCode + 1, (uint32_t)minCodeSize + 1);
+    while( stat.bitIndex ) GifWriteBit(&stat, 0);
+    if( stat.chunkIndex ) GifWriteChunk(output, &stat);
+    free(codetree);
+}
+
+// Kinds of generated frames, ranging from poorly to highly compressible
+enum class Pattern
+{
+    Random,
+    Sparse,
+    Runs
+};
+
+const char* patternName(Pattern pattern)
+{
+    switch (pattern)
+    {
+        case Pattern::Random : return "random";
+        case Pattern::Sparse : return "sparse";
+        case Pattern::Runs :   return "runs";
+    }
+    return "";
+}
+
+// Fills indices with values in [0, nIndices)
+void generateFrame
+(
+    std::vector<unsigned char>& indices,
+    uint32_t nIndices,
+    Pattern pattern,
+    std::mt19937& generator
+)
+{
+    std::uniform_int_distribution<uint32_t> index(0, nIndices-1);
+    std::uniform_int_distribution<uint32_t> percent(0, 99);
+    std::uniform_int_distribution<uint32_t> runLength(1, 64);
+    for (size_t i=0; i<indices.size(); )
+    {
+        switch (pattern)
+        {
+            case Pattern::Random :
+                indices[i++] = (unsigned char)index(generator);
+                break;
+            case Pattern::Sparse :
+                indices[i++] =
+                    percent(generator) < 5 ? (unsigned char)index(generator) : 0;
+                break;
+            case Pattern::Runs :
+            {
+                auto value = (unsigned char)index(generator);
+                size_t end = std::min(indices.size(), i+runLength(generator));
+                for (; i<end; i++)
+                    indices[i] = value;
+                break;
+            }
+        }
+    }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t width = 512;
+    uint32_t height = 512;
+    uint32_t nFrames = 20;
+    if (argc >= 3)
+    {
+        width = std::max(std::atoi(argv[1]), 1);
+        height = std::max(std::atoi(argv[2]), 1);
+    }
+    if (argc >= 4)
+        nFrames = std::max(std::atoi(argv[3]), 1);
+
+    std::mt19937 generator(12345);
+    std::vector<unsigned char> indices((size_t)width*height);
+    std::vector<unsigned char> reference;
+    std::vector<unsigned char> output;
+    unsigned char indexMap[256];
+    GifEncoderAccess::LZWEncoder encoder;
+    int nMismatches = 0;
+
+    // Byte identity, with the same encoder re-used across all frames, so that
+    // stale code tree nodes from previous frames are exercised too. Both the
+    // Default and the shifted Alpha/Delta index maps are checked, as well as
+    // sub-regions (i.e., width smaller than the stride)
+    for (uint32_t bitDepth=1; bitDepth<=8; bitDepth++)
+    {
+        uint32_t nIndices = 1 << bitDepth;
+        for (auto pattern : {Pattern::Random, Pattern::Sparse, Pattern::Runs})
+        {
+            for (int shiftIndices=0; shiftIndices<2; shiftIndices++)
+            {
+                for (uint32_t i=0; i<256; i++)
+                    indexMap[i] = shiftIndices ? (i+1)%nIndices : i;
+                for (int flip=0; flip<2; flip++)
+                {
+                    for (int subRegion=0; subRegion<2; subRegion++)
+                    {
+                        generateFrame(indices, nIndices, pattern, generator);
+                        uint32_t x = subRegion ? width/5 : 0;
+                        uint32_t y = subRegion ? height/3 : 0;
+                        uint32_t w = subRegion ? width/2+1 : width;
+                        uint32_t h = subRegion ? height/2+1 : height;
+                        reference.clear();
+                        output.clear();
+                        const unsigned char* data =
+                            indices.data()+(size_t)y*width+x;
+                        referenceEncode
+                        (
+                            data, width, w, h, flip, indexMap, bitDepth,
+                            reference
+                        );
+                        encoder.encode
+                        (
+                            data, width, w, h, flip, indexMap, bitDepth,
+                            output
+                        );
+                        if (output == reference)
+                            continue;
+                        nMismatches++;
+                        std::cout
+                            << "Mismatch: " << bitDepth << "-bit, "
+                            << patternName(pattern)
+                            << (shiftIndices ? ", shifted indices" : "")
+                            << (flip ? ", flipped" : "")
+                            << (subRegion ? ", sub-region" : "") << std::endl;
+                    }
+                }
+            }
+        }
+    }
+    std::cout
+        << "Byte identity: " << (nMismatches == 0 ? "OK" : "FAILED")
+        << std::endl;
+
+    // Throughput, over nFrames frames of each pattern with 8-bit indices
+    for (uint32_t i=0; i<256; i++)
+        indexMap[i] = i;
+    for (auto pattern : {Pattern::Random, Pattern::Sparse, Pattern::Runs})
+    {
+        std::vector<std::vector<unsigned char>> frames(nFrames, indices);
+        for (auto& frame : frames)
+            generateFrame(frame, 256, pattern, generator);
+        auto time = [&](auto encode)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (auto& frame : frames)
+            {
+                output.clear();
+                encode(frame.data());
+            }
+            return std::chrono::duration<double>
+            (
+                std::chrono::steady_clock::now()-start
+            ).count();
+        };
+        double referenceTime = time([&](const unsigned char* frame)
+        {
+            referenceEncode
+            (
+                frame, width, width, height, false, indexMap, 8, output
+            );
+        });
+        double encoderTime = time([&](const unsigned char* frame)
+        {
+            encoder.encode
+            (
+                frame, width, width, height, false, indexMap, 8, output
+            );
+        });
+        double megaPixels = 1e-6*width*height*nFrames;
+        std::cout
+            << patternName(pattern) << ": reference "
+            << megaPixels/referenceTime << " Mpx/s, encoder "
+            << megaPixels/encoderTime << " Mpx/s ("
+            << referenceTime/encoderTime << "x)" << std::endl;
+    }
+
+    return nMismatches == 0 ? 0 : 1;
+}
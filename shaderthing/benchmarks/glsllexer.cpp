@@ -0,0 +1,206 @@
+/*
+ _____________________
+|                     |  This file is part of ShaderThing - A GUI-based live
+|   ___  _________    |  shader editor by Stefan Radman (a.k.a., virmodoetiae).
+|  /\  \/\__    __\   |  For more information, visit:
+|  \ \  \/__/\  \_/   |
+|   \ \__   \ \  \    |  https://github.com/virmodoetiae/shaderthing
+|    \/__/\  \ \  \   |
+|        \ \__\ \__\  |  SPDX-FileCopyrightText:    2025 Stefan Radman
+|  Ↄ|C    \/__/\/__/  |                             sradman@protonmail.com
+|  Ↄ|C                |  SPDX-License-Identifier:   Zlib
+|_____________________|
+
+*/
+
+// Compares the hand-written GLSL lexer of the TextEditor against the regex list
+// it replaced (still stored in the GLSL language definition), by tokenizing a
+// generated GLSL source line by line with both, as done in
+// TextEditor::colorizeRange. Reports the time taken by each and the number of
+// characters colored differently. Usage: benchmark_glsllexer [nLines]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "shaderthing/include/texteditor.h"
+
+namespace
+{
+
+typedef ShaderThing::TextEditor::PaletteIndex PaletteIndex;
+typedef ShaderThing::TextEditor::LanguageDefinition LanguageDefinition;
+
+// Representative shader code, repeated until the requested number of lines is
+// reached
+const char* sourceSnippet =
+R"(#define PI 3.14159265
+#define ROTATE(a) mat2(cos(a), -sin(a), sin(a), cos(a))
+
+/* Multi-line comment with "quotes",
+   numbers 0x1F 42u and 'c' chars */
+uniform sampler2D iChannel0;
+const uint seed = 0x9E3779B9u;
+
+float hash(vec2 p)
+{
+    p = fract(p*vec2(123.34, 456.21)); // Single-line comment
+    p += dot(p, p+45.32e-1);
+    return fract(p.x*p.y);
+}
+
+void main()
+{
+    vec2 uv = (gl_FragCoord.xy-.5*iResolution.xy)/iResolution.y;
+    uv *= ROTATE(iTime*.25f);
+    int n = int(floor(uv.x*8.0)) % 3;
+    vec3 col = texture(iChannel0, uv).rgb*hash(uv+float(n));
+    if (col.r > 0.5 && col.g <= 1e3 || !(col.b == 2.))
+        col = vec3(1.0-col.r, col.g, col.b);
+    fragColor = vec4(col, 1.0);
+}
+)";
+
+// Tokenizes each line from start to end and stores the color of each of its
+// characters, with the same fallback logic as TextEditor::colorizeRange
+template<typename Tokenize>
+double colorize
+(
+    const std::vector<std::string>& lines,
+    std::vector<std::vector<PaletteIndex>>& colors,
+    Tokenize tokenize
+)
+{
+    auto start = std::chrono::steady_clock::now();
+    colors.resize(lines.size());
+    for (size_t i=0; i<lines.size(); i++)
+    {
+        const std::string& line = lines[i];
+        auto& lineColors = colors[i];
+        lineColors.assign(line.size(), PaletteIndex::Default);
+        if (line.empty())
+            continue;
+        const char* bufferBegin = line.data();
+        const char* last = bufferBegin + line.size();
+        for (auto first = bufferBegin; first != last; )
+        {
+            const char* tokenBegin = nullptr;
+            const char* tokenEnd = nullptr;
+            PaletteIndex tokenColor = PaletteIndex::Default;
+            if (!tokenize(first, last, tokenBegin, tokenEnd, tokenColor))
+            {
+                first++;
+                continue;
+            }
+            for (auto c = tokenBegin; c != tokenEnd; c++)
+                lineColors[c-bufferBegin] = tokenColor;
+            first = tokenEnd;
+        }
+    }
+    return std::chrono::duration<double>
+    (
+        std::chrono::steady_clock::now()-start
+    ).count();
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    size_t nLines = 20000;
+    if (argc >= 2)
+        nLines = std::max(std::atoi(argv[1]), 1);
+
+    std::vector<std::string> lines;
+    while (lines.size() < nLines)
+    {
+        std::string snippet(sourceSnippet);
+        size_t start = 0;
+        size_t end;
+        while
+        (
+            lines.size() < nLines &&
+            (end = snippet.find('\n', start)) != std::string::npos
+        )
+        {
+            lines.push_back(snippet.substr(start, end-start));
+            start = end+1;
+        }
+    }
+
+    const LanguageDefinition& glsl = LanguageDefinition::GLSL();
+    std::vector<std::pair<std::regex, PaletteIndex>> regexList;
+    for (auto& r : glsl.tokenRegexStrings)
+        regexList.push_back
+        (
+            std::make_pair
+            (
+                std::regex(r.first, std::regex_constants::optimize),
+                r.second
+            )
+        );
+
+    std::vector<std::vector<PaletteIndex>> lexerColors;
+    std::vector<std::vector<PaletteIndex>> regexColors;
+    double lexerTime = colorize(lines, lexerColors, glsl.tokenize);
+    std::cmatch results;
+    double regexTime = colorize
+    (
+        lines,
+        regexColors,
+        [&]
+        (
+            const char* first,
+            const char* last,
+            const char*& tokenBegin,
+            const char*& tokenEnd,
+            PaletteIndex& tokenColor
+        )
+        {
+            for (auto& p : regexList)
+            {
+                if
+                (
+                    std::regex_search
+                    (
+                        first,
+                        last,
+                        results,
+                        p.first,
+                        std::regex_constants::match_continuous
+                    )
+                )
+                {
+                    auto& v = *results.begin();
+                    tokenBegin = v.first;
+                    tokenEnd = v.second;
+                    tokenColor = p.second;
+                    return true;
+                }
+            }
+            return false;
+        }
+    );
+
+    // Differences are expected for hex literals and integer suffixes, which
+    // the regex list colors as a number followed by an identifier
+    size_t nCharacters = 0;
+    size_t nDifferences = 0;
+    for (size_t i=0; i<lines.size(); i++)
+    {
+        nCharacters += lines[i].size();
+        for (size_t j=0; j<lines[i].size(); j++)
+            nDifferences += lexerColors[i][j] != regexColors[i][j];
+    }
+    std::cout
+        << lines.size() << " lines, " << nCharacters << " characters"
+        << std::endl
+        << "regex list: " << 1e3*regexTime << " ms" << std::endl
+        << "lexer:      " << 1e3*lexerTime << " ms ("
+        << regexTime/lexerTime << "x)" << std::endl
+        << "characters colored differently: " << nDifferences << std::endl;
+    return 0;
+}
@@ -0,0 +1,184 @@
+/*
+ _____________________
+|                     |  This file is part of ShaderThing - A GUI-based live
+|   ___  _________    |  shader editor by Stefan Radman (a.k.a., virmodoetiae).
+|  /\  \/\__    __\   |  For more information, visit:
+|  \ \  \/__/\  \_/   |
+|   \ \__   \ \  \    |  https://github.com/virmodoetiae/shaderthing
+|    \/__/\  \ \  \   |
+|        \ \__\ \__\  |  SPDX-FileCopyrightText:    2025 Stefan Radman
+|  Ↄ|C    \/__/\/__/  |                             sradman@protonmail.com
+|  Ↄ|C                |  SPDX-License-Identifier:   Zlib
+|_____________________|
+
+*/
+
+// Times the GPU quantizer on a generated image, on an offscreen OpenGL context,
+// for the settings used by the GIF exports. Each quantize call is timed both
+// with a GPU timer query and with the host wall-clock time (including the final
+// host-device sync). Only the public Quantizer interface is used, so that any
+// other implementation of the OpenGLQuantizer can be dropped in and compared.
+// Usage: benchmark_quantizer [width height [nCalls]]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "vir/include/vir.h"
+
+namespace
+{
+
+struct Case
+{
+    std::string               name;
+    unsigned int              paletteSize;
+    vir::Quantizer::Settings  settings;
+};
+
+// Smooth color gradients with some noise, so that the KMeans clustering does
+// not converge trivially
+std::vector<unsigned char> generateImage(uint32_t width, uint32_t height)
+{
+    std::vector<unsigned char> data(4*(size_t)width*height);
+    uint32_t state = 12345;
+    for (uint32_t y=0; y<height; y++)
+    {
+        for (uint32_t x=0; x<width; x++)
+        {
+            state = state*1664525u+1013904223u;
+            float noise = ((state >> 24)/255.f-.5f)*.1f;
+            float u = (float)x/width;
+            float v = (float)y/height;
+            float c[3] =
+            {
+                .5f+.5f*std::sin(6.f*u+noise),
+                .5f+.5f*std::sin(5.f*v+2.f+noise),
+                .5f+.5f*std::sin(7.f*(u+v)+4.f+noise)
+            };
+            unsigned char* pixel = &data[4*((size_t)y*width+x)];
+            for (int i=0; i<3; i++)
+                pixel[i] = (unsigned char)(255.f*std::clamp(c[i], 0.f, 1.f));
+            pixel[3] = 255;
+        }
+    }
+    return data;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t width = 1024;
+    uint32_t height = 1024;
+    unsigned int nCalls = 10;
+    if (argc >= 3)
+    {
+        width = std::max(std::atoi(argv[1]), 1);
+        height = std::max(std::atoi(argv[2]), 1);
+    }
+    if (argc >= 4)
+        nCalls = std::max(std::atoi(argv[3]), 1);
+
+    vir::Settings settings = {};
+    settings.windowName = "benchmark_quantizer";
+    settings.width = width;
+    settings.height = height;
+    settings.headless = true;
+    settings.initializeImGuiRenderer = false;
+    try
+    {
+        vir::initialize(settings);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Could not create an offscreen OpenGL context: "
+                  << e.what() << std::endl;
+        return 1;
+    }
+
+    auto quantizer = vir::Quantizer::create(vir::Quantizer::Device::GPU);
+    auto timerQuery = vir::TimerQuery::create();
+    if (quantizer == nullptr)
+    {
+        std::cerr << "The GPU quantizer is not available" << std::endl;
+        return 1;
+    }
+
+    std::vector<Case> cases(4);
+    cases[0].name = "reseed + KMeans";
+    cases[0].paletteSize = 256;
+    cases[0].settings.reseedPalette = true;
+    cases[1].name = "KMeans";
+    cases[1].paletteSize = 256;
+    cases[2].name = "KMeans, 8 iterations, dithered";
+    cases[2].paletteSize = 256;
+    cases[2].settings.maxIterations = 8;
+    cases[2].settings.ditherMode = vir::Quantizer::Settings::DitherMode::Order4;
+    cases[2].settings.ditherThreshold = .25f;
+    cases[3].name = "KMeans, 8 iterations, delta";
+    cases[3].paletteSize = 256;
+    cases[3].settings.maxIterations = 8;
+    cases[3].settings.indexMode = vir::Quantizer::Settings::IndexMode::Delta;
+
+    auto image = generateImage(width, height);
+    std::cout
+        << width << "x" << height << " image, " << nCalls
+        << " calls per case" << std::endl;
+    for (auto& c : cases)
+    {
+        double wallTime = 0;
+        double gpuTime = 0;
+        unsigned int nGpuTimes = 0;
+        // The first call is a warm-up one (e.g., shader compilation)
+        for (unsigned int i=0; i<=nCalls; i++)
+        {
+            // The input texture is overwritten by the quantizer, so it is re-
+            // created on every call
+            auto input = vir::TextureBuffer2D::create
+            (
+                image.data(),
+                width,
+                height,
+                vir::TextureBuffer::InternalFormat::RGBA_UNI_8
+            );
+            glFinish();
+            auto start = std::chrono::steady_clock::now();
+            if (timerQuery != nullptr)
+                timerQuery->begin();
+            quantizer->quantize(input, c.paletteSize, c.settings);
+            if (timerQuery != nullptr)
+                timerQuery->end();
+            glFinish();
+            double seconds = std::chrono::duration<double>
+            (
+                std::chrono::steady_clock::now()-start
+            ).count();
+            uint64_t nanoseconds = 0;
+            bool hasGpuTime =
+                timerQuery != nullptr && timerQuery->result(nanoseconds, true);
+            delete input;
+            if (i == 0)
+                continue;
+            wallTime += seconds;
+            if (hasGpuTime)
+            {
+                gpuTime += 1e-9*nanoseconds;
+                nGpuTimes++;
+            }
+        }
+        std::cout
+            << c.name << ": " << 1e3*wallTime/nCalls << " ms wall-clock";
+        if (nGpuTimes > 0)
+            std::cout << ", " << 1e3*gpuTime/nGpuTimes << " ms GPU";
+        std::cout << " per call" << std::endl;
+    }
+
+    delete timerQuery;
+    delete quantizer;
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ _____________________
+|                     |  This file is part of ShaderThing - A GUI-based live
+|   ___  _________    |  shader editor by Stefan Radman (a.k.a., virmodoetiae).
+|  /\  \/\__    __\   |  For more information, visit:
+|  \ \  \/__/\  \_/   |
+|   \ \__   \ \  \    |  https://github.com/virmodoetiae/shaderthing
+|    \/__/\  \ \  \   |
+|        \ \__\ \__\  |  SPDX-FileCopyrightText:    2025 Stefan Radman
+|  Ↄ|C    \/__/\/__/  |                             sradman@protonmail.com
+|  Ↄ|C                |  SPDX-License-Identifier:   Zlib
+|_____________________|
+
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "shaderthing/include/macros.h"
+
+#include "vir/include/vir.h"
+
+namespace ShaderThing
+{
+
+// Automatic selection of the number of rendering tiles. The GPU time of each
+// tile submission (i.e., of rendering one tile of all layers) is measured with
+// timestamp queries, which do not interfere with any other GPU timing, and
+// whose results are only read once available. At frame boundaries, the total
+// GPU time of a frame is estimated from the longest measured tile, and the
+// number of tiles is set such that each tile takes about targetFraction of
+// the budget. The number of tiles is increased as soon as a tile exceeds it,
+// while it is only decreased after a few consecutive frames, so as to avoid
+// oscillations
+class AdaptiveTiling
+{
+private:
+
+    static constexpr unsigned int nQueries = 8;
+    static constexpr unsigned int nMaxTiles = 256;
+    static constexpr unsigned int nFramesBeforeDecrease = 3;
+    static constexpr float        targetFraction = .75f;
+
+    struct Query
+    {
+        vir::TimerQuery* query                         = nullptr;
+        // Number of tiles when the measurement was taken, as measurements of
+        // a previous tiling are discarded
+        unsigned int     nTiles                        = 1;
+    };
+
+    std::vector<Query> queries_;
+    unsigned int       queryIndex_                     = 0;
+    vir::TimerQuery*   activeQuery_                    = nullptr;
+    bool               isEnabled_                      = false;
+    bool               isSupported_                    = true;
+    float              budgetMs_                       = 30.f;
+    // Longest tile GPU time measured since the last frame boundary
+    float              maxTileMs_                      = 0.f;
+    bool               hasMeasurement_                 = false;
+    float              lastTileMs_                     = 0.f;
+    unsigned int       nFramesBelow_                   = 0;
+
+    void collectQueries(unsigned int nTiles);
+
+    DELETE_COPY_MOVE(AdaptiveTiling)
+
+public:
+
+    AdaptiveTiling(){}
+    ~AdaptiveTiling();
+
+    // Mark the start and end of a tile submission
+    void beginTile(unsigned int nTiles);
+    void endTile();
+
+    // To be called only at frame boundaries, i.e., once all tiles of a frame
+    // have been rendered. Returns the number of tiles of the next frame
+    unsigned int nextTileCount(unsigned int nTiles);
+
+    bool isEnabled() const {return isEnabled_ && isSupported_;}
+    bool isSupported() const {return isSupported_;}
+    float budgetMs() const {return budgetMs_;}
+    // Longest tile GPU time of the last frame boundary with measurements
+    float lastTileMs() const {return lastTileMs_;}
+    void setEnabled(bool flag);
+    void setBudgetMs(float budgetMs);
+};
+
+}
@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include <optional>
+#include <string>
 #include <vector>
 #include "vir/include/vir.h"
 #include "shaderthing/include/macros.h"
@@ -34,6 +36,25 @@ class ObjectIO;
 
 class App
 {
+public:
+
+    // Settings for rendering a project from the command line, without any GUI
+    // or user interaction. Unset optional settings default to the export 
+    // settings stored in the project
+    struct BatchRenderSettings
+    {
+        std::string                projectFilepath;
+        std::string                outputFilepath;
+        std::string                exportType; // gif, png, frames or stream
+        std::optional<float>       startTime;
+        std::optional<float>       endTime;
+        std::optional<float>       fps;
+        std::optional<glm::ivec2>  resolution;
+        std::optional<unsigned int> tileSize;
+        bool                       profile           = false;
+        bool                       quiet             = false;
+    };
+
 private:
 
     struct Project
@@ -71,6 +92,7 @@ private:
         float              lowerFpsLimit    = 5.0;
     };
     WindowSettings         windowSettings_  = {};
+    int                    exitCode_        = 0;
 
     struct Font
     {
@@ -88,7 +110,8 @@ private:
     Font                   font_            = {};
     
     void saveProject(const std::string& filepath, bool isAutosave) const;
-    void loadProject(const std::string& filepathOrData, bool fromMemory=false);
+    bool loadProject(const std::string& filepathOrData, bool fromMemory=false);
+    bool prepareBatchRender(const BatchRenderSettings& settings);
     void newProject();
     void processProjectActions();
 
@@ -99,7 +122,12 @@ private:
 public:
 
     App();
+    // Render the project with the provided settings, with a hidden window and
+    // an offscreen graphics context, then return
+    App(const BatchRenderSettings& settings);
     ~App();
+
+    int exitCode() const {return exitCode_;}
 };
 
 }
\ No newline at end of file
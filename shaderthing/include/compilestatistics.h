@@ -0,0 +1,80 @@
+/*
+ _____________________
+|                     |  This file is part of ShaderThing - A GUI-based live
+|   ___  _________    |  shader editor by Stefan Radman (a.k.a., virmodoetiae).
+|  /\  \/\__    __\   |  For more information, visit:
+|  \ \  \/__/\  \_/   |
+|   \ \__   \ \  \    |  https://github.com/virmodoetiae/shaderthing
+|    \/__/\  \ \  \   |
+|        \ \__\ \__\  |  SPDX-FileCopyrightText:    2025 Stefan Radman
+|  Ↄ|C    \/__/\/__/  |                             sradman@protonmail.com
+|  Ↄ|C                |  SPDX-License-Identifier:   Zlib
+|_____________________|
+
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "shaderthing/include/filedialog.h"
+#include "shaderthing/include/macros.h"
+
+#include "vir/include/vir.h"
+
+namespace ShaderThing
+{
+
+// Figures of the most recent shader compilation of each layer, i.e., compile
+// and link times, assembled source and header sizes, and number of active
+// uniforms and samplers, as reported by the driver
+class CompileStatistics
+{
+private:
+
+    struct Item
+    {
+        const void*            key                     = nullptr;
+        std::string            name;
+        vir::Shader::Statistics statistics;
+        unsigned int           nHeaderLines            = 0;
+        unsigned int           nErrors                 = 0;
+        // Number of compilations of this item so far
+        unsigned int           nCompilations           = 0;
+    };
+
+    std::vector<Item>      items_;
+    bool                   isGuiOpen_                  = false;
+    bool                   isGuiIconSet_               = false;
+    bool                   isGuiDocked_                = false;
+    FileDialog             fileDialog_;
+
+    DELETE_COPY_MOVE(CompileStatistics)
+
+public:
+
+    CompileStatistics(){}
+
+    // Record the statistics of the most recent compilation of an item, where
+    // the key is the address of the compiled object
+    void record
+    (
+        const void* key, 
+        const std::string& name,
+        const vir::Shader& shader,
+        unsigned int nHeaderLines
+    );
+
+    // Remove an item, to be called when the compiled object is deleted
+    void forget(const void* key);
+
+    // Write the statistics of all items to a CSV file, one row per item.
+    // Returns false if the file could not be written
+    bool writeCsv(const std::string& filepath) const;
+
+    void renderGui();
+    void renderMenuItemGui();
+};
+
+}
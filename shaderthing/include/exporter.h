@@ -18,6 +18,7 @@
 #include <string>
 #include <vector>
 
+#include "shaderthing/include/exportprofiler.h"
 #include "shaderthing/include/filedialog.h"
 #include "shaderthing/include/macros.h"
 
@@ -32,7 +33,9 @@ class Resource;
 class SharedUniforms;
 
 typedef vir::Quantizer::Settings::DitherMode DitherMode;
+typedef vir::Quantizer::Device QuantizerDevice;
 typedef vir::GifEncoder::PaletteMode PaletteMode;
+typedef vir::RawVideoEncoder::Format VideoStreamFormat;
 
 class Exporter : vir::Event::Receiver
 {
@@ -42,7 +45,8 @@ public:
     {
         Image,
         GIF,
-        VideoFrames
+        VideoFrames,
+        VideoStream
     };
 
 private:
@@ -61,7 +65,16 @@ private:
         PaletteMode    gifPaletteMode                  = PaletteMode::Dynamic;
         unsigned int   gifPaletteBitDepth              = 8;
         unsigned int   gifAlphaCutoff                  = 0;
+        bool           gifDeltaEncoding                = false;
         DitherMode     gifDitherMode                   = DitherMode::None;
+        QuantizerDevice gifQuantizerDevice             = QuantizerDevice::GPU;
+        unsigned int   gifMaxFramesInFlight            = 8;
+        int            pngCompressionLevel             = 8;
+        unsigned int   pngMaxFramesInFlight            = 8;
+        unsigned int   imageTileSize                   = 0;
+        VideoStreamFormat videoStreamFormat            = VideoStreamFormat::Y4M;
+        unsigned int   videoStreamMaxFramesInFlight    = 8;
+        bool           writePerformanceReport          = false;
     };
     Settings           settings_                       = {};
 
@@ -73,17 +86,86 @@ private:
 
     ExportType         exportType_                     = ExportType::Image;
     vir::Framebuffer*  framebuffer_                    = nullptr;
-    unsigned char*     framebufferData_                = nullptr;
     vir::GifEncoder*   gifEncoder_                     = nullptr;
+    vir::PngEncoder*   pngEncoder_                     = nullptr;
+    vir::RawVideoEncoder* videoEncoder_                = nullptr;
+    vir::PngStreamEncoder* pngStreamEncoder_           = nullptr;
     FileDialog         fileDialog_;
+    ExportProfiler     profiler_;
+
+    // Ring of pixel pack buffers for the asynchronous readback of image and
+    // video frame exports, with the output filepath of each queued readback.
+    // The readback of frame K is written to disk when the readback of frame 
+    // K+nReadbackBuffers is queued, or when the export terminates
+    static constexpr unsigned int nReadbackBuffers = 3;
+    struct ReadbackRing
+    {
+        std::vector<vir::PixelPackBuffer*> buffers;
+        std::vector<std::string> filepaths;
+        unsigned int   index                           = 0;
+    };
+    ReadbackRing       readback_;
+
+    // Outputs of the framebuffers of the layers flagged for export, which are
+    // written alongside the composite output from the same rendered frames.
+    // Each output owns its own encoders (if any) and readback ring
+    struct LayerOutput
+    {
+        Layer*                 layer                   = nullptr;
+        std::string            filepath;
+        vir::GifEncoder*       gifEncoder              = nullptr;
+        vir::RawVideoEncoder*  videoEncoder            = nullptr;
+        ReadbackRing           readback;
+    };
+    std::vector<LayerOutput> layerOutputs_;
+
+    // Image export in tiles, for output resolutions larger than what can be
+    // rendered at once. One tile is rendered per frame_, starting from the 
+    // top row of tiles (PNG rows are stored top-to-bottom), and each complete
+    // row of tiles is streamed to the PNG encoder. nTiles_ is {0, 0} if not
+    // exporting in tiles
+    glm::ivec2         nTiles_                         = {0, 0};
+    glm::ivec2         tileResolution_                 = {0, 0};
+    unsigned int       nTilesWritten_                  = 0;
+    std::vector<unsigned char> tileRowData_;
 
     bool               isRunning_                      = false;
+    bool               hasLastExportFailed_            = false;
+    std::string        requestedOutputFilepath_;
     bool               isAveragedPaletteReady_         = false;
     unsigned int       frame_                          = 0;
     unsigned int       nFrames_                        = 0;
     double             timeStep_                       = 0.f;
 
     void exportButtonGui(bool disabled = false);
+    void queueReadback
+    (
+        ReadbackRing& readback,
+        vir::Framebuffer* framebuffer,
+        const std::string& filepath,
+        vir::RawVideoEncoder* videoEncoder
+    );
+    double writeReadback
+    (
+        ReadbackRing& readback, 
+        unsigned int index,
+        vir::RawVideoEncoder* videoEncoder
+    );
+    void flushReadbacks
+    (
+        ReadbackRing& readback, 
+        vir::RawVideoEncoder* videoEncoder
+    );
+    void createReadbackBuffers(ReadbackRing& readback);
+    void deleteReadbackBuffers(ReadbackRing& readback);
+    std::string videoFrameFilepath(const std::string& filepath) const;
+    void setupLayerOutputs(const std::vector<Layer*>& layers);
+    void writeLayerOutputs();
+    void closeLayerOutputs();
+    glm::ivec2 tileOffset(unsigned int tile) const;
+    void writeTile(const unsigned char* data, unsigned int nChannels);
+    void collectEncoderStats();
+    std::string performanceReportFilepath() const;
 
     DELETE_COPY_MOVE(Exporter)
 
@@ -110,16 +192,56 @@ public:
 
     void writeOutput();
 
+    // Mark the start and end of each render pass of the export, for profiling
+    void beginRender() {profiler_.beginRender();}
+    void endRender() {profiler_.endRender();}
+
     void renderGui
     (
         SharedUniforms& sharedUniforms, 
         const std::vector<Layer*>& layers
     );
 
+    // Start exporting to the provided filepath on the next update call, as if
+    // it had been selected via the export file dialog
+    void requestExport(const std::string& filepath)
+    {
+        requestedOutputFilepath_ = filepath;
+    }
+
+    // Set the output resolution and rescale the export resolution of all 
+    // layers accordingly, as done when editing it via the GUI
+    void setOutputResolution
+    (
+        glm::ivec2 resolution,
+        SharedUniforms& sharedUniforms, 
+        const std::vector<Layer*>& layers
+    );
+
+    void setExportType(ExportType type) {exportType_ = type;}
+    void setStartTime(float time) {settings_.startTime = time;}
+    void setEndTime(float time) {settings_.endTime = time;}
+    void setFps(float fps) {settings_.fps = fps;}
+    void setImageTileSize(unsigned int size) {settings_.imageTileSize = size;}
+    void setWritePerformanceReport(bool flag)
+    {
+        settings_.writePerformanceReport = flag;
+    }
+
+    // Images can only be exported in tiles if all layers render to the window
+    static bool canExportInTiles(const std::vector<Layer*>& layers);
+
     bool isRunning() const {return isRunning_;}
+    // True if any output file could not be written during the last export
+    bool hasLastExportFailed() const {return hasLastExportFailed_;}
+    ExportType exportType() const {return exportType_;}
+    const std::string& outputFilepath() const {return settings_.outputFilepath;}
+    unsigned int frame() const {return frame_;}
+    unsigned int nFrames() const {return nFrames_;}
     float timeStep() const {return timeStep_;}
     unsigned int nRenderPasses() const {return settings_.nRenderPasses;}
     vir::Framebuffer* framebuffer() const {return framebuffer_;}
+    const ExportProfiler& profiler() const {return profiler_;}
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,142 @@
+/*
+ _____________________
+|                     |  This file is part of ShaderThing - A GUI-based live
+|   ___  _________    |  shader editor by Stefan Radman (a.k.a., virmodoetiae).
+|  /\  \/\__    __\   |  For more information, visit:
+|  \ \  \/__/\  \_/   |
+|   \ \__   \ \  \    |  https://github.com/virmodoetiae/shaderthing
+|    \/__/\  \ \  \   |
+|        \ \__\ \__\  |  SPDX-FileCopyrightText:    2025 Stefan Radman
+|  Ↄ|C    \/__/\/__/  |                             sradman@protonmail.com
+|  Ↄ|C                |  SPDX-License-Identifier:   Zlib
+|_____________________|
+
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "shaderthing/include/macros.h"
+
+#include "vir/include/vir.h"
+
+namespace ShaderThing
+{
+
+// Collects the duration of each stage of an export, namely the rendering of
+// each pass (on the CPU and, via non-blocking timer queries, on the GPU), the
+// readback of the rendered data, the submission of the data to the encoders,
+// and the stages of the encoders themselves, which may run on worker threads.
+// Summary statistics are shown live in the export GUI and can be written to a
+// JSON report once the export is complete
+class ExportProfiler
+{
+public:
+
+    enum class Stage
+    {
+        RenderGPU,
+        RenderCPU,
+        Readback,
+        Submission,
+        Quantization,
+        Encoding,
+        Writing,
+        Frame
+    };
+    static constexpr unsigned int nStages = 8;
+    static std::map<Stage, const char*> stageToName;
+    static std::map<Stage, const char*> stageToKey;
+
+    // All durations in seconds
+    struct Statistics
+    {
+        unsigned int   nSamples                        = 0;
+        double         total                           = 0;
+        double         mean                            = 0;
+        double         p50                             = 0;
+        double         p95                             = 0;
+        double         p99                             = 0;
+    };
+
+    typedef vir::EncoderStats::Clock Clock;
+
+private:
+
+    // Timer queries are used in a ring and their results are only collected
+    // once available, so that the GPU pipeline is never stalled. If all
+    // queries are pending, the GPU time of a frame is simply not measured
+    static constexpr unsigned int nTimerQueries = 8;
+    std::vector<vir::TimerQuery*> timerQueries_;
+    unsigned int       timerQueryIndex_                = 0;
+    vir::TimerQuery*   activeTimerQuery_               = nullptr;
+
+    std::vector<double> samples_[nStages];
+    std::vector<vir::EncoderStats::Sample> encoderSamples_;
+    Statistics         statistics_[nStages];
+    uint64_t           nBytesWritten_                  = 0;
+    unsigned int       nFrames_                        = 0;
+    bool               isRunning_                      = false;
+    double             duration_                       = 0;
+    Clock::time_point  startTime_;
+    Clock::time_point  lastFrameTime_;
+    Clock::time_point  renderStartTime_;
+    Clock::time_point  statisticsTime_;
+
+    void collectTimerQueries(bool wait);
+    void updateStatistics();
+
+    DELETE_COPY_MOVE(ExportProfiler)
+
+public:
+
+    ExportProfiler(){}
+    ~ExportProfiler();
+
+    // Clear all samples and start measuring
+    void start();
+
+    // Stop measuring, waiting for all pending timer query results
+    void stop();
+
+    // Mark the start and end of the rendering of a single render pass
+    void beginRender();
+    void endRender();
+
+    void record(Stage stage, double seconds);
+
+    // Mark the completion of an export frame
+    void recordFrame();
+
+    // Take over the samples and number of bytes written recorded by an encoder
+    void collect(vir::EncoderStats& encoderStats);
+
+    // Live statistics table, refreshed a few times per second
+    void renderGui();
+
+    // Write the statistics of the last export to a JSON file. Returns false if
+    // the file could not be written
+    bool writeReport
+    (
+        const std::string& filepath,
+        const std::string& outputFilepath,
+        glm::ivec2 outputResolution
+    );
+
+    bool isRunning() const {return isRunning_;}
+    unsigned int nFrames() const {return nFrames_;}
+    uint64_t nBytesWritten() const {return nBytesWritten_;}
+    double duration() const;
+    double framesPerSecond() const;
+    const Statistics& statistics(Stage stage) const
+    {
+        return statistics_[(int)stage];
+    }
+};
+
+}
@@ -35,6 +35,21 @@ glm::vec2 normalizedWindowResolution();
 
 unsigned int countNewLines(const std::string& text);
 
+// True if text contains identifier as a whole word, i.e., not as part of a
+// longer identifier
+bool containsIdentifier(const std::string& text, const std::string& identifier);
+
+// Returns text with all whole-word occurrences of identifier replaced by 
+// replacement, except for those directly preceded by the declarationType 
+// identifier (i.e., declarations of identifier itself)
+std::string replaceIdentifier
+(
+    const std::string& text, 
+    const std::string& identifier,
+    const std::string& replacement,
+    const std::string& declarationType = ""
+);
+
 std::string fileExtension(const std::string& filepath, bool toLowerCase=true);
 
 std::string filename(const std::string& filepath);
@@ -50,6 +65,11 @@ std::string appendToFilename(const std::string& filepath, const std::string& s);
 
 std::string randomString(const unsigned int size);
 
+// Returns the path of subdirectory in the per-user cache directory of 
+// ShaderThing (e.g., ~/.cache/shaderthing/subdirectory), or an empty string if
+// it cannot be determined. The directory is not created
+std::string userCacheDirectory(const std::string& subdirectory);
+
 // Returns the raw data of file at filepath and the overall data size. It is
 // your responsibility to de-allocate the returned data, once used, with 
 // delete[]
@@ -37,12 +37,17 @@ class ObjectIO;
 class PostProcess;
 class Resource;
 class LayerResource;
+class AdaptiveTiling;
+class CompileStatistics;
+class LayerGraph;
+class RenderProfiler;
 class SharedStorage;
 class SharedUniforms;
 class Uniform;
 
 class Layer : vir::Event::Receiver
 {
+friend LayerGraph;
 friend LayerResource;
 friend PostProcess;
 friend Uniform;
@@ -67,6 +72,29 @@ public:
         vir::Framebuffer*               resourceFramebuffer = nullptr;
         vir::Shader*                    shader              = nullptr;
         std::vector<PostProcess*>       postProcesses       = {};
+        // True if the compiled shader source accesses the shared storage
+        bool                            usesSharedStorage   = false;
+
+        // A layer rendering to its internal framebuffer only is rendered once
+        // and its framebuffer re-used for as long as none of its inputs (i.e.,
+        // uniform values, sampled resources and the output of sampled layers)
+        // change, provided that its source does not use any time- or 
+        // user-input-dependent shared uniform
+        struct OutputCache
+        {
+            // User override, caching is only attempted if true
+            bool                        isEnabled       = true;
+            // Set on compilation
+            bool                        isTimeInvariant = false;
+            bool                        isValid         = false;
+            // True if the last render was skipped
+            bool                        isHit           = false;
+            uint64_t                    inputsHash      = 0;
+            // Incremented whenever the framebuffer contents change, so that
+            // layers sampling this layer know when to re-render
+            uint64_t                    contentVersion  = 0;
+        };
+        OutputCache                     outputCache;
 
         struct TileData
         {
@@ -88,6 +116,54 @@ public:
             static unsigned int         nTilesCache;
         };
 
+        // Dynamic resolution scaling of the live preview: layers rendering
+        // directly to the window are instead rendered to their internal
+        // framebuffers at a fraction (scale) of their resolution and upscaled
+        // to the window, with the scale adjusted towards a target frame rate.
+        // Never applied during exports nor when tiled rendering is enabled
+        struct ResolutionController
+        {
+            static bool                 dynamicResolutionEnabled;
+            static float                targetFps;
+            static float                minScale;
+            static float                scale;
+            static float                smoothFrameTime;
+            static float                timeSinceUpdate;
+        };
+        // True if rendering to the window via a scaled internal framebuffer
+        bool                            isRenderScaled      = false;
+
+        // Progressive interleaved rendering: on each frame, only one pixel of
+        // each stride x stride block is shaded, with a rotating offset, into
+        // a reduced-resolution framebuffer, and all other pixels are kept
+        // from the previous frame. Only applied to the live preview and not
+        // when tiled rendering is enabled
+        struct Interleave
+        {
+            unsigned int                stride      = 1;
+            unsigned int                index       = 0;
+            vir::Framebuffer*           framebuffer = nullptr;
+        };
+        Interleave                      interleave;
+
+        // Shader being compiled in the background, which only replaces the
+        // current one once compiled without errors
+        struct PendingCompilation
+        {
+            vir::Shader*                shader       = nullptr;
+            uint64_t                    sourceHash   = 0;
+            std::string                 source;
+            unsigned int                nHeaderLines = 0;
+            unsigned int                nSharedLines = 0;
+            bool                        setBlankShaderOnError = false;
+        };
+        PendingCompilation              pendingCompilation;
+        // Hash of the assembled vertex and fragment sources of the current
+        // shader, zero if it did not compile, and whether the last compilation
+        // request was skipped because the sources were unchanged
+        uint64_t                        sourceHash          = 0;
+        bool                            isSourceUnchanged   = false;
+
         struct Result
         {
             bool renderPassesComplete;
@@ -98,8 +174,18 @@ public:
         // ptr-type resources
         static std::unique_ptr<vir::Shader>
                                         textureMapperShader;
+        static std::unique_ptr<vir::Shader>
+                                        interleaveShader;
         static std::unique_ptr<SharedStorage> 
                                         sharedStorage;
+        static std::unique_ptr<LayerGraph> 
+                                        graph;
+        static std::unique_ptr<RenderProfiler> 
+                                        profiler;
+        static std::unique_ptr<AdaptiveTiling> 
+                                        adaptiveTiling;
+        static std::unique_ptr<CompileStatistics> 
+                                        compileStatistics;
     };
     struct GUI
     {
@@ -147,6 +233,9 @@ public:
         float                           resolutionScale       = 1.f;
         float                           windowResolutionScale = 1.f;
         bool                            rescaleWithOutput     = true;
+        // If true, the layer framebuffer is also exported to its own file,
+        // from the same frames rendered for the composite output
+        bool                            exportFramebuffer     = false;
     };
 
 private:
@@ -194,6 +283,20 @@ private:
         const glm::ivec2& resolution
     );
     void clearFramebuffers();
+    void setRenderScale(float scale);
+    void renderInterleaved();
+    void pollShaderCompilation(const SharedUniforms& sharedUniforms);
+    bool finishShaderCompilation(const SharedUniforms& sharedUniforms);
+    void clearUncompiledChanges();
+    static void updateRenderScale(float frameTime);
+    void invalidateOutputCache();
+    // Returns false if the layer cannot be cached at all, otherwise sets hash
+    // to a hash of all the current layer inputs
+    bool outputInputsHash
+    (
+        const SharedUniforms& sharedUniforms,
+        uint64_t& hash
+    ) const;
     void save(ObjectIO& io) const;
     static Layer* load
     (
@@ -229,16 +332,27 @@ public:
     DECLARE_RECEIVABLE_EVENTS(vir::Event::Type::WindowResize)
     void onReceive(vir::Event::WindowResizeEvent& event) override;
 
-    static void prepareForExport(const std::vector<Layer*>& layers);
+    static void prepareForExport
+    (
+        const std::vector<Layer*>& layers, 
+        const bool exportInTiles=false
+    );
     static void resetAfterExport(const std::vector<Layer*>& layers);
 
     bool removeResourceFromUniforms(const Resource* resource);
     
+    // If async is true, the shader is compiled in the background (if
+    // supported) and the current one is kept until the compilation completes
     bool compileShader
     (
         const SharedUniforms& sharedUniforms, 
-        bool setBlankShaderOnError=false
+        bool setBlankShaderOnError=false,
+        bool async=false
     );
+    bool isCompilingShader() const
+    {
+        return rendering_.pendingCompilation.shader != nullptr;
+    }
     void renderShader
     (
         vir::Framebuffer* target, 
@@ -296,7 +410,12 @@ public:
     float aspectRatio() const {return aspectRatio_;}
     bool isAspectRatioBoundToWindow() const {return flags_.isAspectRatioBoundToWindow;}
     Rendering::Target renderingTarget() const {return rendering_.target;}
+    vir::Framebuffer* resourceFramebuffer() const 
+    {
+        return rendering_.resourceFramebuffer;
+    }
     ExportData& exportData() {return exportData_;}
+    bool isOutputCached() const {return rendering_.outputCache.isHit;}
 
     bool operator==(const Layer& layer){return id_ == layer.id_;}
     bool operator!=(const Layer& layer){return !(*this == layer);}
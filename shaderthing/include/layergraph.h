@@ -0,0 +1,119 @@
+/*
+ _____________________
+|                     |  This file is part of ShaderThing - A GUI-based live
+|   ___  _________    |  shader editor by Stefan Radman (a.k.a., virmodoetiae).
+|  /\  \/\__    __\   |  For more information, visit:
+|  \ \  \/__/\  \_/   |
+|   \ \__   \ \  \    |  https://github.com/virmodoetiae/shaderthing
+|    \/__/\  \ \  \   |
+|        \ \__\ \__\  |  SPDX-FileCopyrightText:    2025 Stefan Radman
+|  Ↄ|C    \/__/\/__/  |                             sradman@protonmail.com
+|  Ↄ|C                |  SPDX-License-Identifier:   Zlib
+|_____________________|
+
+*/
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "shaderthing/include/macros.h"
+
+namespace ShaderThing
+{
+
+class Layer;
+class SharedUniforms;
+class Uniform;
+
+// Graph of the dependencies between layers, where layer A depends on layer B if
+// any sampler or image uniform of A has the framebuffer of B as value. Layers
+// whose output is consumed (i.e., layers rendering to the window, layers
+// exported alongside the composite output, layers with side effects, namely
+// writing to images or to the shared storage, and all layers these depend on,
+// directly or not) are live, and all others are culled from rendering
+class LayerGraph
+{
+public:
+
+    // Why a layer is a root of the graph, i.e., live regardless of any other
+    // layer depending on it
+    enum class Root
+    {
+        None,
+        Window,
+        Export,
+        SharedUniform,
+        SideEffects
+    };
+    static std::map<Root, const char*> rootToName;
+
+    struct Node
+    {
+        const Layer*              layer    = nullptr;
+        // Indices of the nodes of the layers this layer samples
+        std::vector<unsigned int> inputs   = {};
+        Root                      root     = Root::None;
+        bool                      isLive   = false;
+    };
+
+private:
+
+    std::vector<Node>         nodes_;
+    std::map<const Layer*, unsigned int> nodeIndices_;
+
+    // Topological order of the nodes, i.e., each layer comes after all layers
+    // it samples, with ties broken by the layer order. Layers in dependency
+    // cycles (which sample each other's previous frame) are appended in layer
+    // order
+    std::vector<unsigned int> order_;
+    bool                      hasCycles_             = false;
+    bool                      isCullingEnabled_      = true;
+    bool                      isExporting_           = false;
+    unsigned int              nCulled_               = 0;
+
+    void addInputs
+    (
+        Node& node,
+        const std::vector<Uniform*>& uniforms,
+        bool& writesImages
+    ) const;
+    void sortTopologically();
+
+    DELETE_COPY_MOVE(LayerGraph)
+
+public:
+
+    LayerGraph(){}
+
+    // Rebuild the graph from the current layers and uniforms. During exports,
+    // layers flagged for export are roots as well
+    void build
+    (
+        const std::vector<Layer*>& layers,
+        const SharedUniforms& sharedUniforms,
+        bool isExporting
+    );
+
+    // True if the layer is to be rendered, i.e., if it is live or if culling
+    // is disabled
+    bool isRendered(const Layer* layer) const;
+
+    // The graph is rebuilt before being shown, as layers may have changed
+    // since the last render (e.g., while rendering is paused)
+    void renderMenuItemGui
+    (
+        const std::vector<Layer*>& layers,
+        const SharedUniforms& sharedUniforms
+    );
+
+    const std::vector<Node>& nodes() const {return nodes_;}
+    const std::vector<unsigned int>& order() const {return order_;}
+    bool hasCycles() const {return hasCycles_;}
+    unsigned int nCulled() const {return nCulled_;}
+    bool isCullingEnabled() const {return isCullingEnabled_;}
+    void setCullingEnabled(bool flag) {isCullingEnabled_ = flag;}
+};
+
+}
@@ -117,7 +117,10 @@ protected:
         true,                         // fastKMeans
         true,                         // regenerateMipMap
         false,                        // overwriteInput
-        0                             // inputUnit
+        0,                            // inputUnit
+        true,                         // ensureFreeSSBOBinding
+        false,                        // cumulatePalette
+        16                            // maxIterations
     };
     
     struct Palette
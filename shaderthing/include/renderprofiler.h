@@ -0,0 +1,130 @@
+/*
+ _____________________
+|                     |  This file is part of ShaderThing - A GUI-based live
+|   ___  _________    |  shader editor by Stefan Radman (a.k.a., virmodoetiae).
+|  /\  \/\__    __\   |  For more information, visit:
+|  \ \  \/__/\  \_/   |
+|   \ \__   \ \  \    |  https://github.com/virmodoetiae/shaderthing
+|    \/__/\  \ \  \   |
+|        \ \__\ \__\  |  SPDX-FileCopyrightText:    2025 Stefan Radman
+|  Ↄ|C    \/__/\/__/  |                             sradman@protonmail.com
+|  Ↄ|C                |  SPDX-License-Identifier:   Zlib
+|_____________________|
+
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "shaderthing/include/filedialog.h"
+#include "shaderthing/include/macros.h"
+
+#include "vir/include/vir.h"
+
+namespace ShaderThing
+{
+
+// Measures the GPU time spent rendering each layer and running each
+// post-processing effect. Each measured item (identified by the address of
+// the measured object) owns a pool of timer queries, whose results are only
+// read once available, and the per-item time of a frame is finalized nSlots
+// frames later, so that the GPU pipeline is never stalled. Measurements are
+// only taken while the profiler window is open
+class RenderProfiler
+{
+public:
+
+    typedef std::chrono::steady_clock Clock;
+
+    // Number of frames after which a frame is finalized, i.e., the results of
+    // queries of frame N are read at the latest on frame N+nSlots
+    static constexpr unsigned int nSlots = 4;
+    static constexpr unsigned int nHistory = 240;
+
+private:
+
+    static constexpr unsigned int nMaxQueriesPerItem = 4*nSlots;
+    static constexpr unsigned int nMeanFrames = 30;
+
+    struct Query
+    {
+        vir::TimerQuery* query                         = nullptr;
+        uint64_t         frame                         = 0;
+    };
+
+    struct Item
+    {
+        const void*        key                         = nullptr;
+        std::string        name;
+        std::vector<Query> queries;
+        // GPU time of the frames not yet finalized, indexed by frame%nSlots
+        double             seconds[nSlots]             = {};
+        // Finalized GPU times in ms, as a ring indexed by historyIndex_
+        std::vector<float> history;
+        float              meanMs                      = 0;
+    };
+
+    std::vector<Item>      items_;
+    vir::TimerQuery*       activeQuery_                = nullptr;
+    uint64_t               frame_                      = 0;
+    bool                   isMeasuring_                = false;
+    bool                   isSupported_                = true;
+    double                 frameSeconds_[nSlots]       = {};
+    bool                   isFrameMeasured_[nSlots]    = {};
+    Clock::time_point      frameStartTime_;
+
+    // Wall-clock frame times in ms and the corresponding frame numbers, as
+    // rings indexed by historyIndex_
+    std::vector<float>     frameHistory_;
+    std::vector<uint64_t>  frameNumbers_;
+    unsigned int           historyIndex_               = 0;
+    unsigned int           nHistoryFrames_             = 0;
+    float                  meanFrameMs_                = 0;
+
+    bool                   isGuiOpen_                  = false;
+    bool                   isGuiIconSet_               = false;
+    bool                   isGuiDocked_                = false;
+    FileDialog             fileDialog_;
+
+    void collectQueries();
+    void finalizeFrame(uint64_t frame);
+    float historyMean(const std::vector<float>& history) const;
+
+    DELETE_COPY_MOVE(RenderProfiler)
+
+public:
+
+    RenderProfiler();
+    ~RenderProfiler();
+
+    // Mark the start of a new frame. No measurements are taken during the
+    // frame if measure is false (e.g., during exports, whose own GPU timer
+    // queries cannot be nested with these)
+    void beginFrame(bool measure);
+
+    // Mark the start and end of the GPU work of an item, where the key is the
+    // address of the measured object. An item may be measured more than once
+    // per frame, in which case its times are summed, but measurements cannot
+    // be nested
+    void begin(const void* key, const std::string& name);
+    void end();
+
+    // Remove an item and its history, to be called when the measured object
+    // is deleted
+    void forget(const void* key);
+
+    // Write the history of all items to a CSV file, one row per frame.
+    // Returns false if the file could not be written
+    bool writeCsv(const std::string& filepath) const;
+
+    void renderGui();
+    void renderMenuItemGui();
+
+    bool isMeasuring() const {return isMeasuring_;}
+};
+
+}
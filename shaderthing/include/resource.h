@@ -61,6 +61,9 @@ protected:
     int                                          imageUnit_     = -1;
     // List of uniforms using this resource as value
     std::vector<Uniform*>                        clientUniforms_ = {};
+    // Incremented whenever the resource is bound as a writable image, so that
+    // layers sampling it do not re-use cached outputs
+    uint64_t                                     contentVersion_ = 0;
 
     static std::map<Resource::Type, const char*> typeToName_;
     static FileDialog                            fileDialog_;
@@ -112,6 +115,8 @@ public:
     void                 addClientUniform(Uniform* u) {clientUniforms_.push_back(u);}
     void                 removeClientUniform(Uniform* u) {clientUniforms_.erase(std::remove(clientUniforms_.begin(), clientUniforms_.end(), u), clientUniforms_.end());}
     bool                 isUsedByUniform(const Uniform* u) const {return std::find(clientUniforms_.begin(), clientUniforms_.end(), u) != clientUniforms_.end();}
+    uint64_t             contentVersion() const {return contentVersion_;}
+    void                 markContentChanged() {++contentVersion_;}
 
     static bool isGuiOpen;
     static bool isGuiDetachedFromMenu;
@@ -370,6 +375,7 @@ class LayerResource : public Resource
 public:
     ~LayerResource();
     bool         set(Layer* layer);
+    const Layer* layer() const {return layer_;}
     void         bind(unsigned int unit) override {(*native_)->bindColorBuffer(unit); textureUnit_=unit;}
     void         unbind() override {(*native_)->unbindColorBuffer(); textureUnit_=-1;};
     void         bindImage(unsigned int unit, unsigned int level, ImageBindMode mode) override {(*native_)->bindColorBufferToImage(unit, level, mode); imageUnit_=unit;}
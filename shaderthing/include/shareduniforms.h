@@ -131,12 +131,17 @@ private:
         // array element at a time, medium update frequency
                     ivec3A16   iKeyboard[256] {};           // 96 - 4192     | 16*256 = 4096
 
+        // Only set when exporting in tiles, offset of the tile being rendered
+                    glm::vec2  iFragCoordOffset = {0,0};    // 4192 - 4200   | 8
+
         static      uint32_t dataRangeISize()             {return 20;}
         static      uint32_t dataRangeIISize()            {return 80;}
         static      uint32_t dataRangeIIISize()           {return 96;}
         static      uint32_t iKeyboardKeyOffset(int iKey) {return 96+iKey*16;}
         static      uint32_t iKeyboardKeySize()           {return 16;}
-        static      uint32_t size()                       {return 4192;}
+        static      uint32_t iFragCoordOffsetOffset()     {return 4192;}
+        static      uint32_t iFragCoordOffsetSize()       {return 8;}
+        static      uint32_t size()                       {return 4208;}
         
         static constexpr const char* glslName = "sharedBlock";
         // The order of the uniforms within the block source must be the same as
@@ -156,7 +161,9 @@ R"(layout(std140) uniform sharedUniformBlock {
         vec4   iMouse;
         float  iWindowAspectRatio;
         vec2   iWindowResolution;
-        ivec3  iKeyboard[256];};
+        ivec3  iKeyboard[256];
+        vec2   iFragCoordOffset;};
+#define stFragCoord vec4(gl_FragCoord.xy+iFragCoordOffset, gl_FragCoord.zw)
 )";
     };
 
@@ -258,6 +265,11 @@ public:
     void prepareForExport(bool setTime, float exportStartTime);
     void resetAfterExport(bool resetFrameCounter = true);
     void resetTimeAndFrame(float time=0);
+    // Render only the size.x x size.y tile of the export resolution whose 
+    // bottom-left corner is at offset, to a framebuffer of the same size as the
+    // tile. Both the quad coordinates and gl_FragCoord are kept consistent 
+    // with those of the full-resolution render. Reset by resetAfterExport
+    void setExportTile(glm::ivec2 offset, glm::ivec2 size);
     void toggleRenderingPaused(bool dueToLowFps = false);
     void setMouseCaptured(bool flag);
     void setResolution
@@ -281,6 +293,8 @@ public:
     const int& iFrame() const {return fBlock_.iFrame;}
     const int& iRenderPass() const {return fBlock_.iRenderPass;}
     glm::ivec2 iResolution() const {return fBlock_.iResolution;}
+    bool iExport() const {return fBlock_.iExport;}
+    glm::vec2 iFragCoordOffset() const {return fBlock_.iFragCoordOffset;}
     const std::vector<Uniform*>& userUniforms() const {return userUniforms_;}
     const float& lowerFpsLimit() const {return lowerFpsLimit_;}
 };
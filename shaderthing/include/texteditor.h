@@ -433,6 +433,7 @@ private:
     void colorize(int aFroline = 0, int aCount = -1);
     void colorizeRange(int aFroline = 0, int aToLine = 0);
     void colorizeInternal();
+    uint8_t lexLineState(Line& line, uint8_t state) const;
     float textDistanceToLineStart(const Coordinates& aFrom) const;
     void ensureCursorVisible();
     int getPageSize() const;
@@ -470,7 +471,6 @@ private:
     void handleMouseInputs();
     void renderGui();
 
-    bool                   checkComments_         = true;
     bool                   colorizerEnabled_      = true;
     bool                   cursorPositionChanged_ = false;
     bool                   handleKeyboardInputs_  = true;
@@ -486,6 +486,12 @@ private:
     bool                   showWhitespaces_       = true;
     int                    colorRangeMin_         = 0;
     int                    colorRangeMax_         = 0;
+    // Lexer state at the end of each line (see lexLineState), so that after
+    // an edit the comment, string and preprocessor flags of glyphs are only
+    // re-computed from the first edited line until the state re-synchronizes
+    std::vector<uint8_t>   lineEndStates_;
+    int                    lexRangeMin_           = 0;
+    int                    lexRangeMax_           = 0;
     int                    leftMargin_            = 10;
     int                    tabSize_               = 4;
     int                    undoIndex_             = 0;
@@ -0,0 +1,145 @@
+/*
+ _____________________
+|                     |  This file is part of ShaderThing - A GUI-based live
+|   ___  _________    |  shader editor by Stefan Radman (a.k.a., virmodoetiae).
+|  /\  \/\__    __\   |  For more information, visit:
+|  \ \  \/__/\  \_/   |
+|   \ \__   \ \  \    |  https://github.com/virmodoetiae/shaderthing
+|    \/__/\  \ \  \   |
+|        \ \__\ \__\  |  SPDX-FileCopyrightText:    2025 Stefan Radman
+|  Ↄ|C    \/__/\/__/  |                             sradman@protonmail.com
+|  Ↄ|C                |  SPDX-License-Identifier:   Zlib
+|_____________________|
+
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "shaderthing/include/adaptivetiling.h"
+
+namespace ShaderThing
+{
+
+AdaptiveTiling::~AdaptiveTiling()
+{
+    for (auto& query : queries_)
+    {
+        DELETE_IF_NOT_NULLPTR(query.query)
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+void AdaptiveTiling::setEnabled(bool flag)
+{
+    isEnabled_ = flag;
+    maxTileMs_ = 0.f;
+    hasMeasurement_ = false;
+    nFramesBelow_ = 0;
+}
+
+//----------------------------------------------------------------------------//
+
+void AdaptiveTiling::setBudgetMs(float budgetMs)
+{
+    budgetMs_ = std::max(budgetMs, 1.f);
+    nFramesBelow_ = 0;
+}
+
+//----------------------------------------------------------------------------//
+
+void AdaptiveTiling::collectQueries(unsigned int nTiles)
+{
+    for (auto& query : queries_)
+    {
+        uint64_t nanoseconds;
+        if
+        (
+            !query.query->isPending() ||
+            !query.query->result(nanoseconds, false) ||
+            query.nTiles != nTiles
+        )
+            continue;
+        maxTileMs_ = std::max(maxTileMs_, float(1e-6*nanoseconds));
+        hasMeasurement_ = true;
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+void AdaptiveTiling::beginTile(unsigned int nTiles)
+{
+    if (!isEnabled())
+        return;
+    collectQueries(nTiles);
+    if (queries_.empty())
+    {
+        for (unsigned int i=0; i<nQueries; i++)
+        {
+            auto query =
+                vir::TimerQuery::create(vir::TimerQuery::Mode::Timestamps);
+            if (query == nullptr)
+            {
+                isSupported_ = false;
+                return;
+            }
+            queries_.push_back({query, nTiles});
+        }
+    }
+    // If the next query is still pending, this tile is simply not measured
+    auto& query = queries_[queryIndex_];
+    if (query.query->isPending())
+        return;
+    query.nTiles = nTiles;
+    query.query->begin();
+    activeQuery_ = query.query;
+    queryIndex_ = (queryIndex_+1)%queries_.size();
+}
+
+//----------------------------------------------------------------------------//
+
+void AdaptiveTiling::endTile()
+{
+    if (activeQuery_ == nullptr)
+        return;
+    activeQuery_->end();
+    activeQuery_ = nullptr;
+}
+
+//----------------------------------------------------------------------------//
+
+unsigned int AdaptiveTiling::nextTileCount(unsigned int nTiles)
+{
+    if (!isEnabled())
+        return nTiles;
+    collectQueries(nTiles);
+    if (!hasMeasurement_)
+        return nTiles;
+    lastTileMs_ = maxTileMs_;
+    float frameMs = nTiles*maxTileMs_;
+    maxTileMs_ = 0.f;
+    hasMeasurement_ = false;
+    unsigned int nIdealTiles = std::clamp
+    (
+        (unsigned int)std::ceil(frameMs/(targetFraction*budgetMs_)),
+        1u,
+        nMaxTiles
+    );
+    if (nIdealTiles > nTiles)
+    {
+        nFramesBelow_ = 0;
+        return nIdealTiles;
+    }
+    if (nIdealTiles == nTiles)
+    {
+        nFramesBelow_ = 0;
+        return nTiles;
+    }
+    if (++nFramesBelow_ < nFramesBeforeDecrease)
+        return nTiles;
+    nFramesBelow_ = 0;
+    return nIdealTiles;
+}
+
+}
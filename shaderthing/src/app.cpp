@@ -14,16 +14,22 @@
 */
 
 #include <charconv>
+#include <iostream>
+#include <map>
 
 #include "shaderthing/include/app.h"
+#include "shaderthing/include/adaptivetiling.h"
 
 #include "shaderthing/include/about.h"
 #include "shaderthing/include/bytedata.h"
 #include "shaderthing/include/coderepository.h"
+#include "shaderthing/include/compilestatistics.h"
 #include "shaderthing/include/examples.h"
 #include "shaderthing/include/exporter.h"
 #include "shaderthing/include/helpers.h"
 #include "shaderthing/include/layer.h"
+#include "shaderthing/include/layergraph.h"
+#include "shaderthing/include/renderprofiler.h"
 #include "shaderthing/include/objectio.h"
 #include "shaderthing/include/postprocess.h"
 #include "shaderthing/include/resource.h"
@@ -42,6 +48,8 @@ App::App()
     vir::Settings settings = {};
     settings.windowName = "ShaderThing - "+project_.filename;
     settings.enableFaceCulling = false;
+    settings.shaderBinaryCacheDirectory = 
+        Helpers::userCacheDirectory("shaders");
     vir::initialize(settings);
 
     auto window = vir::Window::instance();
@@ -63,6 +71,7 @@ App::App()
         renderGui();
         update();
 
+        exporter_->beginRender();
         auto result = Layer::renderShaders
         (
             layers_, 
@@ -70,6 +79,7 @@ App::App()
             *sharedUniforms_,
             exporter_->isRunning() ? exporter_->nRenderPasses() : 1
         );
+        exporter_->endRender();
         if (exporter_->isRunning() && result.renderPassesComplete)
             exporter_->writeOutput();
         window->update(result.flipWindowBuffer);
@@ -78,6 +88,90 @@ App::App()
 
 //----------------------------------------------------------------------------//
 
+App::App(const BatchRenderSettings& batchSettings)
+{
+    // Initialize vir lib without showing any window. The ImGui renderer is
+    // still initialized, as parts of the project state (e.g., the UI scale) 
+    // live in the ImGui context, but no GUI is ever rendered
+    vir::Settings settings = {};
+    settings.windowName = "ShaderThing";
+    settings.enableFaceCulling = false;
+    settings.headless = true;
+    settings.shaderBinaryCacheDirectory = 
+        Helpers::userCacheDirectory("shaders");
+    try
+    {
+        vir::initialize(settings);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Could not create an offscreen OpenGL context: " 
+                  << e.what() << std::endl;
+        exitCode_ = 1;
+        return;
+    }
+    font_.initialize();
+    newProject();
+    if (!prepareBatchRender(batchSettings))
+    {
+        exitCode_ = 1;
+        return;
+    }
+
+    // Render loop, which terminates with the export
+    auto window = vir::Window::instance();
+    unsigned int lastReportedFrame = 0;
+    while(window->isOpen())
+    {
+        update();
+        if (!exporter_->isRunning())
+            break;
+        exporter_->beginRender();
+        auto result = Layer::renderShaders
+        (
+            layers_, 
+            exporter_->framebuffer(), 
+            *sharedUniforms_,
+            exporter_->nRenderPasses()
+        );
+        exporter_->endRender();
+        if (result.renderPassesComplete)
+        {
+            exporter_->writeOutput();
+            if (!batchSettings.quiet && exporter_->frame() != lastReportedFrame)
+            {
+                lastReportedFrame = exporter_->frame();
+                std::cerr << "\rFrame " << lastReportedFrame << "/" 
+                          << exporter_->nFrames() << std::flush;
+            }
+        }
+        window->update(false);
+    }
+    // Progress is reported to stderr, as stdout may be the output stream
+    if (!batchSettings.quiet)
+    {
+        std::cerr << std::endl;
+        if (batchSettings.profile)
+        {
+            const auto& profiler = exporter_->profiler();
+            std::cerr << profiler.nFrames() << " frames in " 
+                      << Helpers::format(profiler.duration(), 2) << " s ("
+                      << Helpers::format(profiler.framesPerSecond(), 2) 
+                      << " fps), " 
+                      << Helpers::format(profiler.nBytesWritten()/1048576., 2)
+                      << " MB written" << std::endl;
+        }
+    }
+    if (exporter_->hasLastExportFailed())
+    {
+        std::cerr << "Could not write " << exporter_->outputFilepath() 
+                  << std::endl;
+        exitCode_ = 1;
+    }
+}
+
+//----------------------------------------------------------------------------//
+
 App::~App()
 {
     DELETE_IF_NOT_NULLPTR(exporter_)
@@ -234,14 +328,14 @@ void App::saveProject(const std::string& filepath, bool isAutosave) const
 
 //----------------------------------------------------------------------------//
     
-void App::loadProject(const std::string& filepathOrData, bool fromMemory)
+bool App::loadProject(const std::string& filepathOrData, bool fromMemory)
 {
     auto project = 
         fromMemory ? 
         ObjectIO(filepathOrData) : 
         ObjectIO(filepathOrData.c_str(), ObjectIO::Mode::Read);
     if (!project.isValid())
-        return; // TODO Could display an error via ImGui
+        return false; // TODO Could display an error via ImGui
     
     *font_.fontScale = project.read<float>("UIScale");
     project_.isAutoSaveEnabled = project.readOrDefault<bool>
@@ -263,6 +357,69 @@ void App::loadProject(const std::string& filepathOrData, bool fromMemory)
     Layer::         loadAll(project, layers_, *sharedUniforms_, resources_);
     Exporter::      load   (project, exporter_                            );
     PostProcess::   loadStaticData(project);
+    return true;
+}
+
+//----------------------------------------------------------------------------//
+
+bool App::prepareBatchRender(const BatchRenderSettings& settings)
+{
+    if (!loadProject(settings.projectFilepath))
+    {
+        std::cerr << "Could not load project " << settings.projectFilepath 
+                  << std::endl;
+        return false;
+    }
+    project_.filepath = settings.projectFilepath;
+    project_.filename = Helpers::filename(project_.filepath);
+    project_.isAutoSaveEnabled = false;
+
+    static const std::map<std::string, Exporter::ExportType> nameToExportType=
+    {
+        {"png", Exporter::ExportType::Image},
+        {"gif", Exporter::ExportType::GIF},
+        {"frames", Exporter::ExportType::VideoFrames},
+        {"stream", Exporter::ExportType::VideoStream}
+    };
+    if (!settings.exportType.empty())
+    {
+        auto it = nameToExportType.find(settings.exportType);
+        if (it == nameToExportType.end())
+        {
+            std::cerr << "Invalid export type " << settings.exportType 
+                      << std::endl;
+            return false;
+        }
+        exporter_->setExportType(it->second);
+    }
+    if (settings.startTime.has_value())
+        exporter_->setStartTime(settings.startTime.value());
+    if (settings.endTime.has_value())
+        exporter_->setEndTime(settings.endTime.value());
+    if (settings.fps.has_value())
+        exporter_->setFps(settings.fps.value());
+    if (settings.resolution.has_value())
+        exporter_->setOutputResolution
+        (
+            settings.resolution.value(), 
+            *sharedUniforms_, 
+            layers_
+        );
+    if (settings.tileSize.has_value())
+        exporter_->setImageTileSize(settings.tileSize.value());
+    if (settings.profile)
+        exporter_->setWritePerformanceReport(true);
+    std::string outputFilepath = 
+        settings.outputFilepath.empty() ? 
+        exporter_->outputFilepath() : 
+        settings.outputFilepath;
+    if (outputFilepath.empty())
+    {
+        std::cerr << "No output filepath provided" << std::endl;
+        return false;
+    }
+    exporter_->requestExport(outputFilepath);
+    return true;
 }
 
 //----------------------------------------------------------------------------//
@@ -295,6 +452,9 @@ void App::newProject()
     Layer::resetSharedSourceEditor();
     layers_.emplace_back(new Layer(layers_, *sharedUniforms_));
     Layer::setRenderingTiles(layers_, 1); // Turn tiled rendering off
+    Layer::Rendering::ResolutionController::dynamicResolutionEnabled = false;
+    Layer::Rendering::adaptiveTiling->setEnabled(false);
+    Layer::Rendering::ResolutionController::scale = 1.f;
     exporter_ = new Exporter();
 }
 
@@ -789,15 +949,147 @@ further reduction of the shader rendering frame rate)");
                 ImGui::SameLine();
                 ImGui::PushItemWidth(8.f*ImGui::GetFontSize());
                 int nRenderingTiles = Layer::Rendering::TileController::nTiles;
-                if (sharedUniforms_->isRenderingPaused())
+                auto& adaptiveTiling = Layer::Rendering::adaptiveTiling;
+                bool disableTiles = 
+                    sharedUniforms_->isRenderingPaused() ||
+                    adaptiveTiling->isEnabled();
+                if (disableTiles)
                     ImGui::BeginDisabled();
                 if (ImGui::InputInt("##nRenderingTiles", &nRenderingTiles))
                 {
                     nRenderingTiles = std::max(nRenderingTiles, 1);
                     Layer::setRenderingTiles(layers_, nRenderingTiles);
                 }
-                if (sharedUniforms_->isRenderingPaused())
+                if (disableTiles)
+                    ImGui::EndDisabled();
+                ImGui::PopItemWidth();
+
+                ImGui::Text("Automatic tiles    ");
+                if (ImGui::IsItemHovered() && ImGui::BeginTooltip())
+                {
+                    ImGui::Text(
+R"(If checked, the GUI fps multiplier (i.e., the number of tiles in which each
+frame is rendered) is automatically adjusted so that the GPU time of rendering
+each tile stays below the tile budget. Long-running GPU submissions may cause
+the graphics driver to reset (e.g., the Windows TDR timeout is 2 seconds) and
+make the GUI unresponsive, while too many tiles waste time on per-tile overhead)");
+                    ImGui::EndTooltip();
+                }
+                ImGui::SameLine();
+                if (!adaptiveTiling->isSupported())
+                    ImGui::BeginDisabled();
+                bool isAdaptiveTilingEnabled = adaptiveTiling->isEnabled();
+                if 
+                (
+                    ImGui::Checkbox
+                    (
+                        "##adaptiveTiling", 
+                        &isAdaptiveTilingEnabled
+                    )
+                )
+                    adaptiveTiling->setEnabled(isAdaptiveTilingEnabled);
+                if (!adaptiveTiling->isSupported())
                     ImGui::EndDisabled();
+                if (adaptiveTiling->isEnabled())
+                {
+                    ImGui::Text("Tile budget        ");
+                    ImGui::SameLine();
+                    ImGui::PushItemWidth(5.0*ImGui::GetFontSize());
+                    float budgetMs = adaptiveTiling->budgetMs();
+                    if 
+                    (
+                        ImGui::InputFloat
+                        (
+                            "##adaptiveTilingBudget", 
+                            &budgetMs, 
+                            0.f, 
+                            0.f, 
+                            "%.1f"
+                        )
+                    )
+                        adaptiveTiling->setBudgetMs(budgetMs);
+                    ImGui::PopItemWidth();
+                    ImGui::SameLine();
+                    ImGui::Text
+                    (
+                        "ms (last tile: %.1f ms)", 
+                        adaptiveTiling->lastTileMs()
+                    );
+                }
+
+                typedef Layer::Rendering::ResolutionController 
+                    ResolutionController;
+                ImGui::Text("Dynamic resolution ");
+                if (ImGui::IsItemHovered() && ImGui::BeginTooltip())
+                {
+                    ImGui::Text(
+R"(If checked, layers rendering directly to the window are rendered at a reduced
+resolution, then upscaled to the window, with the resolution scale continuously
+adjusted to approach the target frame rate. Shaders relying on the window 
+resolution rather than on their own iResolution may render incorrectly. This
+feature is disabled with a GUI fps multiplier larger than one, and layers are 
+always rendered at full resolution during project exports)");
+                    ImGui::EndTooltip();
+                }
+                ImGui::SameLine();
+                if 
+                (
+                    ImGui::Checkbox
+                    (
+                        "##dynamicResolution", 
+                        &ResolutionController::dynamicResolutionEnabled
+                    )
+                )
+                    ResolutionController::scale = 1.f;
+                if (ResolutionController::dynamicResolutionEnabled)
+                {
+                    ImGui::SameLine();
+                    ImGui::Text
+                    (
+                        "(current scale: %.2f)", 
+                        Layer::Rendering::TileController::tiledRenderingEnabled ?
+                        1.f : ResolutionController::scale
+                    );
+                    ImGui::Text("Target frame rate  ");
+                    ImGui::SameLine();
+                    ImGui::PushItemWidth(5.0*ImGui::GetFontSize());
+                    if 
+                    (
+                        ImGui::InputFloat
+                        (
+                            "##dynamicResolutionTargetFps", 
+                            &ResolutionController::targetFps, 
+                            0.f, 
+                            0.f, 
+                            "%.1f"
+                        )
+                    )
+                        ResolutionController::targetFps = 
+                            std::max(ResolutionController::targetFps, 1.f);
+                    ImGui::SameLine();
+                    ImGui::PopItemWidth();
+                    ImGui::Text("fps");
+                    ImGui::Text("Minimum scale      ");
+                    ImGui::SameLine();
+                    ImGui::PushItemWidth(8.0*ImGui::GetFontSize());
+                    if 
+                    (
+                        ImGui::SliderFloat
+                        (
+                            "##dynamicResolutionMinScale", 
+                            &ResolutionController::minScale, 
+                            .1f, 
+                            1.f, 
+                            "%.2f"
+                        )
+                    )
+                        ResolutionController::scale = std::max
+                        (
+                            ResolutionController::scale,
+                            ResolutionController::minScale
+                        );
+                    ImGui::PopItemWidth();
+                }
                 
                 ImGui::Text("Pause render below ");
                 if (ImGui::IsItemHovered() && ImGui::BeginTooltip())
@@ -847,6 +1139,13 @@ project exports)");
 
             for (auto layer : layers_)
                 layer->renderPropertiesMenuGui(resources_);
+            Layer::Rendering::graph->renderMenuItemGui
+            (
+                layers_, 
+                *sharedUniforms_
+            );
+            Layer::Rendering::profiler->renderMenuItemGui();
+            Layer::Rendering::compileStatistics->renderMenuItemGui();
             ImGui::Separator();
             Layer::renderShaderLanguangeExtensionsMenuGui
             (
@@ -917,6 +1216,8 @@ project exports)");
             Layer::Rendering::sharedStorage->renderGui();
     if (CodeRepository::isDetachedFromMenu)
         CodeRepository::renderGui();
+    Layer::Rendering::profiler->renderGui();
+    Layer::Rendering::compileStatistics->renderGui();
     
     if (project_.exampleToBeLoaded != nullptr)
         project_.action = Project::Action::LoadExample;
@@ -0,0 +1,208 @@
+/*
+ _____________________
+|                     |  This file is part of ShaderThing - A GUI-based live
+|   ___  _________    |  shader editor by Stefan Radman (a.k.a., virmodoetiae).
+|  /\  \/\__    __\   |  For more information, visit:
+|  \ \  \/__/\  \_/   |
+|   \ \__   \ \  \    |  https://github.com/virmodoetiae/shaderthing
+|    \/__/\  \ \  \   |
+|        \ \__\ \__\  |  SPDX-FileCopyrightText:    2025 Stefan Radman
+|  Ↄ|C    \/__/\/__/  |                             sradman@protonmail.com
+|  Ↄ|C                |  SPDX-License-Identifier:   Zlib
+|_____________________|
+
+*/
+
+#include <algorithm>
+#include <fstream>
+
+#include "shaderthing/include/compilestatistics.h"
+
+#include "shaderthing/include/bytedata.h"
+#include "shaderthing/include/helpers.h"
+
+#include "thirdparty/imgui/imgui.h"
+
+namespace ShaderThing
+{
+
+void CompileStatistics::record
+(
+    const void* key, 
+    const std::string& name,
+    const vir::Shader& shader,
+    unsigned int nHeaderLines
+)
+{
+    auto it = std::find_if
+    (
+        items_.begin(),
+        items_.end(),
+        [key](const Item& item){return item.key == key;}
+    );
+    if (it == items_.end())
+    {
+        items_.emplace_back();
+        it = items_.end()-1;
+        it->key = key;
+    }
+    it->name = name;
+    it->statistics = shader.statistics();
+    it->nHeaderLines = nHeaderLines;
+    it->nErrors = shader.compilationErrors().size();
+    ++it->nCompilations;
+}
+
+//----------------------------------------------------------------------------//
+
+void CompileStatistics::forget(const void* key)
+{
+    items_.erase
+    (
+        std::remove_if
+        (
+            items_.begin(),
+            items_.end(),
+            [key](const Item& item){return item.key == key;}
+        ),
+        items_.end()
+    );
+}
+
+//----------------------------------------------------------------------------//
+
+bool CompileStatistics::writeCsv(const std::string& filepath) const
+{
+    std::ofstream file(filepath);
+    if (!file.is_open())
+        return false;
+    file << "name,compileMs,linkMs,sourceLength,headerLines,activeUniforms,"
+            "activeSamplers,errors,async,fromBinaryCache,compilations\n";
+    for (const auto& item : items_)
+    {
+        const auto& s = item.statistics;
+        file << "\"" << item.name << "\"," 
+             << 1e3*s.compileTime << ","
+             << 1e3*s.linkTime << ","
+             << s.sourceLength << ","
+             << item.nHeaderLines << ","
+             << s.nActiveUniforms << ","
+             << s.nActiveSamplers << ","
+             << item.nErrors << ","
+             << s.isAsync << ","
+             << s.isFromBinaryCache << ","
+             << item.nCompilations << "\n";
+    }
+    return file.good();
+}
+
+//----------------------------------------------------------------------------//
+
+void CompileStatistics::renderGui()
+{
+    if (fileDialog_.validSelection())
+    {
+        std::string filepath = fileDialog_.selection().front();
+        if (Helpers::fileExtension(filepath) != ".csv")
+            filepath += ".csv";
+        writeCsv(filepath);
+        fileDialog_.clearSelection();
+    }
+    if (!isGuiOpen_)
+        return;
+
+    ImGui::SetNextWindowSize(ImVec2(720, 240), ImGuiCond_FirstUseEver);
+    static ImGuiWindowFlags windowFlags(ImGuiWindowFlags_NoCollapse);
+    ImGui::Begin("Compile statistics", &isGuiOpen_, windowFlags);
+
+    // Refresh icon if needed
+    if (!isGuiIconSet_ || isGuiDocked_ != ImGui::IsWindowDocked())
+    {
+        isGuiIconSet_ = vir::ImGuiRenderer::setWindowIcon
+        (
+            "Compile statistics",
+            ByteData::Icon::sTIconData,
+            ByteData::Icon::sTIconSize,
+            false
+        );
+        isGuiDocked_ = ImGui::IsWindowDocked();
+    }
+
+    float fontSize = ImGui::GetFontSize();
+    ImGuiTableFlags flags =
+        ImGuiTableFlags_BordersV |
+        ImGuiTableFlags_BordersOuterH |
+        ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("##compileStatisticsTable", 8, flags))
+    {
+        static ImGuiTableColumnFlags flags = 0;
+        ImGui::TableSetupColumn("Layer", flags, 8.f*fontSize);
+        ImGui::TableSetupColumn("Compile [ms]", flags, 5.5f*fontSize);
+        ImGui::TableSetupColumn("Link [ms]", flags, 4.5f*fontSize);
+        ImGui::TableSetupColumn("Source [kB]", flags, 5.f*fontSize);
+        ImGui::TableSetupColumn("Header lines", flags, 5.5f*fontSize);
+        ImGui::TableSetupColumn("Uniforms", flags, 4.f*fontSize);
+        ImGui::TableSetupColumn("Samplers", flags, 4.f*fontSize);
+        ImGui::TableSetupColumn("Status", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+        for (const auto& item : items_)
+        {
+            const auto& s = item.statistics;
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%s", item.name.c_str());
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.2f", 1e3*s.compileTime);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.2f", 1e3*s.linkTime);
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%.1f", s.sourceLength/1024.);
+            ImGui::TableSetColumnIndex(4);
+            ImGui::Text("%u", item.nHeaderLines);
+            ImGui::TableSetColumnIndex(5);
+            ImGui::Text("%d", s.nActiveUniforms);
+            ImGui::TableSetColumnIndex(6);
+            ImGui::Text("%d", s.nActiveSamplers);
+            ImGui::TableSetColumnIndex(7);
+            if (item.nErrors > 0)
+                ImGui::Text("%u errors", item.nErrors);
+            else
+                ImGui::Text
+                (
+                    "%s",
+                    s.isFromBinaryCache ? "OK (cached binary)" :
+                    s.isAsync ? "OK (background)" : "OK"
+                );
+        }
+        ImGui::EndTable();
+    }
+    if (ImGui::Button("Export to CSV", ImVec2(-1, 0)))
+        fileDialog_.runSaveFileDialog
+        (
+            "Export compile statistics",
+            {"CSV files (*.csv)", "*.csv"}
+        );
+    ImGui::End();
+}
+
+//----------------------------------------------------------------------------//
+
+void CompileStatistics::renderMenuItemGui()
+{
+    ImGui::MenuItem("Compile statistics", NULL, &isGuiOpen_);
+    if
+    (
+        ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) &&
+        ImGui::BeginTooltip()
+    )
+    {
+        ImGui::Text(
+R"(Shows the compile and link times, source sizes and number of active
+uniforms and samplers of the most recent shader compilation of each layer.
+For shaders compiled in the background, the compile time is the time until
+the compilation was detected as complete, linking included)");
+        ImGui::EndTooltip();
+    }
+}
+
+}
@@ -14,6 +14,8 @@
 */
 
 #include <charconv>
+#include <cstring>
+#include <thread>
 
 #include "shaderthing/include/exporter.h"
 
@@ -26,7 +28,6 @@
 
 #include "vir/include/vir.h"
 
-#include "thirdparty/stb/stb_image_write.h"
 #include "thirdparty/icons/IconsFontAwesome5.h"
 
 namespace ShaderThing
@@ -36,13 +37,21 @@ Exporter::Exporter()
 {
     tuneIntoEventBroadcaster();
     gifEncoder_ = new vir::GifEncoder();
+    pngEncoder_ = new vir::PngEncoder();
+    videoEncoder_ = new vir::RawVideoEncoder();
+    pngStreamEncoder_ = new vir::PngStreamEncoder();
 }
 
 //----------------------------------------------------------------------------//
 
 Exporter::~Exporter()
 {
+    closeLayerOutputs();
     DELETE_IF_NOT_NULLPTR(gifEncoder_);
+    DELETE_IF_NOT_NULLPTR(pngEncoder_);
+    DELETE_IF_NOT_NULLPTR(videoEncoder_);
+    DELETE_IF_NOT_NULLPTR(pngStreamEncoder_);
+    deleteReadbackBuffers(readback_);
 }
 
 //----------------------------------------------------------------------------//
@@ -71,11 +80,20 @@ void Exporter::update
             settings_.outputFilepath = fileDialog_.selection().front();
             fileDialog_.clearSelection();
         }
+        else if (!requestedOutputFilepath_.empty())
+        {
+            isRunning_ = true;
+            settings_.outputFilepath = requestedOutputFilepath_;
+            requestedOutputFilepath_.clear();
+        }
         else
             return;
+        hasLastExportFailed_ = false;
         
         // Setup
         frame_ = 0;
+        if (exportType_ == ExportType::GIF)
+            settings_.fps = 100.f/int(100.f/std::min(settings_.fps,100.f)+.5f);
         if (exportType_ != ExportType::Image)
         {
             float Dt = settings_.endTime-settings_.startTime;
@@ -91,14 +109,87 @@ void Exporter::update
 
         DELETE_IF_NOT_NULLPTR(framebuffer_);
         auto outputResolution = sharedUniforms.exportData().resolution;
+        glm::ivec2 tileSize(settings_.imageTileSize);
+        bool exportInTiles
+        (
+            exportType_ == ExportType::Image &&
+            settings_.imageTileSize > 0 &&
+            (outputResolution.x > tileSize.x || outputResolution.y > tileSize.y) &&
+            canExportInTiles(layers)
+        );
+        if (exportInTiles)
+        {
+            tileResolution_ = glm::min(outputResolution, tileSize);
+            nTiles_ = (outputResolution+tileResolution_-1)/tileResolution_;
+            nTilesWritten_ = 0;
+            nFrames_ = nTiles_.x*nTiles_.y;
+        }
+        else
+            nTiles_ = {0, 0};
         framebuffer_ = vir::Framebuffer::create
         (
-            outputResolution.x, 
-            outputResolution.y
+            exportInTiles ? tileResolution_.x : outputResolution.x, 
+            exportInTiles ? tileResolution_.y : outputResolution.y
         );
-        DELETE_IF_NOT_NULLPTR(framebufferData_);
-        framebufferData_ = 
-            new unsigned char[framebuffer_->colorBufferDataSize()];
+        if (exportType_ == ExportType::VideoStream)
+        {
+            videoEncoder_->setAsyncEncoding
+            (
+                settings_.videoStreamMaxFramesInFlight
+            );
+            if 
+            (
+                !videoEncoder_->openFile
+                (
+                    settings_.outputFilepath,
+                    outputResolution.x,
+                    outputResolution.y,
+                    settings_.fps,
+                    settings_.videoStreamFormat,
+                    nFrames_
+                )
+            )
+                hasLastExportFailed_ = true;
+        }
+        else if (exportInTiles)
+        {
+            unsigned int nChannels = framebuffer_->colorBufferNChannels();
+            tileRowData_.resize
+            (
+                (size_t)outputResolution.x*tileResolution_.y*nChannels
+            );
+            if 
+            (
+                !pngStreamEncoder_->openFile
+                (
+                    settings_.outputFilepath,
+                    outputResolution.x,
+                    outputResolution.y,
+                    nChannels,
+                    settings_.pngCompressionLevel
+                )
+            )
+                hasLastExportFailed_ = true;
+        }
+        else if (exportType_ != ExportType::GIF)
+        {
+            // Leave one hardware thread to the render/main thread
+            unsigned int nWorkers = 
+                settings_.pngMaxFramesInFlight == 0 ? 0 :
+                std::min
+                (
+                    settings_.pngMaxFramesInFlight, 
+                    std::max(std::thread::hardware_concurrency(), 2u)-1
+                );
+            pngEncoder_->setCompressionLevel(settings_.pngCompressionLevel);
+            pngEncoder_->setAsyncEncoding
+            (
+                nWorkers, 
+                settings_.pngMaxFramesInFlight
+            );
+        }
+        if (exportType_ != ExportType::GIF)
+            createReadbackBuffers(readback_);
 
         vSyncStatusBeforeExport = vir::Window::instance()->VSync();
         vir::Window::instance()->setVSync(false);
@@ -107,7 +198,7 @@ void Exporter::update
             exportType_ != ExportType::Image,
             settings_.startTime
         );
-        Layer::prepareForExport(layers);
+        Layer::prepareForExport(layers, exportInTiles);
         Resource::prepareAnimationsForExport
         (
             resources,
@@ -117,23 +208,50 @@ void Exporter::update
         );
 
         if (exportType_ == ExportType::GIF && !gifEncoder_->isFileOpen())
-            gifEncoder_->openFile
-            ( 
-                settings_.outputFilepath.c_str(),
-                sharedUniforms.exportData().resolution.x, 
-                sharedUniforms.exportData().resolution.y, 
-                settings_.gifPaletteBitDepth,
-                settings_.gifPaletteMode,
-                settings_.gifAlphaCutoff > 0 ?
-                    vir::Quantizer::Settings::IndexMode::Alpha :
-                    vir::Quantizer::Settings::IndexMode::Default
+        {
+            // Leave one hardware thread to the render/main thread
+            unsigned int nWorkers = 
+                settings_.gifMaxFramesInFlight == 0 ? 0 :
+                std::min
+                (
+                    settings_.gifMaxFramesInFlight, 
+                    std::max(std::thread::hardware_concurrency(), 2u)-1
+                );
+            gifEncoder_->setQuantizerDevice(settings_.gifQuantizerDevice);
+            gifEncoder_->setAsyncEncoding
+            (
+                nWorkers, 
+                settings_.gifMaxFramesInFlight
             );
+            if
+            (
+                !gifEncoder_->openFile
+                ( 
+                    settings_.outputFilepath.c_str(),
+                    sharedUniforms.exportData().resolution.x, 
+                    sharedUniforms.exportData().resolution.y, 
+                    settings_.gifPaletteBitDepth,
+                    settings_.gifPaletteMode,
+                    settings_.gifDeltaEncoding ?
+                        vir::Quantizer::Settings::IndexMode::Delta :
+                    settings_.gifAlphaCutoff > 0 ?
+                        vir::Quantizer::Settings::IndexMode::Alpha :
+                        vir::Quantizer::Settings::IndexMode::Default
+                )
+            )
+                hasLastExportFailed_ = true;
+        }
+        if (!exportInTiles)
+            setupLayerOutputs(layers);
+        collectEncoderStats();
+        profiler_.start();
     }
     else if (frame_ == nFrames_) // Terminate (or end palette cumulation)
     {
         frame_ = 0;
         if 
         (
+            exportType_ == ExportType::GIF &&
             settings_.gifPaletteMode == PaletteMode::StaticAveraged && 
             !isAveragedPaletteReady_
         )
@@ -146,11 +264,40 @@ void Exporter::update
         {
             isRunning_ = false;
             
+            flushReadbacks
+            (
+                readback_, 
+                exportType_ == ExportType::VideoStream ? videoEncoder_ : nullptr
+            );
+            deleteReadbackBuffers(readback_);
+            closeLayerOutputs();
+            if (pngEncoder_->finish() > 0)
+                hasLastExportFailed_ = true;
+            if (videoEncoder_->isFileOpen() && !videoEncoder_->closeFile())
+                hasLastExportFailed_ = true;
+            if 
+            (
+                pngStreamEncoder_->isFileOpen() && 
+                !pngStreamEncoder_->closeFile()
+            )
+                hasLastExportFailed_ = true;
+            nTiles_ = {0, 0};
+            tileRowData_.clear();
+            tileRowData_.shrink_to_fit();
             DELETE_IF_NOT_NULLPTR(framebuffer_)
-            DELETE_IF_NOT_NULLPTR(framebufferData_)
 
-            if (gifEncoder_->isFileOpen())
-                gifEncoder_->closeFile();
+            if (gifEncoder_->isFileOpen() && !gifEncoder_->closeFile())
+                hasLastExportFailed_ = true;
+            collectEncoderStats();
+            profiler_.stop();
+            // A report that cannot be written does not fail the export itself
+            if (settings_.writePerformanceReport)
+                profiler_.writeReport
+                (
+                    performanceReportFilepath(),
+                    settings_.outputFilepath,
+                    settings_.outputResolution
+                );
             
             vir::Window::instance()->setVSync(vSyncStatusBeforeExport);
             sharedUniforms.resetAfterExport
@@ -162,6 +309,10 @@ void Exporter::update
             isAveragedPaletteReady_ = false;
         }
     }
+
+    // Select the tile to be rendered next
+    if (isRunning_ && nTiles_.x > 0)
+        sharedUniforms.setExportTile(tileOffset(frame_), tileResolution_);
 }
 
 //----------------------------------------------------------------------------//
@@ -176,34 +327,26 @@ void Exporter::writeOutput()
         case (ExportType::Image) :
         case (ExportType::VideoFrames) :
         {
-            const char* filepath;
+            std::string filepath;
             if (exportType_ == ExportType::VideoFrames)
             {
-                // Save frame FPS and frame number in out path as well. If
-                // the FPS is not an integer, the '.' is replaced by a 'd'
-                // (for 'dot') so not to mess with the file extension
-                auto fps = Helpers::format(settings_.fps, 2);
-                std::replace(fps.begin(), fps.end(), '.', 'd');
-                fps = "_"+fps+"_"+std::to_string(frame_);
                 cache_.outputFilepathExtended = 
-                    Helpers::appendToFilename
-                    (
-                        settings_.outputFilepath, 
-                        fps
-                    );
-                filepath = cache_.outputFilepathExtended.c_str();
+                    videoFrameFilepath(settings_.outputFilepath);
+                filepath = cache_.outputFilepathExtended;
             }
             else
-                filepath = settings_.outputFilepath.c_str();
-            framebuffer_->readColorBufferData(framebufferData_, true, false);
-            stbi_write_png
-            (
-                filepath, 
-                settings_.outputResolution.x,
-                settings_.outputResolution.y,
-                4, 
-                (const void*)framebufferData_, 
-                4*settings_.outputResolution.x // <- stride
+                filepath = settings_.outputFilepath;
+            queueReadback(readback_, framebuffer_, filepath, nullptr);
+            break;
+        }
+        case (ExportType::VideoStream) :
+        {
+            queueReadback
+            (
+                readback_, 
+                framebuffer_, 
+                settings_.outputFilepath, 
+                videoEncoder_
             );
             break;
         }
@@ -216,6 +359,8 @@ void Exporter::writeOutput()
             )
                 gifEncoder_->cumulatePaletteForAveraging(framebuffer_);
             else
+            {
+                auto start = ExportProfiler::Clock::now();
                 gifEncoder_->encodeFrame
                 (
                     framebuffer_,
@@ -224,12 +369,453 @@ void Exporter::writeOutput()
                         true,                                   // flip Y
                         settings_.gifDitherMode,                // 
                         0,                                      // Dither thres.
-                        (int)settings_.gifAlphaCutoff
+                        settings_.gifDeltaEncoding ? 
+                            -1 : (int)settings_.gifAlphaCutoff
                     }
                 );
+                profiler_.record
+                (
+                    ExportProfiler::Stage::Submission,
+                    vir::EncoderStats::secondsSince(start)
+                );
+            }
             break;
         }
     }
+    writeLayerOutputs();
+    collectEncoderStats();
+    profiler_.recordFrame();
+}
+
+//----------------------------------------------------------------------------//
+
+void Exporter::setOutputResolution
+(
+    glm::ivec2 resolution,
+    SharedUniforms& sharedUniforms, 
+    const std::vector<Layer*>& layers
+)
+{
+    auto window = vir::Window::instance();
+    glm::ivec2& outputResolution = sharedUniforms.exportData().resolution;
+    float& outputScale = sharedUniforms.exportData().resolutionScale;
+    outputResolution.x = std::max(resolution.x, 1);
+    outputResolution.y = std::max(resolution.y, 1);
+    outputScale = 
+        outputResolution.x > outputResolution.y ?
+        (float)outputResolution.x/window->width() :
+        (float)outputResolution.y/window->height();
+    for (auto layer : layers)
+    {
+        auto& exportData = layer->exportData();
+        exportData.windowResolutionScale = outputScale;
+        if (exportData.rescaleWithOutput)
+            exportData.resolution = 
+                (glm::vec2)layer->resolution()*
+                exportData.resolutionScale*outputScale + .5f;
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+void Exporter::queueReadback
+(
+    ReadbackRing& readback,
+    vir::Framebuffer* framebuffer,
+    const std::string& filepath,
+    vir::RawVideoEncoder* videoEncoder
+)
+{
+    // Write the readback queued nReadbackBuffers frames ago (if any), whose
+    // data has most likely already been transferred by now, then re-use its
+    // buffer for the current frame. The time spent in the encoders is not
+    // accounted for as readback time
+    auto start = ExportProfiler::Clock::now();
+    double submissionTime = 0;
+    auto buffer = readback.buffers[readback.index];
+    if (buffer->isPending())
+        submissionTime = writeReadback(readback, readback.index, videoEncoder);
+    buffer->readColorBufferData(framebuffer);
+    readback.filepaths[readback.index] = filepath;
+    readback.index = (readback.index+1) % readback.buffers.size();
+    profiler_.record
+    (
+        ExportProfiler::Stage::Readback,
+        vir::EncoderStats::secondsSince(start)-submissionTime
+    );
+}
+
+//----------------------------------------------------------------------------//
+
+double Exporter::writeReadback
+(
+    ReadbackRing& readback, 
+    unsigned int index,
+    vir::RawVideoEncoder* videoEncoder
+)
+{
+    auto buffer = readback.buffers[index];
+    const unsigned char* data = buffer->mapData();
+    // Frames which cannot be written fail the export rather than being
+    // silently dropped
+    if 
+    (
+        data == nullptr || 
+        (videoEncoder != nullptr && !videoEncoder->isFileOpen())
+    )
+    {
+        hasLastExportFailed_ = true;
+        buffer->unmapData();
+        return 0;
+    }
+    auto start = ExportProfiler::Clock::now();
+    // The data rows are stored bottom-to-top, hence the vertical flip. In
+    // asynchronous mode, the encoders only copy the data before returning.
+    // Only the composite output is ever exported in tiles
+    if (nTiles_.x > 0)
+        writeTile(data, buffer->nChannels());
+    else if (videoEncoder != nullptr)
+        videoEncoder->encodeFrame(data, true);
+    else
+        pngEncoder_->encodeFrame
+        (
+            data,
+            buffer->width(),
+            buffer->height(),
+            buffer->nChannels(),
+            readback.filepaths[index],
+            true
+        );
+    double submissionTime = vir::EncoderStats::secondsSince(start);
+    profiler_.record(ExportProfiler::Stage::Submission, submissionTime);
+    buffer->unmapData();
+    return submissionTime;
+}
+
+//----------------------------------------------------------------------------//
+
+void Exporter::flushReadbacks
+(
+    ReadbackRing& readback, 
+    vir::RawVideoEncoder* videoEncoder
+)
+{
+    // Write all pending readbacks, oldest first
+    unsigned int nBuffers = readback.buffers.size();
+    for (unsigned int i=0; i<nBuffers; i++)
+    {
+        unsigned int index = (readback.index+i) % nBuffers;
+        if (readback.buffers[index]->isPending())
+            writeReadback(readback, index, videoEncoder);
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+void Exporter::createReadbackBuffers(ReadbackRing& readback)
+{
+    deleteReadbackBuffers(readback);
+    readback.buffers.resize(nReadbackBuffers, nullptr);
+    readback.filepaths.resize(nReadbackBuffers);
+    for (auto& buffer : readback.buffers)
+        buffer = vir::PixelPackBuffer::create();
+    readback.index = 0;
+}
+
+//----------------------------------------------------------------------------//
+
+void Exporter::deleteReadbackBuffers(ReadbackRing& readback)
+{
+    for (auto& buffer : readback.buffers)
+    {
+        DELETE_IF_NOT_NULLPTR(buffer)
+    }
+    readback.buffers.clear();
+    readback.filepaths.clear();
+}
+
+//----------------------------------------------------------------------------//
+
+std::string Exporter::videoFrameFilepath(const std::string& filepath) const
+{
+    // Save frame FPS and frame number in out path as well. If the FPS is not
+    // an integer, the '.' is replaced by a 'd' (for 'dot') so not to mess with
+    // the file extension
+    auto fps = Helpers::format(settings_.fps, 2);
+    std::replace(fps.begin(), fps.end(), '.', 'd');
+    fps = "_"+fps+"_"+std::to_string(frame_);
+    return Helpers::appendToFilename(filepath, fps);
+}
+
+//----------------------------------------------------------------------------//
+
+void Exporter::setupLayerOutputs(const std::vector<Layer*>& layers)
+{
+    closeLayerOutputs();
+    // Layers rendering only to the window have no framebuffer of their own,
+    // and video streams written to stdout cannot be accompanied by others
+    if 
+    (
+        exportType_ == ExportType::VideoStream && 
+        settings_.outputFilepath == "-"
+    )
+        return;
+    for (auto layer : layers)
+    {
+        if 
+        (
+            !layer->exportData().exportFramebuffer ||
+            layer->renderingTarget() == Layer::Rendering::Target::Window
+        )
+            continue;
+        LayerOutput output;
+        output.layer = layer;
+        output.filepath = 
+            Helpers::appendToFilename
+            (
+                settings_.outputFilepath, 
+                "_"+layer->name()
+            );
+        glm::ivec2 resolution = layer->exportData().resolution;
+        if (exportType_ == ExportType::GIF)
+        {
+            output.gifEncoder = new vir::GifEncoder();
+            output.gifEncoder->setQuantizerDevice(settings_.gifQuantizerDevice);
+            // Encoded synchronously, as the encoder of the composite output
+            // already uses the available hardware threads
+            if
+            (
+                !output.gifEncoder->openFile
+                ( 
+                    output.filepath.c_str(),
+                    resolution.x, 
+                    resolution.y, 
+                    settings_.gifPaletteBitDepth,
+                    settings_.gifPaletteMode,
+                    settings_.gifDeltaEncoding ?
+                        vir::Quantizer::Settings::IndexMode::Delta :
+                    settings_.gifAlphaCutoff > 0 ?
+                        vir::Quantizer::Settings::IndexMode::Alpha :
+                        vir::Quantizer::Settings::IndexMode::Default
+                )
+            )
+                hasLastExportFailed_ = true;
+        }
+        else
+        {
+            if (exportType_ == ExportType::VideoStream)
+            {
+                output.videoEncoder = new vir::RawVideoEncoder();
+                output.videoEncoder->setAsyncEncoding
+                (
+                    settings_.videoStreamMaxFramesInFlight
+                );
+                if 
+                (
+                    !output.videoEncoder->openFile
+                    (
+                        output.filepath,
+                        resolution.x,
+                        resolution.y,
+                        settings_.fps,
+                        settings_.videoStreamFormat,
+                        nFrames_
+                    )
+                )
+                    hasLastExportFailed_ = true;
+            }
+            createReadbackBuffers(output.readback);
+        }
+        layerOutputs_.push_back(output);
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+void Exporter::writeLayerOutputs()
+{
+    for (auto& output : layerOutputs_)
+    {
+        auto framebuffer = output.layer->resourceFramebuffer();
+        switch (exportType_)
+        {
+            case (ExportType::Image) :
+                queueReadback
+                (
+                    output.readback, 
+                    framebuffer, 
+                    output.filepath, 
+                    nullptr
+                );
+                break;
+            case (ExportType::VideoFrames) :
+                queueReadback
+                (
+                    output.readback, 
+                    framebuffer, 
+                    videoFrameFilepath(output.filepath), 
+                    nullptr
+                );
+                break;
+            case (ExportType::VideoStream) :
+                queueReadback
+                (
+                    output.readback, 
+                    framebuffer, 
+                    output.filepath, 
+                    output.videoEncoder
+                );
+                break;
+            case (ExportType::GIF) :
+            {
+                if 
+                (
+                    settings_.gifPaletteMode == PaletteMode::StaticAveraged &&
+                    !isAveragedPaletteReady_
+                )
+                {
+                    output.gifEncoder->cumulatePaletteForAveraging(framebuffer);
+                    break;
+                }
+                auto start = ExportProfiler::Clock::now();
+                output.gifEncoder->encodeFrame
+                (
+                    framebuffer,
+                    {
+                        std::max(int(100.0f/settings_.fps), 1),
+                        true,
+                        settings_.gifDitherMode,
+                        0,
+                        settings_.gifDeltaEncoding ? 
+                            -1 : (int)settings_.gifAlphaCutoff
+                    }
+                );
+                profiler_.record
+                (
+                    ExportProfiler::Stage::Submission,
+                    vir::EncoderStats::secondsSince(start)
+                );
+                break;
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+void Exporter::closeLayerOutputs()
+{
+    // Layer image and video frame readbacks are written by the shared PNG
+    // encoder, which is finished by the caller
+    for (auto& output : layerOutputs_)
+    {
+        flushReadbacks(output.readback, output.videoEncoder);
+        deleteReadbackBuffers(output.readback);
+        if (output.videoEncoder != nullptr)
+        {
+            if 
+            (
+                output.videoEncoder->isFileOpen() && 
+                !output.videoEncoder->closeFile()
+            )
+                hasLastExportFailed_ = true;
+            profiler_.collect(output.videoEncoder->stats());
+            DELETE_IF_NOT_NULLPTR(output.videoEncoder)
+        }
+        if (output.gifEncoder != nullptr)
+        {
+            if 
+            (
+                output.gifEncoder->isFileOpen() && 
+                !output.gifEncoder->closeFile()
+            )
+                hasLastExportFailed_ = true;
+            profiler_.collect(output.gifEncoder->stats());
+            DELETE_IF_NOT_NULLPTR(output.gifEncoder)
+        }
+    }
+    layerOutputs_.clear();
+}
+
+//----------------------------------------------------------------------------//
+
+glm::ivec2 Exporter::tileOffset(unsigned int tile) const
+{
+    return 
+    {
+        (tile % nTiles_.x)*tileResolution_.x,
+        (nTiles_.y-1-(int)tile/nTiles_.x)*tileResolution_.y
+    };
+}
+
+//----------------------------------------------------------------------------//
+
+void Exporter::writeTile(const unsigned char* data, unsigned int nChannels)
+{
+    // Tiles are read back in the same order in which they are rendered. Copy
+    // the tile to the current row of tiles, cropping whatever exceeds the 
+    // output resolution, and stream the row once complete
+    glm::ivec2 offset = tileOffset(nTilesWritten_);
+    glm::ivec2 outputResolution(settings_.outputResolution);
+    int width = std::min(tileResolution_.x, outputResolution.x-offset.x);
+    int height = std::min(tileResolution_.y, outputResolution.y-offset.y);
+    size_t tileRowSize = (size_t)tileResolution_.x*nChannels;
+    size_t rowSize = (size_t)outputResolution.x*nChannels;
+    for (int y=0; y<height; y++)
+        std::memcpy
+        (
+            tileRowData_.data()+y*rowSize+(size_t)offset.x*nChannels,
+            data+y*tileRowSize,
+            (size_t)width*nChannels
+        );
+    if (++nTilesWritten_ % nTiles_.x == 0)
+        pngStreamEncoder_->encodeRows(tileRowData_.data(), height, true);
+}
+
+//----------------------------------------------------------------------------//
+
+void Exporter::collectEncoderStats()
+{
+    profiler_.collect(gifEncoder_->stats());
+    profiler_.collect(pngEncoder_->stats());
+    profiler_.collect(videoEncoder_->stats());
+    profiler_.collect(pngStreamEncoder_->stats());
+    for (auto& output : layerOutputs_)
+    {
+        if (output.gifEncoder != nullptr)
+            profiler_.collect(output.gifEncoder->stats());
+        if (output.videoEncoder != nullptr)
+            profiler_.collect(output.videoEncoder->stats());
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+std::string Exporter::performanceReportFilepath() const
+{
+    // Video streams written to stdout have no output filepath to go by
+    if (settings_.outputFilepath == "-")
+        return "shaderthing_export_profile.json";
+    std::string filepathNoExtension, extension;
+    Helpers::splitFilepath
+    (
+        settings_.outputFilepath, 
+        filepathNoExtension, 
+        extension
+    );
+    return filepathNoExtension+"_profile.json";
+}
+
+//----------------------------------------------------------------------------//
+
+bool Exporter::canExportInTiles(const std::vector<Layer*>& layers)
+{
+    for (auto layer : layers)
+    {
+        if (layer->renderingTarget() != Layer::Rendering::Target::Window)
+            return false;
+    }
+    return true;
 }
 
 //----------------------------------------------------------------------------//
@@ -247,7 +833,8 @@ void Exporter::renderGui
     static std::map<ExportType, const char*> exportTypeToName = {
         {ExportType::Image, "Image"},
         {ExportType::GIF, "GIF"},
-        {ExportType::VideoFrames, "Video frames"}
+        {ExportType::VideoFrames, "Video frames"},
+        {ExportType::VideoStream, "Video stream"}
     };
 
     ImGui::PushItemWidth(-1);
@@ -371,6 +958,29 @@ R"(Determines the GIF palette size. The number of colors in the palette is
             }
             ImGui::PopItemWidth();
             
+            ImGui::Text("Delta encoding              ");
+            if 
+            (
+                ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) && 
+                ImGui::BeginTooltip()
+            )
+            {
+                ImGui::Text(
+R"(If enabled, each frame only stores the smallest rectangular region containing
+all the pixels that changed with respect to the previous frame. This greatly
+reduces file size and export time for mostly static animations, but it is not
+compatible with transparency)");
+                ImGui::EndTooltip();
+            }
+            ImGui::SameLine();
+            ImGui::Checkbox
+            (
+                "##exporterGifDeltaEncoding", 
+                &settings_.gifDeltaEncoding
+            );
+
+            if (settings_.gifDeltaEncoding)
+                ImGui::BeginDisabled();
             ImGui::Text("Transparency cutoff         ");
             if 
             (
@@ -394,6 +1004,8 @@ transparency)");
                 255
             );
             ImGui::PopItemWidth();
+            if (settings_.gifDeltaEncoding)
+                ImGui::EndDisabled();
             ImGui::Text("Color dithering             ");
             ImGui::SameLine();
             ImGui::PushItemWidth(-1);
@@ -420,8 +1032,232 @@ transparency)");
                 ImGui::EndCombo();
             }
             ImGui::PopItemWidth();
+
+            ImGui::Text("Quantization device         ");
+            if 
+            (
+                ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) && 
+                ImGui::BeginTooltip()
+            )
+            {
+                ImGui::Text(
+R"(Device on which the color palette of each frame is computed. The GPU is
+faster, but requires OpenGL v4.3 or above. The CPU runs on any system and its
+results are fully reproducible)");
+                ImGui::EndTooltip();
+            }
+            ImGui::SameLine();
+            ImGui::PushItemWidth(-1);
+            if (!gifEncoder_->isGPUQuantizerAvailable())
+                settings_.gifQuantizerDevice = QuantizerDevice::CPU;
+            if 
+            (
+                ImGui::BeginCombo
+                (
+                    "##gifQuantizerDeviceSelector", 
+                    vir::Quantizer::deviceToName.at
+                    (
+                        settings_.gifQuantizerDevice
+                    ).c_str()
+                )
+            )
+            {
+                for(auto e : vir::Quantizer::deviceToName)
+                {
+                    bool disabled
+                    (
+                        e.first == QuantizerDevice::GPU &&
+                        !gifEncoder_->isGPUQuantizerAvailable()
+                    );
+                    if (disabled)
+                        ImGui::BeginDisabled();
+                    if 
+                    (
+                        ImGui::Selectable
+                        (
+                            disabled ? 
+                            "GPU (requires OpenGL v4.3 or above)" :
+                            e.second.c_str()
+                        )
+                    )
+                        settings_.gifQuantizerDevice = e.first;
+                    if (disabled)
+                        ImGui::EndDisabled();
+                }
+                ImGui::EndCombo();
+            }
+            ImGui::PopItemWidth();
+
+            ImGui::Text("Frames encoded in parallel  ");
+            if 
+            (
+                ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) && 
+                ImGui::BeginTooltip()
+            )
+            {
+                ImGui::Text(
+R"(Maximum number of frames that can be compressed by background threads while
+rendering continues. Larger values use more memory and more CPU cores. If set
+to 0, each frame is compressed before rendering the next one)");
+                ImGui::EndTooltip();
+            }
+            ImGui::SameLine();
+            ImGui::PushItemWidth(-1);
+            ImGui::SliderInt
+            (
+                "##exporterGifMaxFramesInFlight", 
+                (int*)&settings_.gifMaxFramesInFlight, 
+                0, 
+                64
+            );
+            ImGui::PopItemWidth();
+        }
+        else if (exportType_ == ExportType::VideoStream)
+        {
+            ImGui::Text("Stream format               ");
+            if 
+            (
+                ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) && 
+                ImGui::BeginTooltip()
+            )
+            {
+                ImGui::Text(
+R"(All frames are streamed to a single uncompressed file, which can be fed to
+an external video encoder. Raw RGBA files have no header, so the resolution and
+frame rate must be provided to the encoder, e.g.:
+ffmpeg -f rawvideo -pix_fmt rgba -s WxH -r FPS -i file.rgba out.mp4)");
+                ImGui::EndTooltip();
+            }
+            ImGui::SameLine();
+            ImGui::PushItemWidth(-1);
+            if 
+            (
+                ImGui::BeginCombo
+                (
+                    "##videoStreamFormatSelector", 
+                    vir::RawVideoEncoder::formatToName
+                    [
+                        settings_.videoStreamFormat
+                    ]
+                )
+            )
+            {
+                for(auto e : vir::RawVideoEncoder::formatToName)
+                {
+                    if (ImGui::Selectable(e.second))
+                        settings_.videoStreamFormat = e.first;
+                }
+                ImGui::EndCombo();
+            }
+            ImGui::PopItemWidth();
+
+            ImGui::Text("Frames in flight            ");
+            if 
+            (
+                ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) && 
+                ImGui::BeginTooltip()
+            )
+            {
+                ImGui::Text(
+R"(Maximum number of frames that can be converted and written by a background
+thread while rendering continues. Larger values use more memory. If set to 0,
+each frame is written before rendering the next one)");
+                ImGui::EndTooltip();
+            }
+            ImGui::SameLine();
+            ImGui::PushItemWidth(-1);
+            ImGui::SliderInt
+            (
+                "##exporterVideoStreamMaxFramesInFlight", 
+                (int*)&settings_.videoStreamMaxFramesInFlight, 
+                0, 
+                64
+            );
+            ImGui::PopItemWidth();
+        }
+        else
+        {
+            ImGui::Text("Frames encoded in parallel  ");
+            if 
+            (
+                ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) && 
+                ImGui::BeginTooltip()
+            )
+            {
+                ImGui::Text(
+R"(Maximum number of frames that can be compressed and written by background
+threads while rendering continues. Larger values use more memory and more CPU
+cores. If set to 0, each frame is written before rendering the next one)");
+                ImGui::EndTooltip();
+            }
+            ImGui::SameLine();
+            ImGui::PushItemWidth(-1);
+            ImGui::SliderInt
+            (
+                "##exporterPngMaxFramesInFlight", 
+                (int*)&settings_.pngMaxFramesInFlight, 
+                0, 
+                64
+            );
+            ImGui::PopItemWidth();
         }
     }
+    if 
+    (
+        exportType_ == ExportType::Image || 
+        exportType_ == ExportType::VideoFrames
+    )
+    {
+        ImGui::Text("PNG compression level       ");
+        if 
+        (
+            ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) && 
+            ImGui::BeginTooltip()
+        )
+        {
+            ImGui::Text(
+R"(From 0 (fastest, largest files) to 9 (slowest, smallest files))");
+            ImGui::EndTooltip();
+        }
+        ImGui::SameLine();
+        ImGui::PushItemWidth(-1);
+        ImGui::SliderInt
+        (
+            "##exporterPngCompressionLevel", 
+            &settings_.pngCompressionLevel, 
+            0, 
+            9
+        );
+        ImGui::PopItemWidth();
+    }
+    if (exportType_ == ExportType::Image)
+    {
+        bool disabled = !canExportInTiles(layers);
+        ImGui::Text("Tile size                   ");
+        if 
+        (
+            ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) && 
+            ImGui::BeginTooltip()
+        )
+        {
+            ImGui::Text(
+R"(If larger than 0, images wider or taller than this size are rendered in 
+tiles of this size and streamed to disk row of tiles by row of tiles, so that
+the output resolution is not limited by the maximum texture size or by the 
+available GPU memory. Only available if all layers render to the window)");
+            ImGui::EndTooltip();
+        }
+        ImGui::SameLine();
+        ImGui::PushItemWidth(-1);
+        if (disabled)
+            ImGui::BeginDisabled();
+        int tileSize = settings_.imageTileSize;
+        ImGui::InputInt("##exporterImageTileSize", &tileSize, 256, 1024);
+        settings_.imageTileSize = std::max(tileSize, 0);
+        if (disabled)
+            ImGui::EndDisabled();
+        ImGui::PopItemWidth();
+    }
     if (exportType_ != ExportType::Image)
         ImGui::Text("Render passes per frame     ");
     else
@@ -451,6 +1287,26 @@ transparency)");
         &settings_.resetFrameCounterAfterExport
     );
 
+    ImGui::Text("Write performance report    ");
+    if 
+    (
+        ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) && 
+        ImGui::BeginTooltip()
+    )
+    {
+        ImGui::Text(
+R"(If checked, the frames per second, the bytes written and the statistics of
+the time spent in each stage of the export are written to a JSON file next
+to the exported file, with the '_profile' suffix)");
+        ImGui::EndTooltip();
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox
+    (
+        "##exporterWritePerformanceReport", 
+        &settings_.writePerformanceReport
+    );
+
     //--------------------------------------------------------------------------
 
     auto window = vir::Window::instance();
@@ -460,13 +1316,14 @@ transparency)");
         ImGuiTableFlags_BordersV | 
         ImGuiTableFlags_BordersOuterH |
         ImGuiTableFlags_SizingFixedFit;
-    if (ImGui::BeginTable("##exportResolutionTable", 3, flags))
+    if (ImGui::BeginTable("##exportResolutionTable", 4, flags))
     {
         // Declare columns
         static ImGuiTableColumnFlags flags = 0;
         ImGui::TableSetupColumn("Layer name", flags, 9.f*fontSize);
         ImGui::TableSetupColumn("Export resolution", flags, 9.25f*fontSize);
         ImGui::TableSetupColumn("Clear policy", flags, 9.5f*fontSize);
+        ImGui::TableSetupColumn("Export", flags, 3.f*fontSize);
         ImGui::TableHeadersRow();
 
         glm::ivec2& outputResolution = sharedUniforms.exportData().resolution;
@@ -681,6 +1538,29 @@ ICON_FA_LOCK_OPEN " - The layer resolution will not rescale\nwith the output "
                 }
                 ImGui::PopItemWidth();
             }
+
+            // Column 3 --------------------------------------------------------
+            ImGui::TableSetColumnIndex(col++);
+            if (!layerRendersToWindow)
+            {
+                ImGui::Checkbox
+                (
+                    "##layerExportFramebuffer", 
+                    &exportData.exportFramebuffer
+                );
+                if 
+                (
+                    ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) &&
+                    ImGui::BeginTooltip()
+                )
+                {
+                    ImGui::Text(
+R"(If checked, the layer framebuffer is also exported, from the same rendered
+frames, to its own file with the layer name appended to the output filename)"
+                    );
+                    ImGui::EndTooltip();
+                }
+            }
             
             ImGui::PopID();
 
@@ -721,6 +1601,11 @@ ICON_FA_LOCK_OPEN " - The layer resolution will not rescale\nwith the output "
             text.c_str()
         );
     }
+    if (isRunning_ || profiler_.nFrames() > 0)
+    {
+        ImGui::Separator();
+        profiler_.renderGui();
+    }
 }
 
 //----------------------------------------------------------------------------//
@@ -735,6 +1620,7 @@ void Exporter::exportButtonGui(bool disable)
         (
             isRunning_ ? 
             (
+                exportType_ == ExportType::GIF &&
                 settings_.gifPaletteMode == PaletteMode::StaticAveraged && 
                 !isAveragedPaletteReady_ ?
                 "Computing averaged palette..." :
@@ -747,6 +1633,19 @@ void Exporter::exportButtonGui(bool disable)
         std::vector<std::string> filters;
         if (exportType_ == ExportType::GIF)
             filters = {"Image files (*.gif)", "*.gif"};
+        else if (exportType_ == ExportType::VideoStream)
+        {
+            std::string extension = 
+                vir::RawVideoEncoder::formatToExtension
+                [
+                    settings_.videoStreamFormat
+                ];
+            filters = 
+            {
+                "Video files (*."+extension+")", 
+                "*."+extension
+            };
+        }
         else
             filters = {"Image files (*.png)", "*.png"};
         fileDialog_.runSaveFileDialog("Export graphics to file", filters);
@@ -771,7 +1670,16 @@ void Exporter::save(ObjectIO& io)
     io.write("gifPaletteMode", (int)settings_.gifPaletteMode);
     io.write("gifPaletteBitDepth", settings_.gifPaletteBitDepth);
     io.write("gifAlphaCutoff", settings_.gifAlphaCutoff);
+    io.write("gifDeltaEncoding", settings_.gifDeltaEncoding);
     io.write("gifDitherMode", (int)settings_.gifDitherMode);
+    io.write("gifQuantizerDevice", (int)settings_.gifQuantizerDevice);
+    io.write("gifMaxFramesInFlight", settings_.gifMaxFramesInFlight);
+    io.write("pngCompressionLevel", settings_.pngCompressionLevel);
+    io.write("pngMaxFramesInFlight", settings_.pngMaxFramesInFlight);
+    io.write("imageTileSize", settings_.imageTileSize);
+    io.write("videoStreamFormat", (int)settings_.videoStreamFormat);
+    io.write("videoStreamMaxFramesInFlight", settings_.videoStreamMaxFramesInFlight);
+    io.write("writePerformanceReport", settings_.writePerformanceReport);
     io.writeObjectEnd();
 }
 
@@ -804,7 +1712,16 @@ void Exporter::load(const ObjectIO& io, Exporter*& exporter)
     READ_SETTINGS_ITEM2(gifPaletteMode, int, PaletteMode)
     READ_SETTINGS_ITEM(gifPaletteBitDepth, int)
     READ_SETTINGS_ITEM(gifAlphaCutoff, int)
+    READ_SETTINGS_ITEM(gifDeltaEncoding, bool)
     READ_SETTINGS_ITEM2(gifDitherMode, int, DitherMode)
+    READ_SETTINGS_ITEM2(gifQuantizerDevice, int, QuantizerDevice)
+    READ_SETTINGS_ITEM(gifMaxFramesInFlight, int)
+    READ_SETTINGS_ITEM(pngCompressionLevel, int)
+    READ_SETTINGS_ITEM(pngMaxFramesInFlight, int)
+    READ_SETTINGS_ITEM(imageTileSize, int)
+    READ_SETTINGS_ITEM2(videoStreamFormat, int, VideoStreamFormat)
+    READ_SETTINGS_ITEM(videoStreamMaxFramesInFlight, int)
+    READ_SETTINGS_ITEM(writePerformanceReport, bool)
 
     exporter->settings_ = settings;
 }
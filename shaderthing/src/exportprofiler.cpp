@@ -0,0 +1,343 @@
+/*
+ _____________________
+|                     |  This file is part of ShaderThing - A GUI-based live
+|   ___  _________    |  shader editor by Stefan Radman (a.k.a., virmodoetiae).
+|  /\  \/\__    __\   |  For more information, visit:
+|  \ \  \/__/\  \_/   |
+|   \ \__   \ \  \    |  https://github.com/virmodoetiae/shaderthing
+|    \/__/\  \ \  \   |
+|        \ \__\ \__\  |  SPDX-FileCopyrightText:    2025 Stefan Radman
+|  Ↄ|C    \/__/\/__/  |                             sradman@protonmail.com
+|  Ↄ|C                |  SPDX-License-Identifier:   Zlib
+|_____________________|
+
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "shaderthing/include/exportprofiler.h"
+
+#include "shaderthing/include/helpers.h"
+#include "shaderthing/include/objectio.h"
+
+#include "thirdparty/imgui/imgui.h"
+
+namespace ShaderThing
+{
+
+std::map<ExportProfiler::Stage, const char*> ExportProfiler::stageToName =
+{
+    {Stage::RenderGPU, "Render (GPU)"},
+    {Stage::RenderCPU, "Render (CPU)"},
+    {Stage::Readback, "Readback"},
+    {Stage::Submission, "Encoder submission"},
+    {Stage::Quantization, "Quantization"},
+    {Stage::Encoding, "Encoding"},
+    {Stage::Writing, "Writing"},
+    {Stage::Frame, "Frame"}
+};
+
+std::map<ExportProfiler::Stage, const char*> ExportProfiler::stageToKey =
+{
+    {Stage::RenderGPU, "renderGpu"},
+    {Stage::RenderCPU, "renderCpu"},
+    {Stage::Readback, "readback"},
+    {Stage::Submission, "submission"},
+    {Stage::Quantization, "quantization"},
+    {Stage::Encoding, "encoding"},
+    {Stage::Writing, "writing"},
+    {Stage::Frame, "frame"}
+};
+
+//----------------------------------------------------------------------------//
+
+ExportProfiler::~ExportProfiler()
+{
+    for (auto& query : timerQueries_)
+    {
+        DELETE_IF_NOT_NULLPTR(query)
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+void ExportProfiler::start()
+{
+    // Timer queries are only created once, as they require a current context
+    if (timerQueries_.empty())
+    {
+        for (unsigned int i=0; i<nTimerQueries; i++)
+        {
+            auto query = vir::TimerQuery::create();
+            if (query == nullptr)
+                break;
+            timerQueries_.push_back(query);
+        }
+    }
+    // Discard results of queries left pending by a previous export
+    collectTimerQueries(true);
+    for (unsigned int i=0; i<nStages; i++)
+    {
+        samples_[i].clear();
+        statistics_[i] = {};
+    }
+    timerQueryIndex_ = 0;
+    activeTimerQuery_ = nullptr;
+    nBytesWritten_ = 0;
+    nFrames_ = 0;
+    duration_ = 0;
+    startTime_ = Clock::now();
+    lastFrameTime_ = startTime_;
+    statisticsTime_ = startTime_;
+    isRunning_ = true;
+}
+
+//----------------------------------------------------------------------------//
+
+void ExportProfiler::stop()
+{
+    if (!isRunning_)
+        return;
+    if (activeTimerQuery_ != nullptr)
+    {
+        activeTimerQuery_->end();
+        activeTimerQuery_ = nullptr;
+    }
+    collectTimerQueries(true);
+    duration_ = vir::EncoderStats::secondsSince(startTime_);
+    isRunning_ = false;
+    updateStatistics();
+}
+
+//----------------------------------------------------------------------------//
+
+void ExportProfiler::beginRender()
+{
+    if (!isRunning_)
+        return;
+    renderStartTime_ = Clock::now();
+    collectTimerQueries(false);
+    if (timerQueries_.empty())
+        return;
+    auto query = timerQueries_[timerQueryIndex_];
+    if (query->isPending())
+        return;
+    query->begin();
+    activeTimerQuery_ = query;
+    timerQueryIndex_ = (timerQueryIndex_+1) % timerQueries_.size();
+}
+
+//----------------------------------------------------------------------------//
+
+void ExportProfiler::endRender()
+{
+    if (!isRunning_)
+        return;
+    if (activeTimerQuery_ != nullptr)
+    {
+        activeTimerQuery_->end();
+        activeTimerQuery_ = nullptr;
+    }
+    record(Stage::RenderCPU, vir::EncoderStats::secondsSince(renderStartTime_));
+}
+
+//----------------------------------------------------------------------------//
+
+void ExportProfiler::record(Stage stage, double seconds)
+{
+    if (isRunning_)
+        samples_[(int)stage].push_back(seconds);
+}
+
+//----------------------------------------------------------------------------//
+
+void ExportProfiler::recordFrame()
+{
+    if (!isRunning_)
+        return;
+    auto now = Clock::now();
+    record
+    (
+        Stage::Frame,
+        std::chrono::duration<double>(now-lastFrameTime_).count()
+    );
+    lastFrameTime_ = now;
+    ++nFrames_;
+}
+
+//----------------------------------------------------------------------------//
+
+void ExportProfiler::collect(vir::EncoderStats& encoderStats)
+{
+    encoderSamples_.clear();
+    uint64_t nBytesWritten = encoderStats.takeSamples(encoderSamples_);
+    if (!isRunning_)
+        return;
+    nBytesWritten_ += nBytesWritten;
+    for (auto& sample : encoderSamples_)
+    {
+        Stage stage =
+            sample.stage == vir::EncoderStats::Stage::Quantization ?
+                Stage::Quantization :
+            sample.stage == vir::EncoderStats::Stage::Encoding ?
+                Stage::Encoding :
+                Stage::Writing;
+        record(stage, sample.seconds);
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+void ExportProfiler::collectTimerQueries(bool wait)
+{
+    for (auto query : timerQueries_)
+    {
+        uint64_t nanoseconds;
+        if (query->isPending() && query->result(nanoseconds, wait))
+            record(Stage::RenderGPU, 1e-9*nanoseconds);
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+void ExportProfiler::updateStatistics()
+{
+    std::vector<double> sorted;
+    for (unsigned int i=0; i<nStages; i++)
+    {
+        const auto& samples = samples_[i];
+        auto& statistics = statistics_[i];
+        statistics = {};
+        if (samples.empty())
+            continue;
+        sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        size_t n = sorted.size();
+        // Nearest-rank percentiles
+        auto percentile = [&](double p)
+        {
+            size_t rank = (size_t)std::ceil(p*n);
+            return sorted[std::min(std::max(rank, (size_t)1), n)-1];
+        };
+        statistics.nSamples = n;
+        for (auto sample : sorted)
+            statistics.total += sample;
+        statistics.mean = statistics.total/n;
+        statistics.p50 = percentile(.50);
+        statistics.p95 = percentile(.95);
+        statistics.p99 = percentile(.99);
+    }
+    statisticsTime_ = Clock::now();
+}
+
+//----------------------------------------------------------------------------//
+
+double ExportProfiler::duration() const
+{
+    return isRunning_ ? vir::EncoderStats::secondsSince(startTime_) : duration_;
+}
+
+//----------------------------------------------------------------------------//
+
+double ExportProfiler::framesPerSecond() const
+{
+    double seconds = duration();
+    return seconds > 0 ? nFrames_/seconds : 0;
+}
+
+//----------------------------------------------------------------------------//
+
+void ExportProfiler::renderGui()
+{
+    if (isRunning_ && vir::EncoderStats::secondsSince(statisticsTime_) > .5)
+        updateStatistics();
+    ImGuiTableFlags flags =
+        ImGuiTableFlags_BordersV |
+        ImGuiTableFlags_BordersOuterH |
+        ImGuiTableFlags_SizingFixedFit;
+    float fontSize = ImGui::GetFontSize();
+    if (ImGui::BeginTable("##exportProfilerTable", 5, flags))
+    {
+        static ImGuiTableColumnFlags flags = 0;
+        ImGui::TableSetupColumn("Stage [ms]", flags, 9.f*fontSize);
+        ImGui::TableSetupColumn("Mean", flags, 4.5f*fontSize);
+        ImGui::TableSetupColumn("p50", flags, 4.5f*fontSize);
+        ImGui::TableSetupColumn("p95", flags, 4.5f*fontSize);
+        ImGui::TableSetupColumn("p99", flags, 4.5f*fontSize);
+        ImGui::TableHeadersRow();
+        for (unsigned int i=0; i<nStages; i++)
+        {
+            const auto& statistics = statistics_[i];
+            if (statistics.nSamples == 0)
+                continue;
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%s", stageToName[(Stage)i]);
+            double values[4] =
+            {
+                statistics.mean,
+                statistics.p50,
+                statistics.p95,
+                statistics.p99
+            };
+            for (int j=0; j<4; j++)
+            {
+                ImGui::TableSetColumnIndex(j+1);
+                ImGui::Text("%.2f", 1e3*values[j]);
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::Text
+    (
+        "%u frames | %.2f fps | %.2f MB written | %.1f s",
+        nFrames_,
+        framesPerSecond(),
+        nBytesWritten_/1048576.,
+        duration()
+    );
+}
+
+//----------------------------------------------------------------------------//
+
+bool ExportProfiler::writeReport
+(
+    const std::string& filepath,
+    const std::string& outputFilepath,
+    glm::ivec2 outputResolution
+)
+{
+    if (isRunning_)
+        updateStatistics();
+    ObjectIO io(filepath.c_str(), ObjectIO::Mode::Write);
+    if (!io.isValid())
+        return false;
+    io.writeObjectStart("exportProfile");
+    io.write("outputFilepath", outputFilepath);
+    io.write("outputResolution", outputResolution);
+    io.write("nFrames", nFrames_);
+    io.write("durationSeconds", duration());
+    io.write("framesPerSecond", framesPerSecond());
+    io.write("bytesWritten", (double)nBytesWritten_);
+    io.writeObjectStart("stages");
+    for (unsigned int i=0; i<nStages; i++)
+    {
+        const auto& statistics = statistics_[i];
+        if (statistics.nSamples == 0)
+            continue;
+        io.writeObjectStart(stageToKey[(Stage)i]);
+        io.write("nSamples", statistics.nSamples);
+        io.write("totalSeconds", statistics.total);
+        io.write("meanMs", 1e3*statistics.mean);
+        io.write("p50Ms", 1e3*statistics.p50);
+        io.write("p95Ms", 1e3*statistics.p95);
+        io.write("p99Ms", 1e3*statistics.p99);
+        io.writeObjectEnd();
+    }
+    io.writeObjectEnd();
+    io.writeObjectEnd();
+    return io.writeContentsToDisk();
+}
+
+}
@@ -16,7 +16,9 @@
 #include <algorithm>
 #include <cctype>
 #include <charconv>
+#include <cstdlib>
 #include <ctime>
+#include <filesystem>
 
 #include "shaderthing/include/helpers.h"
 
@@ -69,6 +71,71 @@ unsigned int countNewLines(const std::string& text)
     return result;
 }
 
+bool containsIdentifier(const std::string& text, const std::string& identifier)
+{
+    auto isIdentifierChar = [](char c)
+    {
+        return std::isalnum((unsigned char)c) || c == '_';
+    };
+    size_t position = text.find(identifier);
+    while (position != std::string::npos)
+    {
+        size_t end = position+identifier.size();
+        if
+        (
+            (position == 0 || !isIdentifierChar(text[position-1])) &&
+            (end == text.size() || !isIdentifierChar(text[end]))
+        )
+            return true;
+        position = text.find(identifier, end);
+    }
+    return false;
+}
+
+std::string replaceIdentifier
+(
+    const std::string& text, 
+    const std::string& identifier,
+    const std::string& replacement,
+    const std::string& declarationType
+)
+{
+    auto isIdentifierChar = [](char c)
+    {
+        return std::isalnum((unsigned char)c) || c == '_';
+    };
+    std::string result;
+    size_t copied = 0;
+    size_t position = text.find(identifier);
+    while (position != std::string::npos)
+    {
+        size_t end = position+identifier.size();
+        bool isWholeWord = 
+            (position == 0 || !isIdentifierChar(text[position-1])) &&
+            (end == text.size() || !isIdentifierChar(text[end]));
+        if (isWholeWord && !declarationType.empty())
+        {
+            size_t typeEnd = position;
+            while (typeEnd > 0 && std::isspace((unsigned char)text[typeEnd-1]))
+                --typeEnd;
+            size_t typeStart = typeEnd;
+            while (typeStart > 0 && isIdentifierChar(text[typeStart-1]))
+                --typeStart;
+            isWholeWord = 
+                text.compare(typeStart, typeEnd-typeStart, declarationType) != 0;
+        }
+        if (isWholeWord)
+        {
+            result.append(text, copied, position-copied);
+            result += replacement;
+            copied = end;
+        }
+        position = text.find(identifier, end);
+    }
+    result.append(text, copied, std::string::npos);
+    return result;
+}
+
 std::string fileExtension(const std::string& filepath, bool toLowerCase)
 {
     std::string fileExtension = "";
@@ -162,6 +229,34 @@ std::string randomString(const unsigned int size)
     return tmp;
 }
 
+std::string userCacheDirectory(const std::string& subdirectory)
+{
+    auto environmentPath = [](const char* name)
+    {
+        const char* value = std::getenv(name);
+        return std::filesystem::path(value != nullptr ? value : "");
+    };
+    std::filesystem::path path;
+#if defined(_WIN32)
+    path = environmentPath("LOCALAPPDATA");
+    if (!path.empty())
+        path /= "ShaderThing";
+#elif defined(__APPLE__)
+    path = environmentPath("HOME");
+    if (!path.empty())
+        path = path/"Library"/"Caches"/"ShaderThing";
+#else
+    path = environmentPath("XDG_CACHE_HOME");
+    if (path.empty() && !environmentPath("HOME").empty())
+        path = environmentPath("HOME")/".cache";
+    if (!path.empty())
+        path /= "shaderthing";
+#endif
+    if (path.empty())
+        return "";
+    return (path/subdirectory).string();
+}
+
 unsigned char* readFileContents
 (
     const std::string& filepath,
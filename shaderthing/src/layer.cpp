@@ -15,13 +15,18 @@
 
 #include "shaderthing/include/layer.h"
 
+#include "shaderthing/include/adaptivetiling.h"
+#include "shaderthing/include/compilestatistics.h"
 #include "shaderthing/include/helpers.h"
+#include "shaderthing/include/layergraph.h"
 #include "shaderthing/include/macros.h"
 #include "shaderthing/include/objectio.h"
 #include "shaderthing/include/postprocess.h"
+#include "shaderthing/include/renderprofiler.h"
 #include "shaderthing/include/resource.h"
 #include "shaderthing/include/sharedstorage.h"
 #include "shaderthing/include/shareduniforms.h"
+#include "shaderthing/include/statusbar.h"
 #include "shaderthing/include/uniform.h"
 
 #include "vir/include/vir.h"
@@ -39,6 +44,13 @@ bool         Layer::Rendering::TileController::tiledRenderingEnabled = false;
 unsigned int Layer::Rendering::TileController::tileIndex             = 0;
 unsigned int Layer::Rendering::TileController::nTiles                = 1;
 unsigned int Layer::Rendering::TileController::nTilesCache           = 1;
+bool         Layer::Rendering::ResolutionController::dynamicResolutionEnabled
+                                                                     = false;
+float        Layer::Rendering::ResolutionController::targetFps       = 30.f;
+float        Layer::Rendering::ResolutionController::minScale        = .25f;
+float        Layer::Rendering::ResolutionController::scale           = 1.f;
+float        Layer::Rendering::ResolutionController::smoothFrameTime = 0.f;
+float        Layer::Rendering::ResolutionController::timeSinceUpdate = 0.f;
 std::string  Layer::GUI::defaultSharedSource = 
 R"(// Common source code is shared by all fragment shaders across all layers and
 // has access to all shared in/out/uniform declarations
@@ -145,10 +157,24 @@ TextEditor Layer::GUI::sharedSourceEditor =
 // Shader for mapping the contents of a framebuffer to another one, potentially
 // at a different resolution and/or internal format
 std::unique_ptr<vir::Shader> Layer::Rendering::textureMapperShader = nullptr;
+std::unique_ptr<vir::Shader> Layer::Rendering::interleaveShader    = nullptr;
 
 // Shared storage buffer for all layers
 std::unique_ptr<SharedStorage> Layer::Rendering::sharedStorage     = nullptr;
 
+// Dependency graph of all layers, rebuilt before each render
+std::unique_ptr<LayerGraph> Layer::Rendering::graph                = nullptr;
+
+// GPU timing of each layer and post-processing effect
+std::unique_ptr<RenderProfiler> Layer::Rendering::profiler         = nullptr;
+
+// Automatic selection of the number of rendering tiles
+std::unique_ptr<AdaptiveTiling> Layer::Rendering::adaptiveTiling   = nullptr;
+
+// Statistics of the most recent shader compilation of each layer
+std::unique_ptr<CompileStatistics> Layer::Rendering::compileStatistics = 
+    nullptr;
+
 //----------------------------------------------------------------------------//
 
 Layer::Layer
@@ -223,6 +249,14 @@ R"(void main()
     // Initialize shared storage - needs to be done before shader compilation
     if (Rendering::sharedStorage == nullptr)
         Rendering::sharedStorage = std::make_unique<SharedStorage>();
+    if (Rendering::graph == nullptr)
+        Rendering::graph = std::make_unique<LayerGraph>();
+    if (Rendering::profiler == nullptr)
+        Rendering::profiler = std::make_unique<RenderProfiler>();
+    if (Rendering::adaptiveTiling == nullptr)
+        Rendering::adaptiveTiling = std::make_unique<AdaptiveTiling>();
+    if (Rendering::compileStatistics == nullptr)
+        Rendering::compileStatistics = std::make_unique<CompileStatistics>();
 
     // Compile shader
     if (compileShader)
@@ -234,7 +268,35 @@ R"(void main()
     // Register with event broadcaster
     this->tuneIntoEventBroadcaster(VIR_DEFAULT_PRIORITY+id_);
 
-    // Initialize std::unique_ptrs to manage static shaders
+    // Initialize std::unique_ptrs to manage static shaders. The interleave
+    // shader composes the pixels shaded by an interleaved render (at reduced
+    // resolution) with those of the previous frame
+    if (Layer::Rendering::interleaveShader == nullptr)
+    {
+        Layer::Rendering::interleaveShader = std::unique_ptr<vir::Shader>
+        (
+            vir::Shader::create
+            (
+                vertexShaderSource(sharedUniforms),
+                glslDirectives()+
+R"(out     vec4      fragColor;
+in      vec2      qc;
+in      vec2      tc;
+uniform sampler2D previous;
+uniform sampler2D shaded;
+uniform ivec3     interleave; // Stride, offset.x, offset.y
+void main(){
+    ivec2 p = ivec2(gl_FragCoord.xy);
+    ivec2 q = p-interleave.yz;
+    if (q.x >= 0 && q.y >= 0 && q.x%interleave.x == 0 && q.y%interleave.x == 0)
+        fragColor = texelFetch(shaded, q/interleave.x, 0);
+    else
+        fragColor = texelFetch(previous, p, 0);})",
+                vir::Shader::ConstructFrom::SourceCode
+            )
+        );
+        sharedUniforms.bindShader(Layer::Rendering::interleaveShader.get());
+    }
     if (Layer::Rendering::textureMapperShader != nullptr)
         return;
     Layer::Rendering::textureMapperShader = std::unique_ptr<vir::Shader>
@@ -258,10 +320,14 @@ void main(){fragColor = texture(tx, tc);})",
 
 Layer::~Layer()
 {
+    Rendering::profiler->forget(this);
+    Rendering::compileStatistics->forget(this);
     DELETE_IF_NOT_NULLPTR(rendering_.framebufferA)
     DELETE_IF_NOT_NULLPTR(rendering_.framebufferB)
     DELETE_IF_NOT_NULLPTR(rendering_.shader)
     DELETE_IF_NOT_NULLPTR(rendering_.quad)
+    DELETE_IF_NOT_NULLPTR(rendering_.interleave.framebuffer)
+    DELETE_IF_NOT_NULLPTR(rendering_.pendingCompilation.shader)
     for (auto postProcess : rendering_.postProcesses)
     {
         DELETE_IF_NOT_NULLPTR(postProcess)
@@ -278,6 +344,8 @@ void Layer::save(ObjectIO& io) const
     io.write("resolutionRatio", resolutionRatio_);
     io.write("isAspectRatioBoundToWindow", flags_.isAspectRatioBoundToWindow);
     io.write("rescaleWithWindow", flags_.rescaleWithWindow);
+    io.write("cacheOutput", rendering_.outputCache.isEnabled);
+    io.write("interleaveStride", rendering_.interleave.stride);
     io.write("depth", depth_);
 
     io.writeObjectStart("internalFramebuffer");
@@ -309,6 +377,7 @@ void Layer::save(ObjectIO& io) const
     io.write("resolutionScale", exportData_.resolutionScale);
     io.write("rescaleWithOutput", exportData_.rescaleWithOutput);
     io.write("windowResolutionScale", exportData_.windowResolutionScale);
+    io.write("exportFramebuffer", exportData_.exportFramebuffer);
     io.writeObjectEnd(); // End of exportData
 
     io.writeObjectStart("shader");
@@ -348,6 +417,27 @@ void Layer::saveAll(const std::vector<Layer*>& layers, ObjectIO& io)
         io.write("graphicsExtensions", enabledExtensions);
     if (Layer::Rendering::TileController::tiledRenderingEnabled)
         io.write("nRenderingTiles", Layer::Rendering::TileController::nTiles);
+    if (Layer::Rendering::adaptiveTiling->isEnabled())
+    {
+        io.writeObjectStart("adaptiveTiling");
+        io.write("budgetMs", Layer::Rendering::adaptiveTiling->budgetMs());
+        io.writeObjectEnd();
+    }
+    if (Layer::Rendering::ResolutionController::dynamicResolutionEnabled)
+    {
+        io.writeObjectStart("dynamicResolution");
+        io.write
+        (
+            "targetFps", 
+            Layer::Rendering::ResolutionController::targetFps
+        );
+        io.write
+        (
+            "minScale", 
+            Layer::Rendering::ResolutionController::minScale
+        );
+        io.writeObjectEnd();
+    }
     if (Layer::GUI::defaultSharedSource != sharedSource)
         io.write
         (
@@ -384,6 +474,14 @@ Layer* Layer::load
     layer->resolutionRatio_ = io.read<glm::vec2>("resolutionRatio");
     layer->flags_.rescaleWithWindow = 
         io.readOrDefault<bool>("rescaleWithWindow", true);
+    layer->rendering_.outputCache.isEnabled = 
+        io.readOrDefault<bool>("cacheOutput", true);
+    layer->rendering_.interleave.stride = std::clamp
+    (
+        io.readOrDefault<unsigned int>("interleaveStride", 1),
+        1u,
+        4u
+    );
     
     layer->setDepth(io.read<float>("depth"));
 
@@ -394,6 +492,8 @@ Layer* Layer::load
         exportData.read<bool>("rescaleWithOutput");
     layer->exportData_.windowResolutionScale = 
         exportData.read<float>("windowResolutionScale");
+    layer->exportData_.exportFramebuffer = 
+        exportData.readOrDefault<bool>("exportFramebuffer", false);
     layer->exportData_.resolution =
         (glm::vec2)layer->resolution_ * 
         layer->exportData_.resolutionScale *
@@ -574,6 +674,32 @@ void Layer::loadAll
     // Finally, reset tiled rendering
     unsigned int nTiles = io.readOrDefault<unsigned int>("nRenderingTiles", 1);
     Layer::setRenderingTiles(layers, nTiles);
+    Layer::Rendering::adaptiveTiling->setEnabled
+    (
+        io.hasMember("adaptiveTiling")
+    );
+    if (Layer::Rendering::adaptiveTiling->isEnabled())
+        Layer::Rendering::adaptiveTiling->setBudgetMs
+        (
+            io.readObject("adaptiveTiling").readOrDefault<float>
+            (
+                "budgetMs", 
+                30.f
+            )
+        );
+
+    // And dynamic resolution scaling
+    Layer::Rendering::ResolutionController::dynamicResolutionEnabled = 
+        io.hasMember("dynamicResolution");
+    Layer::Rendering::ResolutionController::scale = 1.f;
+    if (Layer::Rendering::ResolutionController::dynamicResolutionEnabled)
+    {
+        auto dynamicResolution = io.readObject("dynamicResolution");
+        Layer::Rendering::ResolutionController::targetFps = 
+            dynamicResolution.readOrDefault<float>("targetFps", 30.f);
+        Layer::Rendering::ResolutionController::minScale = 
+            dynamicResolution.readOrDefault<float>("minScale", .25f);
+    }
 }
 
 //----------------------------------------------------------------------------//
@@ -623,9 +749,12 @@ layout (location=1) in vec2 itc;
 out vec2 qc;
 out vec2 tc;
 )" + sharedUniforms.glslVertexBlockSource() +
-R"(
+R"(uniform vec4 iInterleaveTransform = vec4(1., 1., 0., 0.);
 void main(){
     gl_Position = iMVP*vec4(iqc, 1.);
+    gl_Position.xy = 
+        gl_Position.xy*iInterleaveTransform.xy+
+        iInterleaveTransform.zw*gl_Position.w;
     qc = iqc.xy;
     tc = itc;})"
     );
@@ -646,6 +775,10 @@ Layer::fragmentShaderHeaderSourceAndLineCount
         "in      vec2   qc;\nin      vec2   tc;\nout     vec4   fragColor;\n" +
         Rendering::sharedStorage->glslBlockSource() +
         sharedUniforms.glslFragmentBlockSource() +
+        // Maps the pixels of an interleaved render to those they stand for
+        "uniform vec3 iInterleave = vec3(1., 0., 0.);\n#undef stFragCoord\n"
+        "#define stFragCoord vec4((gl_FragCoord.xy-.5)*iInterleave.x+"
+        "iInterleave.yz+.5+iFragCoordOffset, gl_FragCoord.zw)\n"
         "\n"
     );
     unsigned int nLines = Helpers::countNewLines(header);
@@ -945,6 +1078,7 @@ void Layer::rebuildFramebuffers
             Layer::Rendering::TileController::tiledRenderingEnabled ?
             rendering_.frontFramebuffer :
             rendering_.backFramebuffer;
+    invalidateOutputCache();
 }
 
 //----------------------------------------------------------------------------//
@@ -953,6 +1087,272 @@ void Layer::clearFramebuffers()
 {
     rendering_.framebufferA->clearColorBuffer();
     rendering_.framebufferB->clearColorBuffer();
+    invalidateOutputCache();
+}
+
+//----------------------------------------------------------------------------//
+
+void Layer::setRenderScale(float scale)
+{
+    glm::ivec2 resolution = glm::max
+    (
+        scale < 1.f ? 
+        glm::ivec2((glm::vec2)resolution_*scale+.5f) : 
+        resolution_, 
+        {1,1}
+    );
+    rendering_.isRenderScaled = scale < 1.f;
+    auto framebuffer = rendering_.backFramebuffer;
+    if 
+    (
+        framebuffer == nullptr ||
+        (
+            (int)framebuffer->width() == resolution.x && 
+            (int)framebuffer->height() == resolution.y
+        )
+    )
+        return;
+    // Contents are preserved on resizing, hence the scale can change without
+    // visible artifacts
+    rebuildFramebuffers(framebuffer->colorBufferInternalFormat(), resolution);
+    if (rendering_.shader == nullptr)
+        return;
+    rendering_.shader->bind();
+    rendering_.shader->setUniformFloat2("iResolution", (glm::vec2)resolution);
+}
+
+//----------------------------------------------------------------------------//
+
+void Layer::updateRenderScale(float frameTime) // Static
+{
+    typedef Layer::Rendering::ResolutionController Controller;
+    Controller::smoothFrameTime = 
+        Controller::smoothFrameTime > 0.f ?
+        .9f*Controller::smoothFrameTime + .1f*frameTime :
+        frameTime;
+    Controller::timeSinceUpdate += frameTime;
+    if (Controller::timeSinceUpdate < .25f || Controller::smoothFrameTime <= 0)
+        return;
+    Controller::timeSinceUpdate = 0.f;
+    // The render time scales roughly with the number of pixels, i.e., with the
+    // square of the resolution scale. Within the dead band, the scale is left
+    // as is to avoid oscillations
+    float ratio = 
+        1.f/(std::max(Controller::targetFps, 1.f)*Controller::smoothFrameTime);
+    float scale = Controller::scale;
+    if (ratio < .95f)
+        scale *= std::max(std::sqrt(ratio), .75f);
+    else if (ratio > 1.25f)
+        scale *= std::min(std::sqrt(ratio), 1.1f);
+    else
+        return;
+    // Quantized to limit the number of framebuffer rebuilds
+    scale = std::round(scale*32.f)/32.f;
+    Controller::scale = glm::clamp(scale, Controller::minScale, 1.f);
+}
+
+//----------------------------------------------------------------------------//
+
+void Layer::renderInterleaved()
+{
+    static auto renderer = vir::Renderer::instance();
+    auto& interleave = rendering_.interleave;
+    int stride = interleave.stride;
+    glm::ivec2 resolution = glm::max((resolution_+stride-1)/stride, {1,1});
+    auto format = rendering_.backFramebuffer->colorBufferInternalFormat();
+    if 
+    (
+        interleave.framebuffer == nullptr ||
+        (int)interleave.framebuffer->width() != resolution.x ||
+        (int)interleave.framebuffer->height() != resolution.y ||
+        interleave.framebuffer->colorBufferInternalFormat() != format
+    )
+    {
+        DELETE_IF_NOT_NULLPTR(interleave.framebuffer)
+        interleave.framebuffer = 
+            vir::Framebuffer::create(resolution.x, resolution.y, format);
+    }
+
+    // Cycle through all pixels of each block, diagonally, so that 
+    // consecutive frames shade pixels far from each other
+    unsigned int k = (interleave.index++)%(stride*stride);
+    glm::ivec2 offset(k%stride, (k/stride+k%stride)%stride);
+
+    // Shade the subset of pixels at reduced resolution, with the quad scaled
+    // and shifted so that the center of each reduced pixel maps onto that of
+    // the shaded pixel it stands for
+    glm::vec2 scale = 
+        (glm::vec2)resolution_/(float(stride)*(glm::vec2)resolution);
+    glm::vec2 center = .5f-((glm::vec2)offset+.5f)/float(stride);
+    glm::vec2 shift = scale-1.f+2.f*center/(glm::vec2)resolution;
+    rendering_.shader->setUniformFloat4
+    (
+        "iInterleaveTransform", 
+        {scale.x, scale.y, shift.x, shift.y}
+    );
+    rendering_.shader->setUniformFloat3
+    (
+        "iInterleave", 
+        {float(stride), float(offset.x), float(offset.y)}
+    );
+    renderer->submit
+    (
+        *rendering_.quad, 
+        rendering_.shader, 
+        interleave.framebuffer, 
+        true
+    );
+    rendering_.shader->setUniformFloat4("iInterleaveTransform", {1, 1, 0, 0});
+    rendering_.shader->setUniformFloat3("iInterleave", {1, 0, 0});
+
+    // Compose the shaded pixels with the previous frame
+    auto shader = Layer::Rendering::interleaveShader.get();
+    shader->bind();
+    rendering_.frontFramebuffer->bindColorBuffer(0);
+    interleave.framebuffer->bindColorBuffer(1);
+    shader->setUniformInt("previous", 0);
+    shader->setUniformInt("shaded", 1);
+    shader->setUniformInt3("interleave", {stride, offset.x, offset.y});
+    renderer->submit
+    (
+        *rendering_.quad, 
+        shader, 
+        rendering_.backFramebuffer, 
+        false
+    );
+}
+
+//----------------------------------------------------------------------------//
+
+void Layer::invalidateOutputCache()
+{
+    rendering_.outputCache.isValid = false;
+    rendering_.outputCache.isHit = false;
+    ++rendering_.outputCache.contentVersion;
+}
+
+//----------------------------------------------------------------------------//
+
+bool Layer::outputInputsHash
+(
+    const SharedUniforms& sharedUniforms,
+    uint64_t& hash
+) const
+{
+    const auto& cache = rendering_.outputCache;
+    if 
+    (
+        !cache.isEnabled ||
+        !cache.isTimeInvariant ||
+        rendering_.usesSharedStorage ||
+        rendering_.target == Rendering::Target::Window ||
+        rendering_.interleave.stride > 1 ||
+        Rendering::TileController::tiledRenderingEnabled
+    )
+        return false;
+    for (auto postProcess : rendering_.postProcesses)
+    {
+        if (postProcess->isActive())
+            return false;
+    }
+
+    hash = vir::Helpers::fnv1aOffsetBasis;
+    auto combine = [&hash](const void* data, size_t size)
+    {
+        hash = vir::Helpers::hashFnv1a(data, size, hash);
+    };
+    auto target = rendering_.target;
+    auto windowResolution = sharedUniforms.iResolution();
+    auto fragCoordOffset = sharedUniforms.iFragCoordOffset();
+    bool isExporting = sharedUniforms.iExport();
+    combine(&target, sizeof(target));
+    combine(&windowResolution, sizeof(windowResolution));
+    combine(&fragCoordOffset, sizeof(fragCoordOffset));
+    combine(&isExporting, sizeof(isExporting));
+
+    auto combineUniforms = [&](const std::vector<Uniform*>& uniforms)
+    {
+        for (auto u : uniforms)
+        {
+            if (u->specialType != Uniform::SpecialType::None)
+                continue;
+            size_t size = 0;
+            switch (u->type)
+            {
+                case Uniform::Type::Bool :
+                    size = sizeof(bool);
+                    break;
+                case Uniform::Type::UInt :
+                case Uniform::Type::Int :
+                case Uniform::Type::Float :
+                    size = 4;
+                    break;
+                case Uniform::Type::Int2 :
+                case Uniform::Type::Float2 :
+                    size = 8;
+                    break;
+                case Uniform::Type::Int3 :
+                case Uniform::Type::Float3 :
+                    size = 12;
+                    break;
+                case Uniform::Type::Int4 :
+                case Uniform::Type::Float4 :
+                    size = 16;
+                    break;
+                case Uniform::Type::Mat3 :
+                    size = 36;
+                    break;
+                case Uniform::Type::Mat4 :
+                    size = 64;
+                    break;
+                // Images may be written to, hence they are a side effect
+                case Uniform::Type::Image2D :
+                case Uniform::Type::Image3D :
+                case Uniform::Type::ImageCube :
+                    return false;
+                default :
+                    break;
+            }
+            if (size > 0)
+            {
+                auto value = u->getValuePtr<const void>();
+                if (value != nullptr)
+                    combine(value, size);
+                continue;
+            }
+            auto resource = u->getValuePtr<const Resource>();
+            combine(&resource, sizeof(resource));
+            if (resource == nullptr)
+                continue;
+            if (resource->type() == Resource::Type::AnimatedTexture2D)
+                return false;
+            uint64_t version = resource->id();
+            if (resource->type() == Resource::Type::Framebuffer)
+            {
+                auto layer = static_cast<const LayerResource*>(resource)->layer();
+                // Sampling one's own previous frame is a feedback loop
+                if (layer == this)
+                    return false;
+                version = layer->rendering_.outputCache.contentVersion;
+            }
+            int modes[4] = 
+            {
+                (int)resource->wrapMode(0),
+                (int)resource->wrapMode(1),
+                (int)resource->magFilterMode(),
+                (int)resource->minFilterMode()
+            };
+            // Textures may also be written to as images by other layers
+            uint64_t contentVersion = resource->contentVersion();
+            combine(&version, sizeof(version));
+            combine(&contentVersion, sizeof(contentVersion));
+            combine(modes, sizeof(modes));
+        }
+        return true;
+    };
+    return 
+        combineUniforms(uniforms_) && 
+        combineUniforms(sharedUniforms.userUniforms());
 }
 
 //----------------------------------------------------------------------------//
@@ -960,7 +1360,8 @@ void Layer::clearFramebuffers()
 bool Layer::compileShader
 (
     const SharedUniforms& sharedUniforms,
-    bool setBlankShaderOnError
+    bool setBlankShaderOnError,
+    bool async
 )
 {
     auto headerAndLineCount = 
@@ -968,34 +1369,144 @@ bool Layer::compileShader
     gui_.sourceHeader = std::get<std::string>(headerAndLineCount);
     unsigned int nHeaderLines = std::get<unsigned int>(headerAndLineCount);
     unsigned int nSharedLines = GUI::sharedSourceEditor.getTotalLines()+1;
-    auto shader = vir::Shader::create
+    std::string source = 
+        gui_.sharedSourceEditor.getText()+"\n"+
+        gui_.sourceEditor.getText();
+    std::string vertexSource = vertexShaderSource(sharedUniforms);
+
+    // Skip the compilation if the assembled sources are identical to those of
+    // the current shader, which is only the case if it compiled successfully
+    uint64_t sourceHash = vir::Helpers::hashFnv1a(vertexSource);
+    sourceHash = vir::Helpers::hashFnv1a(gui_.sourceHeader, sourceHash);
+    sourceHash = vir::Helpers::hashFnv1a(source, sourceHash);
+    auto& pending = rendering_.pendingCompilation;
+    rendering_.isSourceUnchanged = 
+        sourceHash == rendering_.sourceHash && 
+        pending.shader == nullptr;
+    if (rendering_.isSourceUnchanged)
+    {
+        clearUncompiledChanges();
+        return true;
+    }
+
+    DELETE_IF_NOT_NULLPTR(pending.shader)
+    // Uses of gl_FragCoord (but not its re-declarations) are offset to the
+    // coordinates of the full-resolution render by the stFragCoord macro of
+    // the header, as the built-in itself cannot be re-defined
+    pending.shader = vir::Shader::create
     (
-        vertexShaderSource(sharedUniforms),
+        vertexSource,
+        gui_.sourceHeader + 
+        Helpers::replaceIdentifier
         (
-            gui_.sourceHeader +
-            gui_.sharedSourceEditor.getText()+"\n"+
-            gui_.sourceEditor.getText()
+            source, 
+            "gl_FragCoord", 
+            "stFragCoord", 
+            "vec4"
         ),
-        vir::Shader::ConstructFrom::SourceCode
+        vir::Shader::ConstructFrom::SourceCode,
+        async
+    );
+    pending.sourceHash = sourceHash;
+    pending.source = source;
+    pending.nHeaderLines = nHeaderLines;
+    pending.nSharedLines = nSharedLines;
+    pending.setBlankShaderOnError = setBlankShaderOnError;
+    if (async && pending.shader->isCompiling())
+        return true;
+    return finishShaderCompilation(sharedUniforms);
+}
+
+//----------------------------------------------------------------------------//
+
+void Layer::clearUncompiledChanges()
+{
+    cache_.uncompiledUniforms.erase
+    (
+        std::remove_if
+        (
+            cache_.uncompiledUniforms.begin(),
+            cache_.uncompiledUniforms.end(),
+            [](Uniform* u){return u->name.size()>0;}
+        ),
+        cache_.uncompiledUniforms.end()
+    );
+    flags_.uncompiledChanges = false;
+}
+
+//----------------------------------------------------------------------------//
+
+void Layer::pollShaderCompilation(const SharedUniforms& sharedUniforms)
+{
+    auto shader = rendering_.pendingCompilation.shader;
+    if (shader != nullptr && !shader->isCompiling())
+        finishShaderCompilation(sharedUniforms);
+}
+
+//----------------------------------------------------------------------------//
+
+bool Layer::finishShaderCompilation(const SharedUniforms& sharedUniforms)
+{
+    auto& pending = rendering_.pendingCompilation;
+    auto shader = pending.shader;
+    const std::string& source = pending.source;
+    unsigned int nHeaderLines = pending.nHeaderLines;
+    unsigned int nSharedLines = pending.nSharedLines;
+    pending.shader = nullptr;
+    rendering_.sourceHash = 0;
+    Rendering::compileStatistics->record
+    (
+        this, 
+        gui_.name, 
+        *shader, 
+        nHeaderLines
     );
     if (shader->valid())
     {
         delete rendering_.shader;
         rendering_.shader = shader;
+        rendering_.sourceHash = pending.sourceHash;
+        // Conservatively, any mention of the shared storage data counts as 
+        // an access
+        rendering_.usesSharedStorage = 
+            source.find("ssiData") != std::string::npos ||
+            source.find("ssfData") != std::string::npos;
+        // Likewise, any mention of a shared uniform that changes over time or
+        // with user input makes the layer output time-dependent
+        rendering_.outputCache.isTimeInvariant = true;
+        for 
+        (
+            auto name : 
+            {
+                "iFrame", "iRenderPass", "iTime", "iTimeDelta", "iRandom", 
+                "iUserAction", "iWASD", "iLook", "iMouse", "iKeyboard"
+            }
+        )
+        {
+            if (Helpers::containsIdentifier(source, name))
+            {
+                rendering_.outputCache.isTimeInvariant = false;
+                break;
+            }
+        }
+        invalidateOutputCache();
         gui_.headerErrors.clear();
         gui_.sourceEditor.setErrorMarkers({});
         gui_.sharedSourceEditor.setErrorMarkers({});
-        cache_.uncompiledUniforms.erase
+        // Edits made while the shader was compiling in the background are not
+        // part of it, hence they are still to be compiled
+        std::string currentSource = 
+            gui_.sharedSourceEditor.getText()+"\n"+
+            gui_.sourceEditor.getText();
+        if 
         (
-            std::remove_if
+            currentSource == source &&
+            std::get<std::string>
             (
-                cache_.uncompiledUniforms.begin(),
-                cache_.uncompiledUniforms.end(),
-                [](Uniform* u){return u->name.size()>0;}
-            ),
-            cache_.uncompiledUniforms.end()
-        );
-        flags_.uncompiledChanges = false;
+                fragmentShaderHeaderSourceAndLineCount(sharedUniforms)
+            ) == gui_.sourceHeader
+        )
+            clearUncompiledChanges();
         // Re-set uniforms
         sharedUniforms.bindShader(rendering_.shader);
         Rendering::sharedStorage->bindShader(rendering_.shader);
@@ -1083,7 +1594,7 @@ bool Layer::compileShader
     setEditorErrors(gui_.sourceEditor, sourceErrors);
     setEditorErrors(gui_.sharedSourceEditor, sharedErrors);
     delete shader;
-    if (setBlankShaderOnError)
+    if (pending.setBlankShaderOnError)
     {
         // Initialize the shader with a blank shader source if any compilation
         // errors are detected (back-end-only, the user will still see the 
@@ -1131,6 +1642,22 @@ void Layer::renderShader
             rendering_.backFramebuffer;
     };
 
+    // Re-use the framebuffer contents if no input has changed since the last
+    // render, in which case the buffers are not flipped either
+    auto& cache = rendering_.outputCache;
+    uint64_t inputsHash = 0;
+    bool isCacheable = outputInputsHash(sharedUniforms, inputsHash);
+    cache.isHit = isCacheable && cache.isValid && inputsHash == cache.inputsHash;
+    if (cache.isHit)
+    {
+        if (rendering_.target == Rendering::Target::InternalFramebufferAndWindow)
+            renderInternalFramebufferToTarget(target, clearTarget);
+        return;
+    }
+    cache.isValid = isCacheable;
+    cache.inputsHash = inputsHash;
+    ++cache.contentVersion;
+
     bool allowClearTargetAndPostProcess = true;
 
     if (Layer::Rendering::TileController::tiledRenderingEnabled)
@@ -1204,6 +1731,8 @@ void Layer::renderShader
             auto resource = u->getValuePtr<Resource>();
             if (resource == nullptr)
                 continue;
+            if (isImage)
+                resource->markContentChanged();
 
             // When reading from your own framebuffer, you should always read
             // from the buffer to which you are NOT writing to (the back buffer
@@ -1297,7 +1826,19 @@ void Layer::renderShader
     static auto renderer = vir::Renderer::instance();
     bool blendingEnabled = true;
     vir::Framebuffer* target0(target);
-    if (rendering_.target != Layer::Rendering::Target::Window)
+    bool isRenderScaled = 
+        rendering_.isRenderScaled && 
+        rendering_.target == Layer::Rendering::Target::Window;
+    bool isInterleaved = 
+        rendering_.interleave.stride > 1 &&
+        target == nullptr &&
+        !Layer::Rendering::TileController::tiledRenderingEnabled;
+    if 
+    (
+        rendering_.target != Layer::Rendering::Target::Window || 
+        isRenderScaled ||
+        isInterleaved
+    )
     {
         target = rendering_.backFramebuffer;
         renderer->setBlending(false);
@@ -1305,18 +1846,24 @@ void Layer::renderShader
     }
 
     // Actual render call
-    renderer->submit
-    (
-        *rendering_.quad,
-        rendering_.shader,
-        target,
-        allowClearTargetAndPostProcess && 
+    Rendering::profiler->begin(this, gui_.name);
+    if (isInterleaved)
+        renderInterleaved();
+    else
+        renderer->submit
         (
-            clearTarget || // Or force clear if not rendering to window
-            rendering_.target != Layer::Rendering::Target::Window
-        )
-    );
+            *rendering_.quad,
+            rendering_.shader,
+            target,
+            allowClearTargetAndPostProcess && 
+            (
+                clearTarget || // Or force clear if not rendering to window
+                rendering_.target != Layer::Rendering::Target::Window ||
+                isRenderScaled
+            )
+        );
     Rendering::sharedStorage->gpuMemoryBarrier();
+    Rendering::profiler->end();
 
     // Re-enable blending before either leaving or redirecting the rendered 
     // texture to the main window
@@ -1327,37 +1874,99 @@ void Layer::renderShader
     if (allowClearTargetAndPostProcess)
     {
         for (auto postProcess : rendering_.postProcesses)
+        {
+            if (postProcess->isActive())
+                Rendering::profiler->begin
+                (
+                    postProcess, 
+                    gui_.name+" / "+postProcess->name()
+                );
             postProcess->run();
+            Rendering::profiler->end();
+        }
     }
 
+    // Scaled renders are upscaled to the window like the internal framebuffer
+    // of layers rendering to both
     if 
     (
         rendering_.target != 
-        Layer::Rendering::Target::InternalFramebufferAndWindow
+        Layer::Rendering::Target::InternalFramebufferAndWindow &&
+        !isRenderScaled &&
+        !(isInterleaved && rendering_.target == Rendering::Target::Window)
     )
         return;
 
+    Rendering::profiler->begin(this, gui_.name);
+    renderInternalFramebufferToTarget
+    (
+        target0, 
+        allowClearTargetAndPostProcess && clearTarget
+    );
+    Rendering::profiler->end();
+}
+
+//----------------------------------------------------------------------------//
+
+void Layer::renderInternalFramebufferToTarget
+(
+    vir::Framebuffer* target, 
+    const bool clearTarget
+)
+{
     Layer::Rendering::textureMapperShader->bind();
     rendering_.resourceFramebuffer->bindColorBuffer(0);
     Layer::Rendering::textureMapperShader->setUniformInt("tx", 0);
-    renderer->submit
+    vir::Renderer::instance()->submit
     (
         *rendering_.quad, 
         Layer::Rendering::textureMapperShader.get(), 
-        target0,
-        allowClearTargetAndPostProcess && clearTarget
+        target,
+        clearTarget
     );
 }
 
 //----------------------------------------------------------------------------//
 
-void Layer::prepareForExport(const std::vector<Layer*>& layers)
+void Layer::prepareForExport
+(
+    const std::vector<Layer*>& layers, 
+    const bool exportInTiles
+)
 {
     if (Layer::Rendering::TileController::tiledRenderingEnabled)
         Layer::setRenderingTiles(layers, 1);
     for (auto layer : layers)
     {
+        // Always export at full resolution
+        layer->setRenderScale(1.f);
         layer->exportData_.originalResolution = layer->resolution_;
+        // When exporting in tiles, layers rendering to the window render 
+        // directly to the tile-sized export target, so their framebuffers are
+        // not resized (which could exceed the max texture size), and only 
+        // their resolution uniforms are set
+        if 
+        (
+            exportInTiles && 
+            layer->rendering_.target == Layer::Rendering::Target::Window
+        )
+        {
+            if (layer->rendering_.shader == nullptr)
+                continue;
+            glm::vec2 resolution(layer->exportData_.resolution);
+            layer->rendering_.shader->bind();
+            layer->rendering_.shader->setUniformFloat
+            (
+                "iAspectRatio", 
+                resolution.x/resolution.y
+            );
+            layer->rendering_.shader->setUniformFloat2
+            (
+                "iResolution", 
+                resolution
+            );
+            continue;
+        }
         layer->setResolution
         (
             layer->exportData_.resolution, 
@@ -1381,6 +1990,21 @@ void Layer::resetAfterExport(const std::vector<Layer*>& layers)
             false, 
             false
         );
+        // Not set by setResolution if the resolution was left unchanged by
+        // an export in tiles
+        if (layer->rendering_.shader == nullptr)
+            continue;
+        layer->rendering_.shader->bind();
+        layer->rendering_.shader->setUniformFloat
+        (
+            "iAspectRatio", 
+            layer->aspectRatio_
+        );
+        layer->rendering_.shader->setUniformFloat2
+        (
+            "iResolution", 
+            (glm::vec2)layer->resolution_
+        );
     }
     if (Layer::Rendering::TileController::nTilesCache > 1)
         Layer::setRenderingTiles
@@ -1430,6 +2054,10 @@ Layer::Rendering::Result Layer::renderShaders // Static
     const unsigned int nRenderPasses
 )
 {
+    // Swap in any shaders whose background compilation has completed
+    for (auto layer : layers)
+        layer->pollShaderCompilation(sharedUniforms);
+
     static bool clearTarget = true;
     // TODO Fix behavior of stepping to next frame when tiled rendering is
     // enabled
@@ -1461,9 +2089,51 @@ Layer::Rendering::Result Layer::renderShaders // Static
             }
         }
 
+        // Dynamic resolution scaling only applies to the live preview, and
+        // layers are restored to their full resolution otherwise
+        float renderScale = 1.f;
+        if 
+        (
+            target == nullptr && 
+            !Layer::Rendering::TileController::tiledRenderingEnabled &&
+            Layer::Rendering::ResolutionController::dynamicResolutionEnabled
+        )
+        {
+            updateRenderScale
+            (
+                vir::Window::instance()->time()->outerTimestep()
+            );
+            renderScale = Layer::Rendering::ResolutionController::scale;
+        }
+        for (auto layer : layers)
+            layer->setRenderScale
+            (
+                layer->rendering_.target == Layer::Rendering::Target::Window &&
+                layer->rendering_.interleave.stride == 1 ?
+                renderScale : 
+                1.f
+            );
+
+        // GPU timer queries of the export profiler cannot be nested with the
+        // per-layer ones, hence layers are only profiled when not exporting
+        Rendering::profiler->beginFrame(target == nullptr);
+
+        // Layers whose output is not consumed by anything are not rendered
+        Rendering::graph->build(layers, sharedUniforms, target != nullptr);
         clearTarget = true;
+        // Each call renders one tile of all layers (or whole layers if tiled
+        // rendering is disabled), which is timed for the adaptive tiling
+        bool measureTile = 
+            target == nullptr && Rendering::adaptiveTiling->isEnabled();
+        if (measureTile)
+            Rendering::adaptiveTiling->beginTile
+            (
+                Layer::Rendering::TileController::nTiles
+            );
         for (auto layer : layers)
         {
+            if (!Rendering::graph->isRendered(layer))
+                continue;
             layer->renderShader(target, clearTarget, sharedUniforms);
             // At the end of this loop, the status of clearTarget will 
             // represent whether the main window has been cleared of its 
@@ -1476,6 +2146,8 @@ Layer::Rendering::Result Layer::renderShaders // Static
             )
                 clearTarget = false;
         }
+        if (measureTile)
+            Rendering::adaptiveTiling->endTile();
 
         // If tiled rendering is enabled, it means that the previous render loop
         // has rendered only the i-th tile of each layer (in pratice, this is 
@@ -1500,6 +2172,17 @@ Layer::Rendering::Result Layer::renderShaders // Static
         }
         else
             sharedUniforms.nextRenderPass(nRenderPasses);
+
+        // The number of tiles is only ever changed at frame boundaries
+        if (measureTile && frameRendered)
+        {
+            unsigned int nTiles = Rendering::adaptiveTiling->nextTileCount
+            (
+                Layer::Rendering::TileController::nTiles
+            );
+            if (nTiles != Layer::Rendering::TileController::nTiles)
+                Layer::setRenderingTiles(layers, nTiles);
+        }
     }
     else
         frameRendered = false;
@@ -1847,6 +2530,90 @@ ICON_FA_LOCK_OPEN " - The aspect ratio is not locked\n"
             vir::Window::instance()->iconified()
         )
             ImGui::EndDisabled();
+
+        if (rendering_.target != Rendering::Target::Window)
+        {
+            ImGui::Text("Cache output         ");
+            if 
+            (
+                ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) && 
+                ImGui::BeginTooltip()
+            )
+            {
+                ImGui::Text(
+R"(If checked, the layer is only re-rendered when any of its inputs change,
+i.e., its uniform values, the resources it samples, or the output of the
+layers it samples. This only applies to layers whose source does not use
+time- or user-input-dependent shared uniforms (e.g., iTime, iFrame,
+iMouse), nor the shared storage, images, animated textures, or the layer's
+own framebuffer, and with no active post-processing effects)");
+                ImGui::EndTooltip();
+            }
+            ImGui::SameLine();
+            std::sprintf(label.get(), "##layer%dCacheOutput", id_);
+            if (ImGui::Checkbox(label.get(), &rendering_.outputCache.isEnabled))
+                invalidateOutputCache();
+            if (rendering_.outputCache.isEnabled)
+            {
+                ImGui::SameLine();
+                ImGui::Text
+                (
+                    rendering_.outputCache.isHit ? "(cached)" :
+                    rendering_.outputCache.isTimeInvariant ? "(rendering)" :
+                    "(time-dependent)"
+                );
+            }
+        }
+
+        static std::map<unsigned int, const char*> interleaveStrideToName
+        {
+            {1, "Off"},
+            {2, "1 in 4 pixels"},
+            {3, "1 in 9 pixels"},
+            {4, "1 in 16 pixels"}
+        };
+        ImGui::Text("Interleaving         ");
+        if 
+        (
+            ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) && 
+            ImGui::BeginTooltip()
+        )
+        {
+            ImGui::Text(
+R"(If enabled, only one pixel of each 2x2, 3x3 or 4x4 block is shaded on each
+frame, cycling through all pixels of the block over consecutive frames,
+while all other pixels are kept from the previous frame. This reduces the
+cost of expensive layers in the live preview at the price of smearing when
+the output changes rapidly. Interleaving is disabled when exporting and
+when rendering in tiles)");
+            ImGui::EndTooltip();
+        }
+        ImGui::SameLine();
+        ImGui::PushItemWidth(entryWidth);
+        std::sprintf(label.get(), "##layer%dInterleaveCombo", id_);
+        if 
+        (
+            ImGui::BeginCombo
+            (
+                label.get(),
+                interleaveStrideToName.at(rendering_.interleave.stride)
+            )
+        )
+        {
+            for (auto entry : interleaveStrideToName)
+            {
+                if (!ImGui::Selectable(entry.second))
+                    continue;
+                rendering_.interleave.stride = entry.first;
+                rendering_.interleave.index = 0;
+                if (entry.first == 1)
+                {
+                    DELETE_IF_NOT_NULLPTR(rendering_.interleave.framebuffer)
+                }
+            }
+            ImGui::EndCombo();
+        }
+        ImGui::PopItemWidth();
     
         if (rendering_.target != Rendering::Target::Window)
         {
@@ -1993,7 +2760,27 @@ void Layer::renderLayersTabBarGui // Static
         }
         Flags::requestRecompilation = false;
     }
-    if (anyUncompiledChanges || compilationErrors) // Render compilation button 
+    unsigned int nCompiling = 0;
+    for (auto layer : layers)
+    {
+        if (layer->isCompilingShader())
+            ++nCompiling;
+    }
+    if (nCompiling > 0)
+    {
+        static ImVec4 grayColor = 
+                ImGui::GetStyle().Colors[ImGuiCol_TextDisabled];
+        ImGui::PushStyleColor(ImGuiCol_Text, grayColor);
+        ImGui::Text
+        (
+            "Compiling %d shader%s...", 
+            nCompiling, 
+            nCompiling > 1 ? "s" : ""
+        );
+        ImGui::PopStyleColor();
+    }
+    else if (anyUncompiledChanges || compilationErrors) // Render compilation
+                                                        // button
     {
         float time = vir::Time::instance()->outerTime();
         ImVec4 compileButtonColor = 
@@ -2011,8 +2798,31 @@ void Layer::renderLayersTabBarGui // Static
         )
         {
             ImGui::SetTooltip("Compiling project shaders...");
+            // Compiled in the background where supported, with the current
+            // shaders kept in use until then. Layers whose assembled source
+            // is unchanged are not re-compiled at all
+            std::string recompiled;
+            unsigned int nUnchanged = 0;
             for (auto layer : layers)
-                layer->compileShader(sharedUnifoms);
+            {
+                layer->compileShader(sharedUnifoms, false, true);
+                if (layer->rendering_.isSourceUnchanged)
+                    ++nUnchanged;
+                else
+                    recompiled += 
+                        (recompiled.empty() ? "" : ", ")+layer->gui_.name;
+            }
+            StatusBar::queueTemporaryMessage
+            (
+                recompiled.empty() ? 
+                "No layer sources changed" :
+                "Compiling "+recompiled+
+                (
+                    nUnchanged > 0 ? 
+                    " ("+std::to_string(nUnchanged)+" unchanged)" : 
+                    ""
+                )
+            );
         }
         ImGui::PopStyleColor();
         ImGui::SameLine();
@@ -0,0 +1,287 @@
+/*
+ _____________________
+|                     |  This file is part of ShaderThing - A GUI-based live
+|   ___  _________    |  shader editor by Stefan Radman (a.k.a., virmodoetiae).
+|  /\  \/\__    __\   |  For more information, visit:
+|  \ \  \/__/\  \_/   |
+|   \ \__   \ \  \    |  https://github.com/virmodoetiae/shaderthing
+|    \/__/\  \ \  \   |
+|        \ \__\ \__\  |  SPDX-FileCopyrightText:    2025 Stefan Radman
+|  Ↄ|C    \/__/\/__/  |                             sradman@protonmail.com
+|  Ↄ|C                |  SPDX-License-Identifier:   Zlib
+|_____________________|
+
+*/
+
+#include <algorithm>
+
+#include "shaderthing/include/layergraph.h"
+
+#include "shaderthing/include/layer.h"
+#include "shaderthing/include/resource.h"
+#include "shaderthing/include/shareduniforms.h"
+#include "shaderthing/include/uniform.h"
+
+#include "thirdparty/imgui/imgui.h"
+
+namespace ShaderThing
+{
+
+std::map<LayerGraph::Root, const char*> LayerGraph::rootToName =
+{
+    {Root::None, ""},
+    {Root::Window, "Window"},
+    {Root::Export, "Export"},
+    {Root::SharedUniform, "Shared uniform"},
+    {Root::SideEffects, "Side effects"}
+};
+
+//----------------------------------------------------------------------------//
+
+void LayerGraph::addInputs
+(
+    Node& node,
+    const std::vector<Uniform*>& uniforms,
+    bool& writesImages
+) const
+{
+    for (auto u : uniforms)
+    {
+        bool isSampler
+        (
+            u->type == Uniform::Type::Sampler2D ||
+            u->type == Uniform::Type::Sampler3D ||
+            u->type == Uniform::Type::SamplerCube
+        );
+        bool isImage
+        (
+            u->type == Uniform::Type::Image2D ||
+            u->type == Uniform::Type::Image3D ||
+            u->type == Uniform::Type::ImageCube
+        );
+        if (!isSampler && !isImage)
+            continue;
+        if (isImage)
+            writesImages = true;
+        auto resource = u->getValuePtr<const Resource>();
+        if
+        (
+            resource == nullptr ||
+            resource->type() != Resource::Type::Framebuffer
+        )
+            continue;
+        auto it = nodeIndices_.find
+        (
+            static_cast<const LayerResource*>(resource)->layer()
+        );
+        if (it == nodeIndices_.end() || nodes_[it->second].layer == node.layer)
+            continue;
+        if
+        (
+            std::find(node.inputs.begin(), node.inputs.end(), it->second) ==
+            node.inputs.end()
+        )
+            node.inputs.push_back(it->second);
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+void LayerGraph::build
+(
+    const std::vector<Layer*>& layers,
+    const SharedUniforms& sharedUniforms,
+    bool isExporting
+)
+{
+    isExporting_ = isExporting;
+    nodes_.resize(layers.size());
+    nodeIndices_.clear();
+    for (unsigned int i=0; i<layers.size(); i++)
+    {
+        nodes_[i] = {};
+        nodes_[i].layer = layers[i];
+        nodeIndices_[layers[i]] = i;
+    }
+
+    // Layers sampled by shared uniforms may be sampled by any layer, and
+    // shared images may be written to by any layer
+    Node sharedNode;
+    bool sharedWritesImages = false;
+    addInputs(sharedNode, sharedUniforms.userUniforms(), sharedWritesImages);
+    for (auto index : sharedNode.inputs)
+        nodes_[index].root = Root::SharedUniform;
+
+    for (auto& node : nodes_)
+    {
+        auto layer = node.layer;
+        bool writesImages = sharedWritesImages;
+        addInputs(node, layer->uniforms_, writesImages);
+        if (node.root != Root::None)
+            continue;
+        if 
+        (
+            layer->rendering_.target != 
+            Layer::Rendering::Target::InternalFramebuffer
+        )
+            node.root = Root::Window;
+        else if (isExporting && layer->exportData_.exportFramebuffer)
+            node.root = Root::Export;
+        else if (writesImages || layer->rendering_.usesSharedStorage)
+            node.root = Root::SideEffects;
+    }
+
+    // Flag all layers reachable from the roots as live
+    std::vector<unsigned int> stack;
+    for (unsigned int i=0; i<nodes_.size(); i++)
+    {
+        if (nodes_[i].root == Root::None)
+            continue;
+        nodes_[i].isLive = true;
+        stack.push_back(i);
+    }
+    while (!stack.empty())
+    {
+        unsigned int index = stack.back();
+        stack.pop_back();
+        for (auto input : nodes_[index].inputs)
+        {
+            if (nodes_[input].isLive)
+                continue;
+            nodes_[input].isLive = true;
+            stack.push_back(input);
+        }
+    }
+    nCulled_ = 0;
+    for (auto& node : nodes_)
+    {
+        if (!node.isLive)
+            ++nCulled_;
+    }
+    sortTopologically();
+}
+
+//----------------------------------------------------------------------------//
+
+void LayerGraph::sortTopologically()
+{
+    // Kahn's algorithm, always picking the first ready node in layer order
+    unsigned int nNodes = nodes_.size();
+    std::vector<unsigned int> nPendingInputs(nNodes);
+    for (unsigned int i=0; i<nNodes; i++)
+        nPendingInputs[i] = nodes_[i].inputs.size();
+    std::vector<bool> isSorted(nNodes, false);
+    order_.clear();
+    bool progress = true;
+    while (progress)
+    {
+        progress = false;
+        for (unsigned int i=0; i<nNodes; i++)
+        {
+            if (isSorted[i] || nPendingInputs[i] > 0)
+                continue;
+            isSorted[i] = true;
+            order_.push_back(i);
+            for (unsigned int j=0; j<nNodes; j++)
+            {
+                auto& inputs = nodes_[j].inputs;
+                if (std::find(inputs.begin(), inputs.end(), i) != inputs.end())
+                    --nPendingInputs[j];
+            }
+            progress = true;
+            break;
+        }
+    }
+    hasCycles_ = order_.size() < nNodes;
+    for (unsigned int i=0; i<nNodes; i++)
+    {
+        if (!isSorted[i])
+            order_.push_back(i);
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+bool LayerGraph::isRendered(const Layer* layer) const
+{
+    if (!isCullingEnabled_)
+        return true;
+    auto it = nodeIndices_.find(layer);
+    return it == nodeIndices_.end() || nodes_[it->second].isLive;
+}
+
+//----------------------------------------------------------------------------//
+
+void LayerGraph::renderMenuItemGui
+(
+    const std::vector<Layer*>& layers,
+    const SharedUniforms& sharedUniforms
+)
+{
+    if (!ImGui::BeginMenu("Layer graph"))
+        return;
+    build(layers, sharedUniforms, isExporting_);
+    float fontSize = ImGui::GetFontSize();
+    ImGui::Text("Cull unused layers ");
+    if
+    (
+        ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) &&
+        ImGui::BeginTooltip()
+    )
+    {
+        ImGui::Text(
+R"(If checked, layers whose framebuffer is neither rendered to the window, nor
+exported, nor sampled (directly or not) by any such layer are not rendered.
+Layers writing to images or to the shared storage are always rendered)");
+        ImGui::EndTooltip();
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox("##layerGraphCulling", &isCullingEnabled_);
+    ImGuiTableFlags flags =
+        ImGuiTableFlags_BordersV |
+        ImGuiTableFlags_BordersOuterH |
+        ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("##layerGraphTable", 4, flags))
+    {
+        static ImGuiTableColumnFlags flags = 0;
+        ImGui::TableSetupColumn("Layer", flags, 8.f*fontSize);
+        ImGui::TableSetupColumn("Samples", flags, 12.f*fontSize);
+        ImGui::TableSetupColumn("Consumed by", flags, 7.f*fontSize);
+        ImGui::TableSetupColumn("Status", flags, 5.f*fontSize);
+        ImGui::TableHeadersRow();
+        for (auto index : order_)
+        {
+            const auto& node = nodes_[index];
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%s", node.layer->name().c_str());
+            ImGui::TableSetColumnIndex(1);
+            std::string inputs;
+            for (auto input : node.inputs)
+                inputs += (inputs.empty() ? "" : ", ")+
+                    nodes_[input].layer->name();
+            ImGui::Text("%s", inputs.c_str());
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text
+            (
+                "%s",
+                node.root != Root::None ?
+                rootToName[node.root] :
+                node.isLive ? "Layers" : "-"
+            );
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text
+            (
+                "%s",
+                !node.isLive && isCullingEnabled_ ? "Culled" :
+                node.layer->isOutputCached() ? "Cached" : "Rendered"
+            );
+        }
+        ImGui::EndTable();
+    }
+    if (hasCycles_)
+        ImGui::Text("Layers in cycles sample each other's previous frame");
+    ImGui::EndMenu();
+}
+
+}
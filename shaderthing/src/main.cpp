@@ -13,15 +13,172 @@
 
 */
 
+#include <cctype>
+#include <cstdlib>
 #include <filesystem>
+#include <iostream>
+#include <limits>
+#include <string>
 #if (defined(WIN32) || defined(_WIN32)) && NDEBUG
 #include <windows.h>
 #endif
 
 #include "shaderthing/include/app.h"
 
-int main()
+namespace
 {
+
+const char* usage = 
+R"(Usage: shaderthing [--render project.stf [options]]
+
+Without arguments, the ShaderThing editor is started. With --render, the 
+project is exported without any GUI and with an offscreen OpenGL context, which
+does not require a display server (OSMesa or EGL, e.g., Mesa llvmpipe). Unset
+options default to the export settings stored in the project.
+
+Options:
+  --render <file>       Project (.stf) to be rendered
+  --output <file>       Output filepath
+  --type <type>         Export type, one of: png, gif, frames, stream
+  --start <time>        Export start time (s)
+  --end <time>          Export end time (s)
+  --fps <fps>           Export frames per second
+  --resolution <WxH>    Output resolution, e.g., 1920x1080
+  --tile-size <size>    Render images larger than size in size x size tiles,
+                        0 to disable
+  --profile             Write a JSON report of the export performance next
+                        to the output file (stem_profile.json)
+  --quiet               Do not report progress
+  --help                Show this message
+)";
+
+bool parseFloat(const char* arg, std::optional<float>& value)
+{
+    char* end = nullptr;
+    float x = std::strtof(arg, &end);
+    if (end == arg || *end != '\0')
+        return false;
+    value = x;
+    return true;
+}
+
+bool parseTileSize(const char* arg, std::optional<unsigned int>& value)
+{
+    char* end = nullptr;
+    long x = std::strtol(arg, &end, 10);
+    if (end == arg || *end != '\0' || x < 0)
+        return false;
+    value = (unsigned int)x;
+    return true;
+}
+
+// Only WxH (or WXH) with positive integer W, H and nothing else is accepted
+bool parseResolution(const char* arg, std::optional<glm::ivec2>& value)
+{
+    auto parseSize = [](const char* begin, const char*& end, long& size)
+    {
+        if (!std::isdigit((unsigned char)*begin))
+            return false;
+        char* stop = nullptr;
+        size = std::strtol(begin, &stop, 10);
+        end = stop;
+        return size >= 1 && size <= std::numeric_limits<int>::max();
+    };
+    long x = 0, y = 0;
+    const char* end = nullptr;
+    if (!parseSize(arg, end, x) || (*end != 'x' && *end != 'X'))
+        return false;
+    if (!parseSize(end+1, end, y) || *end != '\0')
+        return false;
+    value = glm::ivec2(x, y);
+    return true;
+}
+
+// Returns false if the arguments are invalid or if help is requested
+bool parseArguments
+(
+    int argc, 
+    char** argv, 
+    ShaderThing::App::BatchRenderSettings& settings,
+    bool& isHelpRequested
+)
+{
+    isHelpRequested = false;
+    for (int i=1; i<argc; i++)
+    {
+        std::string arg(argv[i]);
+        if (arg == "--help" || arg == "-h")
+        {
+            isHelpRequested = true;
+            return false;
+        }
+        if (arg == "--quiet")
+        {
+            settings.quiet = true;
+            continue;
+        }
+        if (arg == "--profile")
+        {
+            settings.profile = true;
+            continue;
+        }
+        if (i+1 >= argc)
+            return false;
+        const char* value = argv[++i];
+        if (arg == "--render")
+            settings.projectFilepath = value;
+        else if (arg == "--output")
+            settings.outputFilepath = value;
+        else if (arg == "--type")
+            settings.exportType = value;
+        else if (arg == "--start")
+        {
+            if (!parseFloat(value, settings.startTime))
+                return false;
+        }
+        else if (arg == "--end")
+        {
+            if (!parseFloat(value, settings.endTime))
+                return false;
+        }
+        else if (arg == "--fps")
+        {
+            if (!parseFloat(value, settings.fps) || settings.fps.value() <= 0)
+                return false;
+        }
+        else if (arg == "--resolution")
+        {
+            if (!parseResolution(value, settings.resolution))
+                return false;
+        }
+        else if (arg == "--tile-size")
+        {
+            if (!parseTileSize(value, settings.tileSize))
+                return false;
+        }
+        else
+            return false;
+    }
+    return !settings.projectFilepath.empty();
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+    {
+        ShaderThing::App::BatchRenderSettings settings;
+        bool isHelpRequested;
+        if (!parseArguments(argc, argv, settings, isHelpRequested))
+        {
+            std::cerr << usage;
+            return isHelpRequested ? 0 : 1;
+        }
+        ShaderThing::App app(settings);
+        return app.exitCode();
+    }
+
     // Hide console if running on Windows
     #if (defined(WIN32) || defined(_WIN32)) && NDEBUG
         FreeConsole();
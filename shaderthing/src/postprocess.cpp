@@ -16,6 +16,7 @@
 #include "shaderthing/include/postprocess.h"
 #include "shaderthing/include/layer.h"
 #include "shaderthing/include/objectio.h"
+#include "shaderthing/include/renderprofiler.h"
 
 #include "thirdparty/imgui/misc/cpp/imgui_stdlib.h"
 #include "thirdparty/icons/IconsFontAwesome5.h"
@@ -37,6 +38,7 @@ native_(native)
 
 PostProcess::~PostProcess()
 {
+    Layer::Rendering::profiler->forget(this);
     DELETE_IF_NOT_NULLPTR(native_)
     if (isActive_)
         *inputFramebuffer_ = 
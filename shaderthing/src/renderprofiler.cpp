@@ -0,0 +1,356 @@
+/*
+ _____________________
+|                     |  This file is part of ShaderThing - A GUI-based live
+|   ___  _________    |  shader editor by Stefan Radman (a.k.a., virmodoetiae).
+|  /\  \/\__    __\   |  For more information, visit:
+|  \ \  \/__/\  \_/   |
+|   \ \__   \ \  \    |  https://github.com/virmodoetiae/shaderthing
+|    \/__/\  \ \  \   |
+|        \ \__\ \__\  |  SPDX-FileCopyrightText:    2025 Stefan Radman
+|  Ↄ|C    \/__/\/__/  |                             sradman@protonmail.com
+|  Ↄ|C                |  SPDX-License-Identifier:   Zlib
+|_____________________|
+
+*/
+
+#include <algorithm>
+#include <cfloat>
+#include <fstream>
+
+#include "shaderthing/include/renderprofiler.h"
+
+#include "shaderthing/include/bytedata.h"
+#include "shaderthing/include/helpers.h"
+
+#include "thirdparty/imgui/imgui.h"
+
+namespace ShaderThing
+{
+
+RenderProfiler::RenderProfiler() :
+frameHistory_(nHistory, 0.f),
+frameNumbers_(nHistory, 0)
+{
+    frameStartTime_ = Clock::now();
+}
+
+//----------------------------------------------------------------------------//
+
+RenderProfiler::~RenderProfiler()
+{
+    for (auto& item : items_)
+    {
+        for (auto& query : item.queries)
+        {
+            DELETE_IF_NOT_NULLPTR(query.query)
+        }
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+void RenderProfiler::beginFrame(bool measure)
+{
+    end();
+    auto now = Clock::now();
+    if (frame_ > 0)
+        frameSeconds_[frame_%nSlots] =
+            std::chrono::duration<double>(now-frameStartTime_).count();
+    frameStartTime_ = now;
+    ++frame_;
+
+    // The slot of the new frame is that of the frame nSlots frames ago, which
+    // is finalized before the slot is re-used
+    collectQueries();
+    if (frame_ > nSlots)
+        finalizeFrame(frame_-nSlots);
+    unsigned int slot = frame_%nSlots;
+    for (auto& item : items_)
+        item.seconds[slot] = 0;
+    isMeasuring_ = measure && isGuiOpen_ && isSupported_;
+    isFrameMeasured_[slot] = isMeasuring_;
+}
+
+//----------------------------------------------------------------------------//
+
+void RenderProfiler::collectQueries()
+{
+    for (auto& item : items_)
+    {
+        for (auto& query : item.queries)
+        {
+            uint64_t nanoseconds;
+            if
+            (
+                !query.query->isPending() ||
+                !query.query->result(nanoseconds, false)
+            )
+                continue;
+            // Results of already finalized frames are discarded
+            if (query.frame+nSlots >= frame_)
+                item.seconds[query.frame%nSlots] += 1e-9*nanoseconds;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+void RenderProfiler::finalizeFrame(uint64_t frame)
+{
+    unsigned int slot = frame%nSlots;
+    if (!isFrameMeasured_[slot])
+        return;
+    isFrameMeasured_[slot] = false;
+    frameHistory_[historyIndex_] = 1e3*frameSeconds_[slot];
+    frameNumbers_[historyIndex_] = frame;
+    for (auto& item : items_)
+        item.history[historyIndex_] = 1e3*item.seconds[slot];
+    historyIndex_ = (historyIndex_+1)%nHistory;
+    nHistoryFrames_ = std::min(nHistoryFrames_+1, nHistory);
+    meanFrameMs_ = historyMean(frameHistory_);
+    for (auto& item : items_)
+        item.meanMs = historyMean(item.history);
+}
+
+//----------------------------------------------------------------------------//
+
+float RenderProfiler::historyMean(const std::vector<float>& history) const
+{
+    unsigned int n = std::min(nHistoryFrames_, nMeanFrames);
+    if (n == 0)
+        return 0;
+    float sum = 0;
+    for (unsigned int i=1; i<=n; i++)
+        sum += history[(historyIndex_+nHistory-i)%nHistory];
+    return sum/n;
+}
+
+//----------------------------------------------------------------------------//
+
+void RenderProfiler::begin(const void* key, const std::string& name)
+{
+    if (!isMeasuring_)
+        return;
+    // Timer queries cannot be nested
+    end();
+    auto it = std::find_if
+    (
+        items_.begin(),
+        items_.end(),
+        [key](const Item& item){return item.key == key;}
+    );
+    if (it == items_.end())
+    {
+        items_.emplace_back();
+        it = items_.end()-1;
+        it->key = key;
+        it->history.resize(nHistory, 0.f);
+    }
+    it->name = name;
+    Query* query = nullptr;
+    for (auto& q : it->queries)
+    {
+        if (!q.query->isPending())
+        {
+            query = &q;
+            break;
+        }
+    }
+    if (query == nullptr)
+    {
+        // If all queries are pending, this measurement is simply skipped
+        if (it->queries.size() >= nMaxQueriesPerItem)
+            return;
+        auto timerQuery = vir::TimerQuery::create();
+        if (timerQuery == nullptr)
+        {
+            isSupported_ = false;
+            isMeasuring_ = false;
+            return;
+        }
+        it->queries.push_back({timerQuery, 0});
+        query = &it->queries.back();
+    }
+    query->frame = frame_;
+    query->query->begin();
+    activeQuery_ = query->query;
+}
+
+//----------------------------------------------------------------------------//
+
+void RenderProfiler::end()
+{
+    if (activeQuery_ == nullptr)
+        return;
+    activeQuery_->end();
+    activeQuery_ = nullptr;
+}
+
+//----------------------------------------------------------------------------//
+
+void RenderProfiler::forget(const void* key)
+{
+    auto it = std::find_if
+    (
+        items_.begin(),
+        items_.end(),
+        [key](const Item& item){return item.key == key;}
+    );
+    if (it == items_.end())
+        return;
+    for (auto& query : it->queries)
+    {
+        if (query.query == activeQuery_)
+            end();
+        DELETE_IF_NOT_NULLPTR(query.query)
+    }
+    items_.erase(it);
+}
+
+//----------------------------------------------------------------------------//
+
+bool RenderProfiler::writeCsv(const std::string& filepath) const
+{
+    std::ofstream file(filepath);
+    if (!file.is_open())
+        return false;
+    file << "frame,frameMs";
+    for (const auto& item : items_)
+        file << ",\"" << item.name << " [ms]\"";
+    file << "\n";
+    for (unsigned int i=0; i<nHistoryFrames_; i++)
+    {
+        unsigned int index =
+            (historyIndex_+nHistory-nHistoryFrames_+i)%nHistory;
+        file << frameNumbers_[index] << "," << frameHistory_[index];
+        for (const auto& item : items_)
+            file << "," << item.history[index];
+        file << "\n";
+    }
+    return file.good();
+}
+
+//----------------------------------------------------------------------------//
+
+void RenderProfiler::renderGui()
+{
+    if (fileDialog_.validSelection())
+    {
+        std::string filepath = fileDialog_.selection().front();
+        if (Helpers::fileExtension(filepath) != ".csv")
+            filepath += ".csv";
+        writeCsv(filepath);
+        fileDialog_.clearSelection();
+    }
+    if (!isGuiOpen_)
+        return;
+
+    ImGui::SetNextWindowSize(ImVec2(640, 320), ImGuiCond_FirstUseEver);
+    static ImGuiWindowFlags windowFlags(ImGuiWindowFlags_NoCollapse);
+    ImGui::Begin("Render profiler", &isGuiOpen_, windowFlags);
+
+    // Refresh icon if needed
+    if (!isGuiIconSet_ || isGuiDocked_ != ImGui::IsWindowDocked())
+    {
+        isGuiIconSet_ = vir::ImGuiRenderer::setWindowIcon
+        (
+            "Render profiler",
+            ByteData::Icon::sTIconData,
+            ByteData::Icon::sTIconSize,
+            false
+        );
+        isGuiDocked_ = ImGui::IsWindowDocked();
+    }
+
+    if (!isSupported_)
+    {
+        ImGui::Text("GPU timer queries are not supported by this device");
+        ImGui::End();
+        return;
+    }
+
+    float fontSize = ImGui::GetFontSize();
+    ImGui::Text
+    (
+        "Frame time: %.2f ms (mean of the last %u frames, measured %u frames "
+        "late)",
+        meanFrameMs_,
+        std::min(nHistoryFrames_, nMeanFrames),
+        nSlots
+    );
+    if (!isMeasuring_)
+        ImGui::Text("Not measuring while exporting");
+    ImGuiTableFlags flags =
+        ImGuiTableFlags_BordersV |
+        ImGuiTableFlags_BordersOuterH |
+        ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("##renderProfilerTable", 4, flags))
+    {
+        static ImGuiTableColumnFlags flags = 0;
+        ImGui::TableSetupColumn("Item", flags, 10.f*fontSize);
+        ImGui::TableSetupColumn("GPU [ms]", flags, 4.5f*fontSize);
+        ImGui::TableSetupColumn("Frame [%]", flags, 4.5f*fontSize);
+        ImGui::TableSetupColumn
+        (
+            "History",
+            ImGuiTableColumnFlags_WidthStretch
+        );
+        ImGui::TableHeadersRow();
+        for (const auto& item : items_)
+        {
+            ImGui::PushID(item.key);
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%s", item.name.c_str());
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.3f", item.meanMs);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text
+            (
+                "%.1f",
+                meanFrameMs_ > 0 ? 100.f*item.meanMs/meanFrameMs_ : 0.f
+            );
+            ImGui::TableSetColumnIndex(3);
+            ImGui::PlotLines
+            (
+                "##history",
+                item.history.data(),
+                nHistory,
+                historyIndex_,
+                nullptr,
+                0.f,
+                FLT_MAX,
+                ImVec2(-1, 1.5f*fontSize)
+            );
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+    if (ImGui::Button("Export history to CSV", ImVec2(-1, 0)))
+        fileDialog_.runSaveFileDialog
+        (
+            "Export render profile history",
+            {"CSV files (*.csv)", "*.csv"}
+        );
+    ImGui::End();
+}
+
+//----------------------------------------------------------------------------//
+
+void RenderProfiler::renderMenuItemGui()
+{
+    ImGui::MenuItem("Render profiler", NULL, &isGuiOpen_);
+    if
+    (
+        ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) &&
+        ImGui::BeginTooltip()
+    )
+    {
+        ImGui::Text(
+R"(Shows the GPU time spent rendering each layer and running each
+post-processing effect, measured while this window is open)");
+        ImGui::EndTooltip();
+    }
+}
+
+}
@@ -628,10 +628,50 @@ void SharedUniforms::prepareForExport(bool setTime, float exportStartTime)
 
 //----------------------------------------------------------------------------//
 
+void SharedUniforms::setExportTile(glm::ivec2 offset, glm::ivec2 size)
+{
+    // Map the tile region of the normalized device coordinates to the whole
+    // of them, so that only the tile is rasterized to the tile-sized target
+    glm::vec2 resolution(fBlock_.iResolution);
+    glm::vec2 scale = resolution/(glm::vec2)size;
+    glm::vec2 center = (2.f*(glm::vec2)offset+(glm::vec2)size)/resolution-1.f;
+    glm::mat4 tileTransform(1.f);
+    tileTransform[0][0] = scale.x;
+    tileTransform[1][1] = scale.y;
+    tileTransform[3][0] = -center.x*scale.x;
+    tileTransform[3][1] = -center.y*scale.y;
+    vBlock_.iMVP = tileTransform*screenCamera_->projectionViewMatrix();
+    vBuffer_->bind();
+    vBuffer_->setData(&vBlock_, VertexBlock::size(), 0);
+
+    // gl_FragCoord is relative to the tile-sized target, hence the offset
+    fBlock_.iFragCoordOffset = offset;
+    fBuffer_->bind();
+    fBuffer_->setData
+    (
+        &fBlock_.iFragCoordOffset, 
+        FragmentBlock::iFragCoordOffsetSize(), 
+        FragmentBlock::iFragCoordOffsetOffset()
+    );
+}
+
+//----------------------------------------------------------------------------//
+
 void SharedUniforms::resetAfterExport(bool resetFrameCounter)
 {
     flags_.resetFrameCounterPreOrPostExport = resetFrameCounter;
     fBlock_.iTime = exportData_.originalTime;
+    if (fBlock_.iFragCoordOffset != glm::vec2(0, 0))
+    {
+        fBlock_.iFragCoordOffset = {0, 0};
+        fBuffer_->bind();
+        fBuffer_->setData
+        (
+            &fBlock_.iFragCoordOffset, 
+            FragmentBlock::iFragCoordOffsetSize(), 
+            FragmentBlock::iFragCoordOffsetOffset()
+        );
+    }
     ExportData cache = exportData_;
     setResolution(exportData_.originalResolution, false, false);
     exportData_ = cache;
@@ -664,6 +664,12 @@ void TextEditor::removeLine(int aStart, int aEnd)
 
     lines_.erase(lines_.begin() + aStart, lines_.begin() + aEnd);
     assert(!lines_.empty());
+    if (lineEndStates_.size() >= (size_t)aEnd)
+        lineEndStates_.erase
+        (
+            lineEndStates_.begin() + aStart, 
+            lineEndStates_.begin() + aEnd
+        );
 
     textChanged_ = true;
 }
@@ -697,6 +703,8 @@ void TextEditor::removeLine(int aIndex)
 
     lines_.erase(lines_.begin() + aIndex);
     assert(!lines_.empty());
+    if (lineEndStates_.size() > (size_t)aIndex)
+        lineEndStates_.erase(lineEndStates_.begin() + aIndex);
 
     textChanged_ = true;
 }
@@ -706,6 +714,8 @@ TextEditor::Line& TextEditor::insertLine(int aIndex)
     assert(!readOnly_);
 
     auto& result = *lines_.insert(lines_.begin() + aIndex, Line());
+    if (lineEndStates_.size() >= (size_t)aIndex)
+        lineEndStates_.insert(lineEndStates_.begin() + aIndex, 0);
 
     ErrorMarkers etmp;
     for (auto& i : errorMarkers_)
@@ -2679,7 +2689,8 @@ void TextEditor::colorize(int aFroline, int aLines)
     colorRangeMax_ = std::max(colorRangeMax_, toLine);
     colorRangeMin_ = std::max(0, colorRangeMin_);
     colorRangeMax_ = std::max(colorRangeMin_, colorRangeMax_);
-    checkComments_ = true;
+    lexRangeMin_ = std::max(0, std::min(lexRangeMin_, aFroline));
+    lexRangeMax_ = std::max(lexRangeMax_, toLine);
 }
 
 void TextEditor::colorizeRange(int aFroline, int aToLine)
@@ -2815,186 +2826,181 @@ void TextEditor::colorizeRange(int aFroline, int aToLine)
     }
 }
 
-void TextEditor::colorizeInternal()
+// Bits of the lexer state at the end of a line
+enum LexState : uint8_t
 {
-    if (lines_.empty() || !colorizerEnabled_)
-        return;
+    WithinMultiLineComment  = 1 << 0,
+    WithinString            = 1 << 1,
+    WithinSingleLineComment = 1 << 2,
+    WithinPreproc           = 1 << 3,
+    FirstChar               = 1 << 4, // No non-whitespace characters yet
+    Concatenate             = 1 << 5  // '\' on the very end of the line
+};
 
-    if (checkComments_)
-    {
-        auto endLine = (int)lines_.size();
-        auto endIndex = 0;
-        auto commentStartLine = endLine;
-        auto commentStartIndex = endIndex;
-        auto withinString = false;
-        auto withinSingleLineComment = false;
-        auto withinPreproc = false;
-        auto firstChar = true; // there are no other non-whitespace characters
-                               // in the line before
-        auto concatenate = false; // '\' on the very end of the line
-        auto currentLine = 0;
-        auto currentIndex = 0;
-        while (currentLine < endLine || currentIndex < endIndex)
-        {
-            auto& line = lines_[currentLine];
-
-            if (currentIndex == 0 && !concatenate)
-            {
-                withinSingleLineComment = false;
-                withinPreproc = false;
-                firstChar = true;
-            }
-
-            concatenate = false;
+// Sets the comment, multi-line comment and preprocessor flags of all glyphs
+// of a line, starting from the lexer state at the end of the previous line,
+// and returns the lexer state at the end of this line
+uint8_t TextEditor::lexLineState(Line& line, uint8_t state) const
+{
+    bool inComment = state & WithinMultiLineComment;
+    bool withinString = state & WithinString;
+    bool withinSingleLineComment = state & WithinSingleLineComment;
+    bool withinPreproc = state & WithinPreproc;
+    bool firstChar = state & FirstChar;
+    if (!(state & Concatenate))
+    {
+        withinSingleLineComment = false;
+        withinPreproc = false;
+        firstChar = true;
+    }
+    bool concatenate = false;
 
-            if (!line.empty())
-            {
-                auto& g = line[currentIndex];
-                auto c = g.character;
+    auto pred = [](const char& a, const Glyph& b) 
+    {
+        return a == b.character;
+    };
+    const auto& startStr = languageDefinition_.commentStart;
+    const auto& endStr = languageDefinition_.commentEnd;
+    const auto& singleStartStr = languageDefinition_.singleLineComment;
+    int size = (int)line.size();
+    int index = 0;
+    while (index < size)
+    {
+        auto c = line[index].character;
 
-                if (c != languageDefinition_.preprocChar && !isspace(c))
-                    firstChar = false;
+        if (c != languageDefinition_.preprocChar && !isspace(c))
+            firstChar = false;
 
-                if 
-                (
-                    currentIndex == (int)line.size() - 1 && 
-                    line[line.size() - 1].character == '\\'
-                )
-                    concatenate = true;
+        if (index == size - 1 && c == '\\')
+            concatenate = true;
 
-                bool inComment = 
-                    commentStartLine < currentLine || 
-                    (
-                        commentStartLine == currentLine && 
-                        commentStartIndex <= currentIndex
-                    );
+        if (withinString)
+        {
+            line[index].multiLineComment = inComment;
 
-                if (withinString)
+            if (c == '\"')
+            {
+                if (index + 1 < size && line[index + 1].character == '\"')
                 {
-                    line[currentIndex].multiLineComment = inComment;
-
-                    if (c == '\"')
-                    {
-                        if 
-                        (
-                            currentIndex + 1 < (int)line.size() && 
-                            line[currentIndex + 1].character == '\"'
-                        )
-                        {
-                            currentIndex += 1;
-                            if (currentIndex < (int)line.size())
-                                line[currentIndex].multiLineComment = 
-                                    inComment;
-                        }
-                        else
-                            withinString = false;
-                    }
-                    else if (c == '\\')
-                    {
-                        currentIndex += 1;
-                        if (currentIndex < (int)line.size())
-                            line[currentIndex].multiLineComment = inComment;
-                    }
+                    index += 1;
+                    line[index].multiLineComment = inComment;
                 }
                 else
-                {
-                    if (firstChar && c == languageDefinition_.preprocChar)
-                        withinPreproc = true;
-
-                    if (c == '\"')
-                    {
-                        withinString = true;
-                        line[currentIndex].multiLineComment = inComment;
-                    }
-                    else
-                    {
-                        auto pred = [](const char& a, const Glyph& b) 
-                        {
-                            return a == b.character;
-                        };
-                        auto from = line.begin() + currentIndex;
-                        auto& startStr = languageDefinition_.commentStart;
-                        auto& singleStartStr = 
-                            languageDefinition_.singleLineComment;
-
-                        if 
-                        (   singleStartStr.size() > 0 &&
-                            currentIndex+singleStartStr.size() <= line.size() &&
-                            equals
-                            (
-                                singleStartStr.begin(), 
-                                singleStartStr.end(), 
-                                from, 
-                                from + singleStartStr.size(), 
-                                pred
-                            )
-                        )
-                        {
-                            withinSingleLineComment = true;
-                        }
-                        else if 
-                        (
-                            !withinSingleLineComment && 
-                            currentIndex + startStr.size() <= line.size() &&
-                            equals
-                            (
-                                startStr.begin(), 
-                                startStr.end(), 
-                                from, 
-                                from + startStr.size(), 
-                                pred)
-                            )
-                        {
-                            commentStartLine = currentLine;
-                            commentStartIndex = currentIndex;
-                        }
-
-                        inComment = 
-                        (
-                            commentStartLine < currentLine || 
-                            (
-                                commentStartLine == currentLine && 
-                                commentStartIndex <= currentIndex
-                            )
-                        );
-
-                        line[currentIndex].multiLineComment = inComment;
-                        line[currentIndex].comment = withinSingleLineComment;
+                    withinString = false;
+            }
+            else if (c == '\\')
+            {
+                index += 1;
+                if (index < size)
+                    line[index].multiLineComment = inComment;
+            }
+        }
+        else
+        {
+            if (firstChar && c == languageDefinition_.preprocChar)
+                withinPreproc = true;
 
-                        auto& endStr = languageDefinition_.commentEnd;
-                        if 
-                        (
-                            currentIndex + 1 >= (int)endStr.size() &&
-                            equals
-                            (
-                                endStr.begin(), 
-                                endStr.end(), 
-                                from + 1 - endStr.size(), 
-                                from + 1, 
-                                pred
-                            )
-                        )
-                        {
-                            commentStartIndex = endIndex;
-                            commentStartLine = endLine;
-                        }
-                    }
-                }
-                line[currentIndex].preprocessor = withinPreproc;
-                currentIndex += UTF8CharLength(c);
-                if (currentIndex >= (int)line.size())
-                {
-                    currentIndex = 0;
-                    ++currentLine;
-                }
+            if (c == '\"')
+            {
+                withinString = true;
+                line[index].multiLineComment = inComment;
             }
             else
             {
-                currentIndex = 0;
-                ++currentLine;
+                auto from = line.begin() + index;
+                if 
+                (   singleStartStr.size() > 0 &&
+                    index + singleStartStr.size() <= line.size() &&
+                    equals
+                    (
+                        singleStartStr.begin(), 
+                        singleStartStr.end(), 
+                        from, 
+                        from + singleStartStr.size(), 
+                        pred
+                    )
+                )
+                    withinSingleLineComment = true;
+                else if 
+                (
+                    !withinSingleLineComment && 
+                    index + startStr.size() <= line.size() &&
+                    equals
+                    (
+                        startStr.begin(), 
+                        startStr.end(), 
+                        from, 
+                        from + startStr.size(), 
+                        pred
+                    )
+                )
+                    inComment = true;
+
+                line[index].multiLineComment = inComment;
+                line[index].comment = withinSingleLineComment;
+
+                if 
+                (
+                    index + 1 >= (int)endStr.size() &&
+                    equals
+                    (
+                        endStr.begin(), 
+                        endStr.end(), 
+                        from + 1 - endStr.size(), 
+                        from + 1, 
+                        pred
+                    )
+                )
+                    inComment = false;
             }
         }
-        checkComments_ = false;
+        if (index < size)
+            line[index].preprocessor = withinPreproc;
+        index += UTF8CharLength(c);
+    }
+    return
+        (inComment ? WithinMultiLineComment : 0) |
+        (withinString ? WithinString : 0) |
+        (withinSingleLineComment ? WithinSingleLineComment : 0) |
+        (withinPreproc ? WithinPreproc : 0) |
+        (firstChar ? FirstChar : 0) |
+        (concatenate ? Concatenate : 0);
+}
+
+void TextEditor::colorizeInternal()
+{
+    if (lines_.empty() || !colorizerEnabled_)
+        return;
+
+    if (lexRangeMin_ < lexRangeMax_)
+    {
+        // If the line states are out of sync with the lines (e.g., after
+        // setText), all lines are re-lexed
+        if (lineEndStates_.size() != lines_.size())
+        {
+            lineEndStates_.assign(lines_.size(), 0);
+            lexRangeMin_ = 0;
+            lexRangeMax_ = (int)lines_.size();
+        }
+        uint8_t state = lexRangeMin_ > 0 ? lineEndStates_[lexRangeMin_-1] : 0;
+        int currentLine = lexRangeMin_;
+        for (; currentLine < (int)lines_.size(); ++currentLine)
+        {
+            uint8_t endState = lexLineState(lines_[currentLine], state);
+            bool isSynchronized = 
+                currentLine >= lexRangeMax_ && 
+                endState == lineEndStates_[currentLine];
+            lineEndStates_[currentLine] = endState;
+            state = endState;
+            if (isSynchronized)
+                break;
+        }
+        // Lines past the edited range whose preprocessor flags may have 
+        // changed also need their identifiers re-colorized
+        if (currentLine >= lexRangeMax_)
+            colorize(lexRangeMax_, currentLine-lexRangeMax_+1);
+        lexRangeMin_ = std::numeric_limits<int>::max();
+        lexRangeMax_ = 0;
     }
 
     if (colorRangeMin_ < colorRangeMax_)
@@ -3180,6 +3186,192 @@ void TextEditor::UndoRecord::redo(TextEditor * aEditor)
     aEditor->ensureCursorVisible();
 }
 
+// Character classes of the GLSL tokenizer
+enum CharClass : uint8_t
+{
+    Space       = 1 << 0,
+    Digit       = 1 << 1,
+    HexDigit    = 1 << 2,
+    IdStart     = 1 << 3,
+    Punctuation = 1 << 4
+};
+
+static const std::array<uint8_t, 256>& glslCharClasses()
+{
+    static const std::array<uint8_t, 256> classes = []()
+    {
+        std::array<uint8_t, 256> classes{};
+        classes[' '] = classes['\t'] = Space;
+        for (int c = '0'; c <= '9'; c++)
+            classes[c] = Digit | HexDigit;
+        for (int c = 'a'; c <= 'z'; c++)
+            classes[c] = IdStart | (c <= 'f' ? HexDigit : 0);
+        for (int c = 'A'; c <= 'Z'; c++)
+            classes[c] = IdStart | (c <= 'F' ? HexDigit : 0);
+        classes['_'] = IdStart;
+        for (char c : std::string("[]{}!%^&*()-+=~|<>?/;,."))
+            classes[(uint8_t)c] = Punctuation;
+        return classes;
+    }();
+    return classes;
+}
+
+// Hand-written GLSL tokenizer, equivalent to (but much faster than) matching
+// the token regular expressions of the language definition at each position.
+// Characters which do not start any token are returned as single-character
+// tokens of default color, so that the regular expressions are never used
+static bool tokenizeGLSL
+(
+    const char* inBegin, 
+    const char* inEnd, 
+    const char*& outBegin, 
+    const char*& outEnd, 
+    TextEditor::PaletteIndex& paletteIndex
+)
+{
+    typedef TextEditor::PaletteIndex PaletteIndex;
+    const auto& classes = glslCharClasses();
+    auto is = [&classes, inEnd](const char* p, uint8_t charClass)
+    {
+        return p < inEnd && (classes[(uint8_t)*p] & charClass);
+    };
+    const char* p = inBegin;
+    outBegin = inBegin;
+
+    // Preprocessor directive, possibly preceded by whitespace, or whitespace
+    if (is(p, Space) || *p == '#')
+    {
+        while (is(p, Space))
+            ++p;
+        if (p < inEnd && *p == '#')
+        {
+            const char* q = p+1;
+            while (is(q, Space))
+                ++q;
+            if (is(q, IdStart))
+            {
+                while (is(q, IdStart))
+                    ++q;
+                outEnd = q;
+                paletteIndex = PaletteIndex::Preprocessor;
+                return true;
+            }
+        }
+        if (p == inBegin)
+            p++;
+        outEnd = p;
+        paletteIndex = PaletteIndex::Default;
+        return true;
+    }
+
+    // String literal, possibly prefixed by L
+    if (*p == '\"' || (*p == 'L' && p+1 < inEnd && p[1] == '\"'))
+    {
+        const char* q = p + (*p == 'L' ? 2 : 1);
+        while (q < inEnd && *q != '\"')
+            q += (*q == '\\' && q+1 < inEnd) ? 2 : 1;
+        if (q < inEnd)
+        {
+            outEnd = q+1;
+            paletteIndex = PaletteIndex::String;
+            return true;
+        }
+    }
+
+    // Character literal
+    if (*p == '\'')
+    {
+        const char* q = p+1;
+        if (q < inEnd && *q == '\\')
+            ++q;
+        if (q+1 < inEnd && *q != '\'' && q[1] == '\'')
+        {
+            outEnd = q+2;
+            paletteIndex = PaletteIndex::CharLiteral;
+            return true;
+        }
+    }
+
+    // Number, with an optional sign
+    {
+        const char* q = p;
+        if (*q == '+' || *q == '-')
+            ++q;
+        if (q+1 < inEnd && *q == '0' && (q[1] == 'x' || q[1] == 'X'))
+        {
+            const char* h = q+2;
+            while (is(h, HexDigit))
+                ++h;
+            if (h > q+2)
+            {
+                if (h < inEnd && (*h == 'u' || *h == 'U'))
+                    ++h;
+                outEnd = h;
+                paletteIndex = PaletteIndex::Number;
+                return true;
+            }
+        }
+        const char* digitsStart = q;
+        while (is(q, Digit))
+            ++q;
+        bool hasDigits = q > digitsStart;
+        if (q < inEnd && *q == '.' && (hasDigits || is(q+1, Digit)))
+        {
+            ++q;
+            while (is(q, Digit))
+                ++q;
+            hasDigits = true;
+        }
+        if (hasDigits)
+        {
+            if (q < inEnd && (*q == 'e' || *q == 'E'))
+            {
+                const char* e = q+1;
+                if (e < inEnd && (*e == '+' || *e == '-'))
+                    ++e;
+                if (is(e, Digit))
+                {
+                    while (is(e, Digit))
+                        ++e;
+                    q = e;
+                }
+            }
+            if 
+            (
+                q+1 < inEnd && 
+                (*q == 'l' || *q == 'L') && 
+                (q[1] == 'f' || q[1] == 'F')
+            )
+                q += 2;
+            else if 
+            (
+                q < inEnd && 
+                (*q == 'f' || *q == 'F' || *q == 'u' || *q == 'U')
+            )
+                ++q;
+            outEnd = q;
+            paletteIndex = PaletteIndex::Number;
+            return true;
+        }
+    }
+
+    // Identifier
+    if (is(p, IdStart))
+    {
+        const char* q = p+1;
+        while (is(q, IdStart | Digit))
+            ++q;
+        outEnd = q;
+        paletteIndex = PaletteIndex::Identifier;
+        return true;
+    }
+
+    outEnd = p+1;
+    paletteIndex = 
+        is(p, Punctuation) ? PaletteIndex::Punctuation : PaletteIndex::Default;
+    return true;
+}
+
 const TextEditor::LanguageDefinition& TextEditor::LanguageDefinition::GLSL()
 {
     static bool inited = false;
@@ -3263,6 +3455,8 @@ const TextEditor::LanguageDefinition& TextEditor::LanguageDefinition::GLSL()
         langDef.tokenRegexStrings.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
         langDef.tokenRegexStrings.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
 
+        langDef.tokenize = tokenizeGLSL;
+
         langDef.commentStart = "/*";
         langDef.commentEnd = "*/";
         langDef.singleLineComment = "//";
@@ -16,11 +16,17 @@ class GLFWWrapper
 protected:
     static bool glfwInitialized_;
     static unsigned int glfwWrapperCount_;
+    static bool headless_;
 public:
     GLFWWrapper();
     virtual ~GLFWWrapper();
     static bool glfwInitialized() {return glfwInitialized_;}
     static unsigned int glfwWrapperCount() {return glfwWrapperCount_;}
+    // If true, GLFW is initialized with its null platform, i.e., without any
+    // connection to a display server, so that only OSMesa contexts can be
+    // created by GLFW itself. Only effective before GLFW is initialized
+    static void setHeadless(bool headless) {headless_ = headless;}
+    static bool headless() {return headless_;}
 };
 
 }
@@ -238,6 +238,9 @@ public:
     // array. If allocate is true, the array will be re-allocated with the 
     // correct size and data type
     virtual void readData(float*& data, bool allocate=false) = 0;
+    // Overwrite the texture data (level 0) with the provided unsigned char 
+    // data, which must be of size width*height*nChannels
+    virtual void writeData(const unsigned char* data) = 0;
     uint32_t width() const {return width_;}
     uint32_t height() const {return height_;}
     uint64_t maxMemoryFootprint() const override;
@@ -469,6 +472,12 @@ public:
     virtual void readColorBufferData(unsigned char*& data, bool yFlip=false, bool allocate=false) = 0;
     virtual void readColorBufferData(unsigned int*& data, bool yFlip=false, bool allocate=false) = 0;
     virtual void readColorBufferData(float*& data, bool yFlip=false, bool allocate=false) = 0;
+    void writeColorBufferData(const unsigned char* data)
+    {
+        if (colorBuffer_ == nullptr)
+            return;
+        colorBuffer_->writeData(data);
+    }
     virtual void clearColorBuffer(float r=0,float g=0,float b=0,float a=0) = 0;
     virtual void updateColorBufferMipmap(bool onlyIfRequiredByFilterMode=true) = 0;
     uint32_t id() const {return id_;}
@@ -583,6 +592,83 @@ public :
 
 //----------------------------------------------------------------------------//
 
+// Buffer for reading back the color buffer data of a Framebuffer without 
+// stalling the host. A read is only queued on the device, and its data can be
+// mapped once the read has completed (or it can be waited for when mapping)
+class PixelPackBuffer
+{
+protected :
+    uint32_t id_;
+    uint32_t size_;
+    uint32_t width_;
+    uint32_t height_;
+    uint32_t nChannels_;
+    bool isPending_;
+    PixelPackBuffer():
+    id_(0), size_(0), width_(0), height_(0), nChannels_(0), isPending_(false)
+    {};
+public :
+    virtual ~PixelPackBuffer(){}
+    static PixelPackBuffer* create();
+    uint32_t id() const {return id_;}
+    uint32_t size() const {return size_;}
+    uint32_t width() const {return width_;}
+    uint32_t height() const {return height_;}
+    uint32_t nChannels() const {return nChannels_;}
+    // True if a read has been queued and its data not yet mapped & unmapped
+    bool isPending() const {return isPending_;}
+    // Queue a read of the color buffer data (as unsigned char) of the provided
+    // framebuffer. The buffer is re-allocated if the data size changed
+    virtual void readColorBufferData(Framebuffer* framebuffer) = 0;
+    // True if the queued read has completed on the device (does not block)
+    virtual bool isDataReady() = 0;
+    // Map the read data, blocking until the queued read has completed. As in
+    // the framebuffer, rows are stored bottom-to-top
+    virtual const unsigned char* mapData() = 0;
+    virtual void unmapData() = 0;
+};
+
+//----------------------------------------------------------------------------//
+
+// Measures the time elapsed on the device while executing the commands issued
+// between begin and end, without stalling the pipeline when retrieving it. 
+// Only one timer query can be active at a time
+class TimerQuery
+{
+public :
+    enum class Mode
+    {
+        // Measures the GPU time elapsed between begin and end. Only one such
+        // measurement may be active at any time
+        Elapsed,
+        // Measures the difference between GPU timestamps taken at begin and
+        // end, which may be nested within any other measurement
+        Timestamps
+    };
+protected :
+    uint32_t id_;
+    bool isPending_;
+    Mode mode_;
+    TimerQuery(Mode mode):
+    id_(0), isPending_(false), mode_(mode)
+    {};
+public :
+    virtual ~TimerQuery(){}
+    // Returns a nullptr if timer queries are not supported by the device
+    static TimerQuery* create(Mode mode=Mode::Elapsed);
+    Mode mode() const {return mode_;}
+    uint32_t id() const {return id_;}
+    // True if a measurement has ended but its result not yet retrieved
+    bool isPending() const {return isPending_;}
+    virtual void begin() = 0;
+    virtual void end() = 0;
+    // If the result of the pending measurement is available, store it in
+    // nanoseconds and return true. Only blocks until available if wait is true
+    virtual bool result(uint64_t& nanoseconds, bool wait=false) = 0;
+};
+
+//----------------------------------------------------------------------------//
+
 class GraphicsBuffer
 {
 protected :
@@ -46,6 +46,7 @@ public:
     void readData(unsigned char*& data, bool allocate=false) override;
     void readData(unsigned int*& data, bool allocate=false) override;
     void readData(float*& data, bool allocate=false) override;
+    void writeData(const unsigned char* data) override;
 };
 
 class OpenGLAnimatedTextureBuffer2D : public AnimatedTextureBuffer2D
@@ -84,6 +85,7 @@ public:
     void readData(unsigned char*& data, bool allocate=false) override;
     void readData(unsigned int*& data, bool allocate=false) override;
     void readData(float*& data, bool allocate=false) override;
+    void writeData(const unsigned char* data) override;
 };
 
 class OpenGLCubeMapBuffer : public CubeMapBuffer
@@ -112,6 +114,7 @@ public:
     void readData(unsigned char*& data, bool allocate=false) override;
     void readData(unsigned int*& data, bool allocate=false) override;
     void readData(float*& data, bool allocate=false) override;
+    void writeData(const unsigned char* data) override;
 };
 
 class OpenGLTextureBuffer3D : public TextureBuffer3D
@@ -213,6 +216,32 @@ public :
     void fenceSync();
 };
 
+class OpenGLPixelPackBuffer : public PixelPackBuffer
+{
+protected :
+    GLsync fence_;
+public :
+    OpenGLPixelPackBuffer();
+    ~OpenGLPixelPackBuffer();
+    void readColorBufferData(Framebuffer* framebuffer) override;
+    bool isDataReady() override;
+    const unsigned char* mapData() override;
+    void unmapData() override;
+};
+
+class OpenGLTimerQuery : public TimerQuery
+{
+protected :
+    // Query of the end timestamp, only used in Mode::Timestamps
+    uint32_t endId_;
+public :
+    OpenGLTimerQuery(Mode mode);
+    ~OpenGLTimerQuery();
+    void begin() override;
+    void end() override;
+    bool result(uint64_t& nanoseconds, bool wait=false) override;
+};
+
 class OpenGLVertexBuffer : public VertexBuffer
 {
 protected:
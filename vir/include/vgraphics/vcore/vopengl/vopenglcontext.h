@@ -18,6 +18,9 @@ public:
     Type type() const override {return Type::OpenGL;}
     GLFWwindow* glfwWindow(){return glfwWindow_;}
     void initialize(void* nativeWindow) override;
+    // Initialize with an already current context not managed by GLFW (e.g.,
+    // an offscreen EGL context), whose functions are loaded with loadProc
+    void initialize(void* nativeWindow, void* (*loadProc)(const char*));
     void printErrors() const override;
 };
 
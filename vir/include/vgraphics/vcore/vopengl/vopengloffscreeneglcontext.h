@@ -0,0 +1,50 @@
+#ifndef V_OPENGL_OFFSCREEN_EGL_CONTEXT_H
+#define V_OPENGL_OFFSCREEN_EGL_CONTEXT_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace vir
+{
+
+// OpenGL context created directly with EGL on Mesa's surfaceless platform
+// (i.e., without any display server or GPU, e.g., with llvmpipe), for headless
+// usage. A pbuffer of the window size is used as the default framebuffer if
+// supported, else no surface is bound at all. libEGL is loaded at run-time, so
+// that it is not a dependency of the non-headless application. Only available
+// on Linux
+class OffscreenEGLContext
+{
+private:
+
+    void* display_ = nullptr;
+    void* context_ = nullptr;
+    void* surface_ = nullptr;
+
+    static void* library_;
+
+    OffscreenEGLContext() = default;
+
+    static bool loadLibrary();
+
+public:
+
+    ~OffscreenEGLContext();
+
+    // Returns a context of the first supported version of glVersions, made
+    // current, or nullptr if no such context could be created
+    static OffscreenEGLContext* create
+    (
+        const std::vector<std::pair<int, int>>& glVersions,
+        uint32_t width,
+        uint32_t height
+    );
+
+    // OpenGL function loader, to be used with GLAD
+    static void* procAddress(const char* name);
+};
+
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef V_OPENGL_SHADER_H
 #define V_OPENGL_SHADER_H
 
+#include <chrono>
 #include <string>
 #include "thirdparty/glm/glm.hpp"
 #include "thirdparty/glad/include/glad/glad.h"
@@ -12,6 +13,18 @@ namespace vir
 class OpenGLShader : public Shader
 {
 protected:
+    // Only set during asynchronous compilations
+    unsigned int vertexShader_   = 0;
+    unsigned int fragmentShader_ = 0;
+    bool         isCompiling_    = false;
+    std::string  binaryFilepath_;
+    std::chrono::steady_clock::time_point compileStartTime_;
+    void setActiveResourceStatistics();
+    static unsigned int submitShaderSource
+    (
+        const std::string& source,
+        GLuint type
+    );
     static void checkValidShader(const unsigned int& id, std::string& log);
     static unsigned int createShaderFromSource
     (
@@ -30,11 +43,32 @@ protected:
         const std::string& log, 
         std::map<int, std::string>& errors
     );
+
+    // Program binary cache. Binaries are keyed by a hash of the device, of the
+    // enabled shading language extensions and of the full shader sources, and
+    // binaries rejected by the driver (e.g., after a driver update) are 
+    // deleted and the shader is simply re-compiled
+    static bool isBinaryCacheSupported();
+    static std::string binaryCacheFilepath
+    (
+        const std::string& vertexSource,
+        const std::string& fragmentSource
+    );
+    static void evictBinaries();
+    bool loadBinary(const std::string& filepath);
+    void storeBinary(const std::string& filepath) const;
 public:
     // Construct of from vertex and fragment shader (either source code or file
     // path)
-    OpenGLShader(const std::string& v, const std::string& f, ConstructFrom c);
+    OpenGLShader
+    (
+        const std::string& v, 
+        const std::string& f, 
+        ConstructFrom c, 
+        bool async = false
+    );
     ~OpenGLShader() override;
+    bool isCompiling() override;
     void bind() const override;
     void unbind() const override;
 
@@ -67,6 +101,9 @@ public:
     GLint getUniformBlockIndex(const std::string&);
 
     static std::string currentContextShadingLanguageDirectives();
+    // True if GL_KHR_parallel_shader_compile (or its ARB equivalent) is
+    // supported
+    static bool isAsyncCompilationSupported();
     static bool setExtensionStatusInCurrentContextShadingLanguageDirectives
     (
         const std::string& extensionName,
@@ -169,6 +169,21 @@ public:
         void resetValue();
     };
 
+    // Figures of the compilation of a shader. Times are in seconds, and for
+    // asynchronous compilations compileTime is the time elapsed until the
+    // completion was detected, linking included
+    struct Statistics
+    {
+        double   compileTime       = 0;
+        double   linkTime          = 0;
+        // Total vertex and fragment source length, in characters
+        uint64_t sourceLength      = 0;
+        int      nActiveUniforms   = 0;
+        int      nActiveSamplers   = 0;
+        bool     isAsync           = false;
+        bool     isFromBinaryCache = false;
+    };
+
     struct CompilationErrors
     {
         std::map<int, std::string> vertexErrors   = {};
@@ -183,20 +198,33 @@ protected:
     uint32_t id_;
     std::unordered_map<std::string, uint32_t> uniformMap_;
     CompilationErrors compilationErrors_;
+    Statistics statistics_;
     // Map of all extensions supported by the graphics context to their 
     // respective status in the shading language, i.e., is said extension
     // included in the shading language directives returned by 
     // shadingLanguageDirectives()? Only useful for OpenGL (as far as I know)
     static std::unordered_map<std::string, bool> 
         currentContextExtensionsStatusMap_;
+    // On-disk cache of linked shader program binaries, disabled if the 
+    // directory is empty
+    static std::string binaryCacheDirectory_;
+    static uint64_t binaryCacheMaxSize_;
 public:
+    // If async is true and asynchronous compilation is supported, the shader
+    // is compiled and linked in the background, in which case isCompiling()
+    // should be polled and the shader should not be used until it returns
+    // false. Otherwise, the shader is compiled before returning
     static Shader* create
     (
         const std::string& vertexSource, 
         const std::string& fragmentSource, 
-        ConstructFrom constructFrom
+        ConstructFrom constructFrom,
+        bool async = false
     ); 
     virtual ~Shader(){}
+    // Returns true while an asynchronous compilation is in progress, and 
+    // sets the compilation errors (if any) once it completes
+    virtual bool isCompiling() = 0;
     virtual void bind() const = 0;
     virtual void unbind() const = 0;
 
@@ -235,8 +263,10 @@ public:
         return compilationErrors_;
     }
     bool valid() const {return compilationErrors_.size() == 0;}
+    const Statistics& statistics() const {return statistics_;}
 
     static std::string currentContextShadingLanguageDirectives();
+    static bool isAsyncCompilationSupported();
     static bool setExtensionStatusInCurrentContextShadingLanguageDirectives
     (
         const std::string& extensionName,
@@ -248,6 +278,20 @@ public:
     );
     static std::vector<std::string> 
         extensionsInCurrentContextShadingLanguageDirectives();
+
+    // Set the directory of the on-disk cache of linked shader program 
+    // binaries (an empty directory disables the cache) and the maximum
+    // cache size in bytes, beyond which the least recently used binaries are
+    // deleted. Only shaders constructed from source code are cached
+    static void setBinaryCache
+    (
+        const std::string& directory, 
+        uint64_t maxSize
+    );
+    static const std::string& binaryCacheDirectory() 
+    {
+        return binaryCacheDirectory_;
+    }
 };
 
 }
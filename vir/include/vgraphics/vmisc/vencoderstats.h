@@ -0,0 +1,75 @@
+#ifndef V_ENCODER_STATS_H
+#define V_ENCODER_STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace vir
+{
+
+// Thread-safe record of the duration of the stages of each frame processed by
+// an encoder, and of the number of bytes it has written. Stages may run on any
+// thread (e.g., on encoder workers), and the recorded samples are handed over
+// to the caller via takeSamples
+class EncoderStats
+{
+public:
+
+    enum class Stage
+    {
+        Quantization,
+        Encoding,
+        Writing
+    };
+
+    struct Sample
+    {
+        Stage  stage;
+        double seconds;
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    static double secondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now()-start).count();
+    }
+
+protected:
+
+    std::mutex          mutex_;
+    std::vector<Sample> samples_;
+    uint64_t            nBytesWritten_ = 0;
+
+public:
+
+    void record(Stage stage, double seconds)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        samples_.push_back({stage, seconds});
+    }
+
+    void recordBytesWritten(uint64_t nBytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nBytesWritten_ += nBytes;
+    }
+
+    // Append the samples recorded since the last call to samples, and return
+    // the number of bytes written since the last call
+    uint64_t takeSamples(std::vector<Sample>& samples)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        samples.insert(samples.end(), samples_.begin(), samples_.end());
+        samples_.clear();
+        uint64_t nBytesWritten = nBytesWritten_;
+        nBytesWritten_ = 0;
+        return nBytesWritten;
+    }
+};
+
+}
+
+#endif
@@ -1,8 +1,15 @@
 #ifndef V_GIF_ENCODER_H
 #define V_GIF_ENCODER_H
 
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <string>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "vgraphics/vmisc/vencoderstats.h"
 #include "vgraphics/vpostprocess/vquantizer.h"
 
 class GifFileType;
@@ -37,21 +44,67 @@ public:
 
 protected:
 
-    //
-    typedef struct
+    // LZW compressor for the TABLE BASED IMAGE DATA section of a GIF frame.
+    // The code tree is allocated once and re-used across frames. Instead of
+    // clearing the whole tree on every reset, a generation counter is bumped
+    // and tree nodes are lazily cleared when first written to in the new
+    // generation. Codes are packed into a 64-bit bit buffer and flushed to a
+    // contiguous code stream, which is finally split in GIF data sub-blocks
+    class LZWEncoder
     {
-        uint16_t next[256];
-    } GifLZWNode;
+    private:
+
+        struct Node
+        {
+            uint32_t generation;
+            uint16_t next[256];
+        };
+
+        std::vector<Node>          codeTree_;
+        uint32_t                   generation_;
+        std::vector<unsigned char> codeStream_;
+
+        void resetCodeTree();
+
+    public:
+
+        LZWEncoder();
+
+        // Compress the provided width x height indices, stored in rows of
+        // stride indices (each index is first re-mapped via indexMap), and
+        // append the resulting data sub-blocks (block terminator excluded) to
+        // output
+        void encode
+        (
+            const unsigned char* indices,
+            uint32_t stride,
+            uint32_t width,
+            uint32_t height,
+            bool flipVertically,
+            const unsigned char* indexMap,
+            uint32_t minCodeSize,
+            std::vector<unsigned char>& output
+        );
+    };
 
-    // Simple structure to write out the LZW-compressed portion of the image
-    // one bit at a time
-    typedef struct
+    // A frame whose header (i.e., everything preceeding the TABLE BASED IMAGE
+    // DATA) has been assembled, but whose indices are yet to be compressed.
+    // Only used in asynchronous mode
+    struct FrameJob
     {
-        uint8_t  bitIndex;
-        uint8_t  byte;      
-        uint32_t chunkIndex;
-        uint8_t  chunk[256];
-    } GifBitStatus;
+        std::vector<unsigned char> indices;
+        std::vector<unsigned char> data;
+        uint32_t                   width = 0;
+        uint32_t                   height = 0;
+        bool                       flipVertically = false;
+        bool                       isEncoded = false;
+    };
+
+    // Rectangular region of the indexed texture, in indexed texture coordinates
+    struct Region
+    {
+        uint32_t x, y, width, height;
+    };
 
     FILE*          file_ = nullptr;
     bool           firstFrame_, firstCumulation_;
@@ -61,9 +114,47 @@ protected:
     PaletteMode    paletteMode_;
     IndexMode      indexMode_;
 
-    Quantizer*     quantizer_;
+    // Map from quantizer indices to GIF palette indices, which are shifted by
+    // one if a transparent color is reserved by the selected index mode
+    unsigned char  indexMap_[256];
+
+    // Each frame is fully assembled in memory and written to file at once
+    std::vector<unsigned char> frameData_;
+    LZWEncoder     lzwEncoder_;
+
+    // If the GPU quantizer cannot run on this device, the CPU one is used
+    // instead
+    Quantizer*        quantizer_;
+    Quantizer::Device quantizerDevice_;
+    bool              isGPUQuantizerAvailable_;
+
+    EncoderStats      stats_;
+
+    // Asynchronous mode data. Frame jobs are compressed in parallel by the
+    // workers and written to file strictly in frame order. Jobs are recycled
+    // to avoid re-allocating their buffers on every frame
+    unsigned int             nWorkers_ = 0;
+    unsigned int             maxFramesInFlight_ = 1;
+    unsigned int             nJobs_ = 0;
+    std::vector<std::thread> workers_;
+    std::deque<FrameJob*>    pendingJobs_;  // Waiting to be compressed
+    std::deque<FrameJob*>    inFlightJobs_; // Waiting to be written, in order
+    std::vector<FrameJob*>   freeJobs_;
+    bool                     stopWorkers_ = false;
+    std::mutex               jobsMutex_;
+    std::mutex               fileMutex_;
+    std::condition_variable  jobAvailable_;
+    std::condition_variable  jobWritten_;
+
+    void startWorkers();
+    void stopWorkers();
+    void workerLoop();
+    void writeEncodedFrames();
     
+    void writeByte(uint8_t byte) {frameData_.push_back(byte);}
+    void writeBytes(const char* bytes);
     void writePaletteData();
+    Region findUpdatedRegion() const;
     void encodeIndexedFrame(int delay, bool flipVertically);
 
 public:
@@ -74,6 +165,14 @@ public:
     bool isFileOpen() const {return file_ != nullptr;}
     bool canRunOnDeviceInUse() const {return quantizer_->canRunOnDeviceInUse();}
     const std::string& errorMessage() const {return quantizer_->errorMessage();}
+    Quantizer::Device quantizerDevice() const {return quantizerDevice_;}
+    bool isGPUQuantizerAvailable() const {return isGPUQuantizerAvailable_;}
+    EncoderStats& stats() {return stats_;}
+
+    // Select the device on which frames are quantized. If the GPU is requested
+    // but the GPU quantizer cannot run on this device, the CPU is used instead.
+    // Has no effect while a file is open
+    void setQuantizerDevice(Quantizer::Device device);
 
     bool openFile
     (
@@ -87,6 +186,13 @@ public:
 
     bool closeFile();
 
+    // If nWorkers > 0, the LZW compression of each frame is off-loaded to 
+    // nWorkers background threads, so that encodeFrame only returns once
+    // the frame has been quantized. At most maxFramesInFlight frames (at least
+    // one) are kept in memory while waiting to be compressed and written, past
+    // which encodeFrame blocks. Only applied on the next openFile call
+    void setAsyncEncoding(unsigned int nWorkers, unsigned int maxFramesInFlight);
+
     template
     <
         typename FrameType/*, 
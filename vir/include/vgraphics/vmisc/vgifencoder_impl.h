@@ -16,12 +16,18 @@ void GifEncoder::cumulatePaletteForAveraging(FrameType* frame)
     quantizerOptions.regenerateMipmap = false;
     quantizerOptions.relTol = 0.0f;
     quantizerOptions.reseedPalette = firstCumulation_;
+    auto start = EncoderStats::Clock::now();
     quantizer_->quantize
     (
         frame, 
         paletteSize_, 
         quantizerOptions
     );
+    stats_.record
+    (
+        EncoderStats::Stage::Quantization, 
+        EncoderStats::secondsSince(start)
+    );
     firstCumulation_ = false;
 }
 
@@ -61,6 +67,7 @@ void GifEncoder::encodeFrame(FrameType* frame, const EncodingOptions& options)
     quantizerOptions.regenerateMipmap = true;
     quantizerOptions.fastKMeans = true;
     quantizerOptions.overwriteInput = true;
+    auto start = EncoderStats::Clock::now();
     quantizer_->quantize
     (
         frame, 
@@ -70,6 +77,11 @@ void GifEncoder::encodeFrame(FrameType* frame, const EncodingOptions& options)
     quantizer_->getIndexedTexture(indexedTexture_, firstFrame_);
     if (quantizerOptions.reseedPalette || quantizerOptions.recalculatePalette)
         quantizer_->getPalette(palette_, firstFrame_);
+    stats_.record
+    (
+        EncoderStats::Stage::Quantization, 
+        EncoderStats::secondsSince(start)
+    );
     encodeIndexedFrame
     (
         options.delay, 
@@ -0,0 +1,101 @@
+#ifndef V_PNG_ENCODER_H
+#define V_PNG_ENCODER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "vgraphics/vmisc/vencoderstats.h"
+
+namespace vir
+{
+
+// Compresses and writes frames to PNG files. In asynchronous mode, each frame
+// is copied to a buffer owned by the encoder, and frames are compressed and
+// written in parallel by a pool of background workers. Since each frame is 
+// written to its own file, frames are not necessarily written in order
+class PngEncoder
+{
+protected:
+
+    struct FrameJob
+    {
+        std::vector<unsigned char> data;
+        std::string                filepath;
+        uint32_t                   width = 0;
+        uint32_t                   height = 0;
+        uint32_t                   nChannels = 0;
+        bool                       flipVertically = false;
+    };
+
+    int                      compressionLevel_ = 8;
+    unsigned int             nFailedFrames_ = 0;
+    EncoderStats             stats_;
+
+    // Used in synchronous mode only
+    FrameJob                 job_;
+
+    // Asynchronous mode data. Jobs are recycled to avoid re-allocating their
+    // buffers on every frame
+    unsigned int             nWorkers_ = 0;
+    unsigned int             maxFramesInFlight_ = 1;
+    unsigned int             nJobs_ = 0;
+    std::vector<std::thread> workers_;
+    std::deque<FrameJob*>    pendingJobs_;
+    std::vector<FrameJob*>   freeJobs_;
+    bool                     stopWorkers_ = false;
+    std::mutex               jobsMutex_;
+    std::condition_variable  jobAvailable_;
+    std::condition_variable  jobWritten_;
+
+    void startWorkers();
+    void stopWorkers();
+    void workerLoop();
+    bool writeFrame(const FrameJob& job);
+
+    // Delete copy-construction & copy-assignment ops
+    PngEncoder(const PngEncoder&) = delete;
+    PngEncoder& operator= (const PngEncoder&) = delete;
+
+public:
+
+    PngEncoder(){}
+    ~PngEncoder();
+
+    // If nWorkers > 0, frames are compressed and written by nWorkers 
+    // background threads, so that encodeFrame only returns once the frame data
+    // has been copied. At most maxFramesInFlight frames (at least one) are
+    // kept in memory while waiting to be written, past which encodeFrame
+    // blocks. Any frames still in flight are written first
+    void setAsyncEncoding(unsigned int nWorkers, unsigned int maxFramesInFlight);
+
+    // Set the zlib compression level, from 0 (fastest) to 9 (smallest files).
+    // Any frames still in flight are written first
+    void setCompressionLevel(int level);
+    int compressionLevel() const {return compressionLevel_;}
+    EncoderStats& stats() {return stats_;}
+
+    // Encode the provided width x height frame of nChannels unsigned char 
+    // channels and write it to filepath. If flipVertically is true, the rows
+    // of the provided data are written in reversed order
+    void encodeFrame
+    (
+        const unsigned char* data,
+        uint32_t width,
+        uint32_t height,
+        uint32_t nChannels,
+        const std::string& filepath,
+        bool flipVertically=false
+    );
+
+    // Wait for all frames in flight to be written. Returns the number of frames
+    // that could not be written since the last call
+    unsigned int finish();
+};
+
+}
+
+#endif
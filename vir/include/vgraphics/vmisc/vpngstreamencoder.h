@@ -0,0 +1,120 @@
+#ifndef V_PNG_STREAM_ENCODER_H
+#define V_PNG_STREAM_ENCODER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "vgraphics/vmisc/vencoderstats.h"
+
+namespace vir
+{
+
+// Writes a PNG file row by row, so that images much larger than what can be
+// kept in memory (or in a single GPU texture) can be encoded from row bands.
+// Rows are filtered and deflated (LZ77 with fixed Huffman codes, as done by
+// stb_image_write) as soon as they are provided, and compressed data is
+// written to disk in IDAT chunks, so that only a 32 kB sliding window and the
+// last row are kept in memory
+class PngStreamEncoder
+{
+protected:
+
+    static constexpr uint32_t windowSize_ = 32768;
+    static constexpr uint32_t minMatchLength_ = 3;
+    static constexpr uint32_t maxMatchLength_ = 258;
+    static constexpr uint32_t hashBits_ = 15;
+    static constexpr uint32_t idatChunkSize_ = 1 << 18;
+
+    FILE*                      file_ = nullptr;
+    uint32_t                   width_ = 0;
+    uint32_t                   height_ = 0;
+    uint32_t                   nChannels_ = 0;
+    uint32_t                   nRowsWritten_ = 0;
+    uint32_t                   maxChainLength_ = 0;
+    bool                       hasFailed_ = false;
+    EncoderStats               stats_;
+
+    // Time spent and bytes written by writeChunk since the last recording of
+    // the encoder stats
+    double                     writingSeconds_ = 0;
+    uint64_t                   nBytesWritten_ = 0;
+
+    // Previous (unfiltered) row, current filtered row candidate and best
+    // filtered row (with its leading filter type byte)
+    std::vector<unsigned char> previousRow_;
+    std::vector<unsigned char> filteredRow_;
+    std::vector<unsigned char> bestFilteredRow_;
+
+    // Deflate state. The window contains the last windowSize_ bytes of
+    // already encoded data followed by the data yet to be encoded, with
+    // windowStart_ being the stream position of its first byte. Hash chains
+    // store stream positions, -1 if empty
+    std::vector<unsigned char> window_;
+    uint64_t                   windowStart_ = 0;
+    uint64_t                   position_ = 0;
+    std::vector<int64_t>       hashHeads_;
+    std::vector<int64_t>       hashChains_;
+    uint64_t                   bitBuffer_ = 0;
+    uint32_t                   nBits_ = 0;
+    uint32_t                   adlerA_ = 1;
+    uint32_t                   adlerB_ = 0;
+
+    // Compressed data yet to be written in an IDAT chunk
+    std::vector<unsigned char> idat_;
+
+    void writeChunk(const char* type, const unsigned char* data, uint32_t size);
+    void flushIdat();
+    void writeBits(uint32_t bits, uint32_t nBits);
+    void writeHuffmanCode(uint32_t code, uint32_t nBits);
+    void writeSymbol(uint32_t symbol);
+    void writeMatch(uint32_t length, uint32_t distance);
+    void insertHash(uint64_t position);
+    void deflate(bool finish);
+    void filterRow(const unsigned char* row);
+    void recordStats(EncoderStats::Clock::time_point start);
+
+    // Delete copy-construction & copy-assignment ops
+    PngStreamEncoder(const PngStreamEncoder&) = delete;
+    PngStreamEncoder& operator= (const PngStreamEncoder&) = delete;
+
+public:
+
+    PngStreamEncoder(){}
+    ~PngStreamEncoder();
+
+    // Open filepath and write the PNG header of a width x height image of
+    // nChannels (1 to 4) unsigned char channels. The compression level ranges
+    // from 0 (fastest, largest files) to 9 (slowest, smallest files). Returns
+    // false if the file could not be opened
+    bool openFile
+    (
+        const std::string& filepath,
+        uint32_t width,
+        uint32_t height,
+        uint32_t nChannels,
+        int compressionLevel=8
+    );
+
+    // Encode the next nRows rows of the image, provided as contiguous rows of
+    // width x nChannels unsigned chars. If flipVertically is true, the rows
+    // of the provided data are encoded in reversed order
+    void encodeRows
+    (
+        const unsigned char* data,
+        uint32_t nRows,
+        bool flipVertically=false
+    );
+
+    // Finish the compressed stream and close the file. Returns false if any
+    // data could not be written or if fewer rows than the image height have
+    // been encoded
+    bool closeFile();
+
+    bool isFileOpen() const {return file_ != nullptr;}
+    EncoderStats& stats() {return stats_;}
+};
+
+}
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef V_RAW_VIDEO_ENCODER_H
+#define V_RAW_VIDEO_ENCODER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "vgraphics/vmisc/vencoderstats.h"
+
+namespace vir
+{
+
+// Streams RGBA8 frames to a single uncompressed video file, either as raw 
+// RGBA8 frames (no header) or as a YUV4MPEG2 (Y4M) stream with 4:2:0 chroma
+// subsampling, which can be fed to an external video encoder (e.g., ffmpeg). 
+// In asynchronous mode, frames are copied to buffers owned by the encoder and
+// converted and written in order by a background worker. If the filepath is
+// "-", the stream is written to the standard output
+class RawVideoEncoder
+{
+public:
+
+    enum class Format
+    {
+        RGBA = 0,
+        Y4M = 1
+    };
+
+    static std::map<Format, const char*> formatToName;
+    static std::map<Format, const char*> formatToExtension;
+
+protected:
+
+    struct FrameJob
+    {
+        std::vector<unsigned char> data;
+        bool                       flipVertically = false;
+    };
+
+    FILE*                      file_ = nullptr;
+    bool                       isStdout_ = false;
+    Format                     format_ = Format::Y4M;
+    uint32_t                   width_ = 0;
+    uint32_t                   height_ = 0;
+    bool                       hasWriteFailed_ = false;
+    EncoderStats               stats_;
+
+    // Write buffer of the file stream, so that frames are written with few
+    // large sequential writes
+    std::vector<char>          fileBuffer_;
+
+    // Frame data after conversion to the output format
+    std::vector<unsigned char> frameData_;
+
+    // Used in synchronous mode only
+    FrameJob                   job_;
+
+    // Asynchronous mode data. Jobs are processed in order by a single worker,
+    // and recycled to avoid re-allocating their buffers on every frame
+    unsigned int               maxFramesInFlight_ = 0;
+    unsigned int               nJobs_ = 0;
+    std::thread                worker_;
+    std::deque<FrameJob*>      pendingJobs_;
+    std::vector<FrameJob*>     freeJobs_;
+    bool                       stopWorker_ = false;
+    std::mutex                 jobsMutex_;
+    std::condition_variable    jobAvailable_;
+    std::condition_variable    jobWritten_;
+
+    void startWorker();
+    void stopWorker();
+    void workerLoop();
+    void writeFrame(const FrameJob& job);
+    uint64_t frameSize() const;
+
+    // Delete copy-construction & copy-assignment ops
+    RawVideoEncoder(const RawVideoEncoder&) = delete;
+    RawVideoEncoder& operator= (const RawVideoEncoder&) = delete;
+
+public:
+
+    RawVideoEncoder(){}
+    ~RawVideoEncoder();
+
+    bool isFileOpen() const {return file_ != nullptr;}
+    EncoderStats& stats() {return stats_;}
+
+    // If maxFramesInFlight > 0, frames are converted and written by a 
+    // background thread, so that encodeFrame only returns once the frame data
+    // has been copied. At most maxFramesInFlight frames are kept in memory
+    // while waiting to be written, past which encodeFrame blocks. Only applied
+    // on the next openFile call
+    void setAsyncEncoding(unsigned int maxFramesInFlight);
+
+    // Open the output stream and write its header (if any). If nFrames is 
+    // known (i.e., > 0), the file storage is pre-allocated where supported
+    bool openFile
+    (
+        const std::string& filepath,
+        uint32_t width,
+        uint32_t height,
+        float fps,
+        Format format=Format::Y4M,
+        uint32_t nFrames=0
+    );
+
+    // Returns false if any write failed since the file was opened
+    bool closeFile();
+
+    // Encode the provided width x height RGBA8 frame, with width and height as
+    // provided to openFile. If flipVertically is true, the rows of the 
+    // provided data are written in reversed order
+    void encodeFrame(const unsigned char* data, bool flipVertically=false);
+};
+
+}
+
+#endif
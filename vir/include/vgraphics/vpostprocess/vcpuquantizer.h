@@ -0,0 +1,164 @@
+#ifndef V_CPU_QUANTIZER_H
+#define V_CPU_QUANTIZER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "vgraphics/vpostprocess/vquantizer.h"
+
+namespace vir
+{
+
+class TextureBuffer2D;
+class Framebuffer;
+
+// A CPU implementation of the color quantizer which mirrors the K-Means
+// algorithm of the OpenGLQuantizer step by step. The input data is read back
+// from the GPU, quantized on all available CPU cores and uploaded back. The
+// nearest-palette-color search is vectorized with SSE2/AVX2 where available
+// (selected at runtime). Since it does not rely on compute shaders it can run
+// on any device, and since its output is fully deterministic it can also be
+// used as a reference for validating the GPU implementation
+class CPUQuantizer : public Quantizer
+{
+protected:
+
+    // Minimal fork-join thread pool. The range [0, n) is split in size()
+    // contiguous chunks, each processed by one thread (calling thread
+    // included), and run only returns once all chunks have been processed
+    class ThreadPool
+    {
+    public:
+
+        // Chunk index, begin, end
+        typedef std::function<void(uint32_t, uint32_t, uint32_t)> Task;
+
+    private:
+
+        std::vector<std::thread> workers_;
+        std::mutex               mutex_;
+        std::condition_variable  taskAvailable_;
+        std::condition_variable  taskDone_;
+        const Task*              task_ = nullptr;
+        uint32_t                 n_ = 0;
+        uint64_t                 generation_ = 0;
+        uint32_t                 nBusyWorkers_ = 0;
+        bool                     stop_ = false;
+
+        void workerLoop(uint32_t chunk);
+        void runChunk(uint32_t chunk);
+
+    public:
+
+        ThreadPool(unsigned int nThreads);
+        ~ThreadPool();
+
+        uint32_t size() const {return workers_.size()+1;}
+        void run(uint32_t n, const Task& task);
+    };
+
+    // Max number of palettes that can be cumulated before wrapping around,
+    // same order of magnitude as the GL_MAX_TEXTURE_SIZE limit of the
+    // OpenGLQuantizer cumulated palette texture
+    static constexpr uint32_t maxNCumulatedPalettes_ = 16384;
+
+    ThreadPool                 threadPool_;
+
+    // RGBA8 copy of the input, and of its downsampled version used by the
+    // K-Means when fastKMeans is requested. Rows are stored bottom-to-top,
+    // as in the GPU textures
+    std::vector<unsigned char> inputData_;
+    std::vector<unsigned char> kMeansData_;
+
+    // Raw data in the native number of channels of the input, used for
+    // reading back and uploading the input/output
+    std::vector<unsigned char> transferData_;
+
+    // RGBA8 quantized input
+    std::vector<unsigned char> outputData_;
+
+    // Palette colors (RGB8) and their padded int16 layout used by the
+    // vectorized nearest-color search
+    std::vector<unsigned char> palette_;
+    std::vector<int16_t>       packedPalette_;
+
+    // RGBA8 rows of cumulated palettes
+    std::vector<unsigned char> cumulatedPaletteData_;
+    uint32_t                   cumulatedPaletteRow_ = 0;
+
+    // Indexed input
+    std::vector<unsigned char> indexedData_;
+
+    // RGBA8 previously quantized input, for IndexMode::Delta
+    std::vector<unsigned char> oldQuantizedInput_;
+
+    // Per-thread cluster accumulators (r, g, b, count) and clustering errors
+    std::vector<uint64_t>      clusterData_;
+    std::vector<uint64_t>      clusteringErrors_;
+
+    void packPalette();
+    void seedPalette(const unsigned char* data, uint32_t nPixels);
+    void downsample(uint32_t& width, uint32_t& height, uint32_t level);
+    void quantizeData
+    (
+        const unsigned char* data,
+        uint32_t width,
+        uint32_t height,
+        unsigned int paletteSize,
+        const Settings& settings
+    );
+    void expandInput(uint32_t width, uint32_t height, uint32_t nChannels);
+    void readInput(TextureBuffer2D* input);
+    void readInput(Framebuffer* input);
+    void packOutput(uint32_t nChannels);
+
+    // Delete copy-construction & copy-assignment ops
+    CPUQuantizer(const CPUQuantizer&) = delete;
+    CPUQuantizer& operator= (const CPUQuantizer&) = delete;
+
+public:
+
+    CPUQuantizer();
+    virtual ~CPUQuantizer(){}
+
+    // Overloaded quantization functions for vir:: objects
+    virtual void quantize
+    (
+        TextureBuffer2D* input,
+        unsigned int paletteSize,
+        const Settings& settings
+    ) override;
+    virtual void quantize
+    (
+        Framebuffer* input,
+        unsigned int paletteSize,
+        const Settings& settings
+    ) override;
+
+    // Retrieve the palette colors and store them in the provided data array. If
+    // allocate is true, the array will be re-allocated with the correct size
+    void getPalette
+    (
+        unsigned char*& data,
+        bool allocate=false,
+        bool cumulated=false
+    ) override;
+
+    // Retrieve the indexed colors and store them in the provided data array. If
+    // allocate is true, the array will be re-allocated with the correct size
+    void getIndexedTexture
+    (
+        unsigned char*& data,
+        bool allocate=false
+    ) override;
+
+    // The cumulated palettes are not stored in a GPU texture
+    int getCumulatedPaletteImageId() const override {return 0;}
+};
+
+}
+
+#endif
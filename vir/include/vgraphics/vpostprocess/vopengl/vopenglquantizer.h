@@ -19,11 +19,13 @@ class OpenGLQuantizer : public Quantizer
 protected:
 
     static bool computeShaderStagesCompiled;
+    static OpenGLComputeShader computeShader_seedPaletteSF32;
     static OpenGLComputeShader computeShader_findMaxSqrDistColSF32;
     static OpenGLComputeShader computeShader_setNextPaletteColSF32;
     static OpenGLComputeShader computeShader_buildClustersFromPaletteSF32;
     static OpenGLComputeShader computeShader_updatePaletteFromClustersSF32;
     static OpenGLComputeShader computeShader_quantizeInputSF32;
+    static OpenGLComputeShader computeShader_seedPaletteUI8;
     static OpenGLComputeShader computeShader_findMaxSqrDistColUI8;
     static OpenGLComputeShader computeShader_setNextPaletteColUI8;
     static OpenGLComputeShader computeShader_buildClustersFromPaletteUI8;
@@ -56,8 +58,10 @@ protected:
     //
     void* mappedWriteOnlyPaletteData_;
     
-    // Atomic counter for storing the clustering error
+    // SSBO storing the clustering error (atomic counter), followed by the 
+    // per-work-group results of the furthest-color search used for seeding
     GLuint clusteringError_;
+    GLsizeiptr ssboSize_;
 
     // 
     GLuint oldQuantizedInput_;
@@ -68,6 +72,9 @@ protected:
     // True if the previously quantized image had a 32-bit float internal format
     bool isFloat320_ = false;
 
+    // Grow the clustering error SSBO to at least size bytes
+    void reserveSSBO(GLsizeiptr size);
+
     //
     void quantizeOpenGLTexture
     (
@@ -16,6 +16,15 @@ class Quantizer : public PostProcess
 {
 public:
 
+// Device on which the quantization is carried out
+enum class Device
+{
+    GPU = 0,
+    CPU = 1
+};
+
+static std::unordered_map<Device, std::string> deviceToName;
+
 struct Settings
 {
     // Texture index mode
@@ -131,6 +140,14 @@ struct Settings
     // If true, the palette computed from this quantization call will
     // be appended to a texture of palettes
     bool cumulatePalette=false;
+
+    // If > 0, at most maxIterations KMeans iterations are run, and the
+    // convergence of the KMeans is checked on the device itself (where 
+    // applicable) rather than by reading back the clustering error after each
+    // iteration, so that the host only syncs with the device once per
+    // quantization call. Recommended when quantizing on every frame. If 0, the
+    // KMeans runs until convergence
+    unsigned int maxIterations=0;
 };
 
 protected:
@@ -160,8 +177,10 @@ protected:
 
 public:
 
-    // Create a Quantizer-type object
-    static Quantizer* create();
+    // Create a Quantizer-type object running on the requested device. The GPU
+    // quantizer runs on the graphics context in use, while the CPU quantizer
+    // reads back the input data and quantizes it on all available CPU cores
+    static Quantizer* create(Device device=Device::GPU);
 
     // Destructor
     virtual ~Quantizer(){}
@@ -2,8 +2,10 @@
 #define V_HELPERS_H
 
 #include <algorithm>
+#include <cstdint>
 #include <fstream>
 #include <sstream>
+#include <string>
 #include <vector>
 
 namespace vir
@@ -47,6 +49,25 @@ typename std::vector<T*>::iterator findInPtrVector
 // Load contents of file at filepath to a target string
 void readFileToString(std::string filepath, std::string& target);
 
+// Initial value of 64-bit FNV-1a hashes
+constexpr uint64_t fnv1aOffsetBasis = 14695981039346656037ull;
+
+// 64-bit FNV-1a hash of size bytes of data, combined with a previous hash
+uint64_t hashFnv1a
+(
+    const void* data, 
+    size_t size, 
+    uint64_t hash = fnv1aOffsetBasis
+);
+
+// 64-bit FNV-1a hash of a string followed by a separator, so that successive
+// strings are hashed unambiguously (i.e., "ab"+"c" != "a"+"bc")
+uint64_t hashFnv1a
+(
+    const std::string& s, 
+    uint64_t hash = fnv1aOffsetBasis
+);
+
 }
 
 }
@@ -1,6 +1,7 @@
 #ifndef V_INITIALIZATION_H
 #define V_INITIALIZATION_H
 
+#include <cstdint>
 #include <string>
 
 namespace vir
@@ -29,6 +30,14 @@ struct Settings
           bool         enableBlending          = true;
           bool         enableDepthTesting      = true;
           bool         enableFaceCulling       = true;
+          // If true, the window is never shown and the graphics context is
+          // created offscreen without a display server (via OSMesa or, if
+          // unavailable, EGL on Mesa's surfaceless platform)
+          bool         headless                = false;
+          // Directory of the on-disk cache of linked shader program 
+          // binaries (disabled if empty) and its maximum size in bytes
+          std::string  shaderBinaryCacheDirectory = "";
+          uint64_t     shaderBinaryCacheMaxSize   = 128u << 20;
 };
 
 // Initialize the vir back-end with the provided settings
@@ -23,7 +23,11 @@
 #include "vgraphics/vpostprocess/vquantizer.h"
 #include "vgraphics/vpostprocess/vbloomer.h"
 #include "vgraphics/vpostprocess/vblurrer.h"
+#include "vgraphics/vmisc/vencoderstats.h"
 #include "vgraphics/vmisc/vgifencoder.h"
+#include "vgraphics/vmisc/vpngencoder.h"
+#include "vgraphics/vmisc/vpngstreamencoder.h"
+#include "vgraphics/vmisc/vrawvideoencoder.h"
 #include "vinput/vinputcodes.h"
 #include "vinput/vinputstate.h"
 #include "vtime/vtime.h"
@@ -3,6 +3,7 @@
 //#define _USE_MATH_DEFINES // Eh, maybe not
 #include <algorithm>
 #include <cmath>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <limits>
@@ -8,11 +8,16 @@
 namespace vir
 {
 
+class OffscreenEGLContext;
+
 class GLFWOpenGLWindow : public Window, public GLFWWrapper
 {
 private :
 
     GLFWwindow* glfwWindow_;
+    // Only set if headless and if no OSMesa context could be created, in which
+    // case the GLFW window has no context of its own
+    OffscreenEGLContext* eglContext_ = nullptr;
 
 public :
     
@@ -23,6 +28,7 @@ public :
         std::string name, 
         bool resizable=true
     );
+    ~GLFWOpenGLWindow();
     
     void* nativeWindow() override {return glfwWindow_;}
 
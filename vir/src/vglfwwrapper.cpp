@@ -6,12 +6,15 @@ namespace vir
 
 bool GLFWWrapper::glfwInitialized_ = false;
 unsigned int GLFWWrapper::glfwWrapperCount_ = 0;
+bool GLFWWrapper::headless_ = false;
 
 GLFWWrapper::GLFWWrapper()
 {
     glfwWrapperCount_++;
     if (!glfwInitialized_)
     {
+        if (headless_)
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
         glfwInit();
         glfwInitialized_ = true;
     }
@@ -1072,4 +1072,46 @@ ShaderStorageBuffer* ShaderStorageBuffer::create(uint32_t size)
     return nullptr;
 }
 
-}
\ No newline at end of file
+//----------------------------------------------------------------------------//
+
+PixelPackBuffer* PixelPackBuffer::create()
+{
+    Window* window = nullptr;
+    if (!GlobalPtr<Window>::valid(window))
+        return nullptr;
+    try
+    {
+        switch(window->context()->type())
+        {
+            case (GraphicsContext::Type::OpenGL) :
+                return new OpenGLPixelPackBuffer();
+        }
+    }
+    catch(...){}
+    return nullptr;
+}
+
+//----------------------------------------------------------------------------//
+
+TimerQuery* TimerQuery::create(Mode mode)
+{
+    Window* window = nullptr;
+    if (!GlobalPtr<Window>::valid(window))
+        return nullptr;
+    auto context = window->context();
+    switch(context->type())
+    {
+        case (GraphicsContext::Type::OpenGL) :
+            // Timer queries are core since OpenGL 3.3
+            if 
+            (
+                context->versionMajor() < 3 || 
+                (context->versionMajor() == 3 && context->versionMinor() < 3)
+            )
+                return nullptr;
+            return new OpenGLTimerQuery(mode);
+    }
+    return nullptr;
+}
+
+}
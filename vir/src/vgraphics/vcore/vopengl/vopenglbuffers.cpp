@@ -405,6 +405,38 @@ void OpenGLTextureBuffer2D::readData(float*& data, bool allocate)
     READ_DATA(id_, float, GL_FLOAT)
 }
 
+#define WRITE_DATA(id)                                                      \
+    GLint glFormat = OpenGLFormat(internalFormat_);                         \
+    bool resetAlignment = false;                                            \
+    if (glFormat != GL_RGBA && glFormat != GL_RGBA_INTEGER)                 \
+    {                                                                       \
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);                              \
+        resetAlignment = true;                                              \
+    }                                                                       \
+    else                                                                    \
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);                              \
+    glBindTexture(GL_TEXTURE_2D, id);                                       \
+    glTexSubImage2D                                                         \
+    (                                                                       \
+        GL_TEXTURE_2D,                                                      \
+        0,                                                                  \
+        0,                                                                  \
+        0,                                                                  \
+        width_,                                                             \
+        height_,                                                            \
+        glFormat,                                                           \
+        GL_UNSIGNED_BYTE,                                                   \
+        data                                                                \
+    );                                                                      \
+    glBindTexture(GL_TEXTURE_2D, 0);                                        \
+    if (resetAlignment)                                                     \
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+void OpenGLTextureBuffer2D::writeData(const unsigned char* data)
+{
+    WRITE_DATA(id_)
+}
+
 void OpenGLTextureBuffer2D::updateMipmap(bool onlyIfRequiredByFilterMode)
 {
     if 
@@ -581,6 +613,11 @@ void OpenGLAnimatedTextureBuffer2D::readData(float*& data, bool allocate)
     READ_DATA(frame_->id(), float, GL_FLOAT)
 }
 
+void OpenGLAnimatedTextureBuffer2D::writeData(const unsigned char* data)
+{
+    WRITE_DATA(frame_->id())
+}
+
 void OpenGLAnimatedTextureBuffer2D::updateMipmap(bool onlyIfRequiredByFilterMode)
 {
     // For simplicity, only regenerate the mipmap of the current frame
@@ -807,6 +844,12 @@ void OpenGLCubeMapBuffer::readData(float*& data, bool allocate)
     throw std::runtime_error("OpenGLCubeMapBuffer::readData - Not implemented");
 }
 
+void OpenGLCubeMapBuffer::writeData(const unsigned char* data)
+{
+    (void)data;
+    throw std::runtime_error("OpenGLCubeMapBuffer::writeData - Not implemented");
+}
+
 void OpenGLCubeMapBuffer::updateMipmap(bool onlyIfRequiredByFilterMode)
 {
     if 
@@ -1474,6 +1517,170 @@ void OpenGLShaderStorageBuffer::fenceSync()
     OpenGLWaitSync();
 }
 
+//----------------------------------------------------------------------------//
+// Pixel pack buffer ---------------------------------------------------------//
+//----------------------------------------------------------------------------//
+
+OpenGLPixelPackBuffer::OpenGLPixelPackBuffer() :
+PixelPackBuffer(),
+fence_(nullptr)
+{
+    glGenBuffers(1, &id_);
+}
+
+OpenGLPixelPackBuffer::~OpenGLPixelPackBuffer()
+{
+    if (fence_ != nullptr)
+        glDeleteSync(fence_);
+    glDeleteBuffers(1, &id_);
+}
+
+void OpenGLPixelPackBuffer::readColorBufferData(Framebuffer* framebuffer)
+{
+    if (framebuffer == nullptr)
+        return;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, id_);
+    uint32_t size = framebuffer->colorBufferDataSize();
+    if (size != size_)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        size_ = size;
+    }
+    width_ = framebuffer->width();
+    height_ = framebuffer->height();
+    nChannels_ = framebuffer->colorBufferNChannels();
+    framebuffer->bind();
+    GLint glFormat = OpenGLFormat(framebuffer->colorBufferInternalFormat());
+    bool resetAlignment = false;
+    if (glFormat != GL_RGBA && glFormat != GL_RGBA_INTEGER)
+    {
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        resetAlignment = true;
+    }
+    else
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    
+    // With a bound pixel pack buffer, glReadPixels returns immediately and
+    // the last argument is an offset into the buffer
+    glReadPixels(0, 0, width_, height_, glFormat, GL_UNSIGNED_BYTE, 0);
+    if (resetAlignment)
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (fence_ != nullptr)
+        glDeleteSync(fence_);
+    fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    isPending_ = true;
+}
+
+bool OpenGLPixelPackBuffer::isDataReady()
+{
+    if (!isPending_)
+        return false;
+    if (fence_ == nullptr)
+        return true;
+    GLenum status = glClientWaitSync(fence_, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+const unsigned char* OpenGLPixelPackBuffer::mapData()
+{
+    if (!isPending_)
+        return nullptr;
+    while (fence_ != nullptr)
+    {
+        GLenum wait = glClientWaitSync
+        (
+            fence_, 
+            GL_SYNC_FLUSH_COMMANDS_BIT, 
+            1000000 // ns == 1000 us timeout
+        );
+        if (wait == GL_ALREADY_SIGNALED || wait == GL_CONDITION_SATISFIED)
+        {
+            glDeleteSync(fence_);
+            fence_ = nullptr;
+        }
+        else if (wait == GL_WAIT_FAILED)
+            break;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, id_);
+    auto data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size_, GL_MAP_READ_BIT);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return (const unsigned char*)data;
+}
+
+void OpenGLPixelPackBuffer::unmapData()
+{
+    if (!isPending_)
+        return;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, id_);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    isPending_ = false;
+}
+
+//----------------------------------------------------------------------------//
+// Timer query ---------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+
+OpenGLTimerQuery::OpenGLTimerQuery(Mode mode) :
+TimerQuery(mode),
+endId_(0)
+{
+    glGenQueries(1, &id_);
+    if (mode_ == Mode::Timestamps)
+        glGenQueries(1, &endId_);
+}
+
+OpenGLTimerQuery::~OpenGLTimerQuery()
+{
+    glDeleteQueries(1, &id_);
+    if (mode_ == Mode::Timestamps)
+        glDeleteQueries(1, &endId_);
+}
+
+void OpenGLTimerQuery::begin()
+{
+    if (mode_ == Mode::Timestamps)
+        glQueryCounter(id_, GL_TIMESTAMP);
+    else
+        glBeginQuery(GL_TIME_ELAPSED, id_);
+}
+
+void OpenGLTimerQuery::end()
+{
+    if (mode_ == Mode::Timestamps)
+        glQueryCounter(endId_, GL_TIMESTAMP);
+    else
+        glEndQuery(GL_TIME_ELAPSED);
+    isPending_ = true;
+}
+
+bool OpenGLTimerQuery::result(uint64_t& nanoseconds, bool wait)
+{
+    if (!isPending_)
+        return false;
+    // The end timestamp is available only after the begin one
+    GLuint lastId = mode_ == Mode::Timestamps ? endId_ : id_;
+    if (!wait)
+    {
+        GLint isAvailable = 0;
+        glGetQueryObjectiv(lastId, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+        if (!isAvailable)
+            return false;
+    }
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(id_, GL_QUERY_RESULT, &elapsed);
+    if (mode_ == Mode::Timestamps)
+    {
+        GLuint64 endTime = 0;
+        glGetQueryObjectui64v(endId_, GL_QUERY_RESULT, &endTime);
+        elapsed = endTime > elapsed ? endTime-elapsed : 0;
+    }
+    nanoseconds = elapsed;
+    isPending_ = false;
+    return true;
+}
+
 //----------------------------------------------------------------------------//
 // Vertex buffer -------------------------------------------------------------//
 //----------------------------------------------------------------------------//
@@ -7,12 +7,21 @@ namespace vir
 bool OpenGLContext::gladInitialized_ = false;
 
 void OpenGLContext::initialize(void* nativeWindow)
+{
+    glfwMakeContextCurrent(static_cast<GLFWwindow*>(nativeWindow));
+    initialize(nativeWindow, (void*(*)(const char*))glfwGetProcAddress);
+}
+
+void OpenGLContext::initialize
+(
+    void* nativeWindow, 
+    void* (*loadProc)(const char*)
+)
 {
     glfwWindow_ = static_cast<GLFWwindow*>(nativeWindow);
-    glfwMakeContextCurrent(glfwWindow_);
     if (!gladInitialized_)
     {
-        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        if (!gladLoadGLLoader((GLADloadproc)loadProc))
         {
             std::cout << "Failed to initialize GLAD" << std::endl;
             throw std::exception();
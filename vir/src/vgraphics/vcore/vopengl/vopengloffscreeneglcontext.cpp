@@ -0,0 +1,301 @@
+#include "vpch.h"
+#include "vgraphics/vcore/vopengl/vopengloffscreeneglcontext.h"
+
+#if defined(__linux__)
+#include <dlfcn.h>
+#endif
+
+namespace vir
+{
+
+void* OffscreenEGLContext::library_ = nullptr;
+
+#if defined(__linux__)
+
+namespace
+{
+
+// Only the few EGL definitions in use are replicated (as GLFW does), so that
+// the EGL headers are not a build dependency either
+typedef int32_t      EGLint;
+typedef unsigned int EGLBoolean;
+typedef unsigned int EGLenum;
+typedef void*        EGLDisplay;
+typedef void*        EGLConfig;
+typedef void*        EGLContext;
+typedef void*        EGLSurface;
+
+constexpr EGLint  EGL_NONE                              = 0x3038;
+constexpr EGLint  EGL_ALPHA_SIZE                        = 0x3021;
+constexpr EGLint  EGL_BLUE_SIZE                         = 0x3022;
+constexpr EGLint  EGL_GREEN_SIZE                        = 0x3023;
+constexpr EGLint  EGL_RED_SIZE                          = 0x3024;
+constexpr EGLint  EGL_SURFACE_TYPE                      = 0x3033;
+constexpr EGLint  EGL_PBUFFER_BIT                       = 0x0001;
+constexpr EGLint  EGL_RENDERABLE_TYPE                   = 0x3040;
+constexpr EGLint  EGL_OPENGL_BIT                        = 0x0008;
+constexpr EGLint  EGL_EXTENSIONS                        = 0x3055;
+constexpr EGLint  EGL_HEIGHT                            = 0x3056;
+constexpr EGLint  EGL_WIDTH                             = 0x3057;
+constexpr EGLenum EGL_OPENGL_API                        = 0x30A2;
+constexpr EGLint  EGL_CONTEXT_MAJOR_VERSION             = 0x3098;
+constexpr EGLint  EGL_CONTEXT_MINOR_VERSION             = 0x30FB;
+constexpr EGLint  EGL_CONTEXT_OPENGL_PROFILE_MASK       = 0x30FD;
+constexpr EGLint  EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT   = 0x0001;
+constexpr EGLint  EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE = 0x31B1;
+constexpr EGLenum EGL_PLATFORM_SURFACELESS_MESA         = 0x31DD;
+
+struct EGLFunctions
+{
+    void*       (*getProcAddress)(const char*);
+    const char* (*queryString)(EGLDisplay, EGLint);
+    EGLDisplay  (*getDisplay)(void*);
+    EGLDisplay  (*getPlatformDisplayEXT)(EGLenum, void*, const EGLint*);
+    EGLBoolean  (*initialize)(EGLDisplay, EGLint*, EGLint*);
+    EGLBoolean  (*terminate)(EGLDisplay);
+    EGLBoolean  (*chooseConfig)
+                (EGLDisplay, const EGLint*, EGLConfig*, EGLint, EGLint*);
+    EGLBoolean  (*bindAPI)(EGLenum);
+    EGLContext  (*createContext)
+                (EGLDisplay, EGLConfig, EGLContext, const EGLint*);
+    EGLBoolean  (*destroyContext)(EGLDisplay, EGLContext);
+    EGLSurface  (*createPbufferSurface)(EGLDisplay, EGLConfig, const EGLint*);
+    EGLBoolean  (*destroySurface)(EGLDisplay, EGLSurface);
+    EGLBoolean  (*makeCurrent)(EGLDisplay, EGLSurface, EGLSurface, EGLContext);
+} egl = {};
+
+bool hasExtension(const char* extensions, const std::string& name)
+{
+    if (extensions == nullptr)
+        return false;
+    std::istringstream stream(extensions);
+    std::string extension;
+    while (stream >> extension)
+    {
+        if (extension == name)
+            return true;
+    }
+    return false;
+}
+
+}
+
+//----------------------------------------------------------------------------//
+
+bool OffscreenEGLContext::loadLibrary()
+{
+    if (library_ != nullptr)
+        return true;
+    for (auto name : {"libEGL.so.1", "libEGL.so"})
+    {
+        library_ = dlopen(name, RTLD_LAZY | RTLD_LOCAL);
+        if (library_ != nullptr)
+            break;
+    }
+    if (library_ == nullptr)
+        return false;
+    #define LOAD(F, NAME)                                                   \
+    *(void**)(&egl.F) = dlsym(library_, NAME);                              \
+    if (egl.F == nullptr)                                                   \
+    {                                                                       \
+        dlclose(library_);                                                  \
+        library_ = nullptr;                                                 \
+        return false;                                                       \
+    }
+    LOAD(getProcAddress, "eglGetProcAddress")
+    LOAD(queryString, "eglQueryString")
+    LOAD(getDisplay, "eglGetDisplay")
+    LOAD(initialize, "eglInitialize")
+    LOAD(terminate, "eglTerminate")
+    LOAD(chooseConfig, "eglChooseConfig")
+    LOAD(bindAPI, "eglBindAPI")
+    LOAD(createContext, "eglCreateContext")
+    LOAD(destroyContext, "eglDestroyContext")
+    LOAD(createPbufferSurface, "eglCreatePbufferSurface")
+    LOAD(destroySurface, "eglDestroySurface")
+    LOAD(makeCurrent, "eglMakeCurrent")
+    #undef LOAD
+    *(void**)(&egl.getPlatformDisplayEXT) =
+        egl.getProcAddress("eglGetPlatformDisplayEXT");
+    return true;
+}
+
+//----------------------------------------------------------------------------//
+
+OffscreenEGLContext* OffscreenEGLContext::create
+(
+    const std::vector<std::pair<int, int>>& glVersions,
+    uint32_t width,
+    uint32_t height
+)
+{
+    if (!loadLibrary())
+        return nullptr;
+
+    // The surfaceless platform does not require any display server (unlike
+    // the default platform) nor any window surface (unlike GLFW's EGL
+    // contexts), but it requires client extensions to be selected
+    const char* clientExtensions = egl.queryString(nullptr, EGL_EXTENSIONS);
+    EGLDisplay display = nullptr;
+    if
+    (
+        egl.getPlatformDisplayEXT != nullptr &&
+        hasExtension(clientExtensions, "EGL_EXT_platform_base") &&
+        hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")
+    )
+        display = egl.getPlatformDisplayEXT
+        (
+            EGL_PLATFORM_SURFACELESS_MESA,
+            nullptr,
+            nullptr
+        );
+    if (display == nullptr || !egl.initialize(display, nullptr, nullptr))
+    {
+        // E.g., non-Mesa drivers which support headless default displays
+        display = egl.getDisplay(nullptr);
+        if (display == nullptr || !egl.initialize(display, nullptr, nullptr))
+            return nullptr;
+    }
+    if (!egl.bindAPI(EGL_OPENGL_API))
+    {
+        egl.terminate(display);
+        return nullptr;
+    }
+
+    // A pbuffer-capable config is preferred, so that the default framebuffer
+    // exists, else a config-less context without any surface is created
+    const char* extensions = egl.queryString(display, EGL_EXTENSIONS);
+    EGLConfig config = nullptr;
+    EGLint nConfigs = 0;
+    const EGLint configAttributes[] =
+    {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    bool hasConfig =
+        egl.chooseConfig(display, configAttributes, &config, 1, &nConfigs) &&
+        nConfigs > 0;
+    if
+    (
+        !hasConfig &&
+        (
+            !hasExtension(extensions, "EGL_KHR_no_config_context") ||
+            !hasExtension(extensions, "EGL_KHR_surfaceless_context")
+        )
+    )
+    {
+        egl.terminate(display);
+        return nullptr;
+    }
+
+    EGLContext context = nullptr;
+    for (auto glVersion : glVersions)
+    {
+        const EGLint contextAttributes[] =
+        {
+            EGL_CONTEXT_MAJOR_VERSION, glVersion.first,
+            EGL_CONTEXT_MINOR_VERSION, glVersion.second,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE, 1,
+            EGL_NONE
+        };
+        context = egl.createContext
+        (
+            display,
+            hasConfig ? config : nullptr,
+            nullptr,
+            contextAttributes
+        );
+        if (context != nullptr)
+            break;
+    }
+    if (context == nullptr)
+    {
+        egl.terminate(display);
+        return nullptr;
+    }
+
+    EGLSurface surface = nullptr;
+    if (hasConfig)
+    {
+        const EGLint surfaceAttributes[] =
+        {
+            EGL_WIDTH, (EGLint)std::max(width, 1u),
+            EGL_HEIGHT, (EGLint)std::max(height, 1u),
+            EGL_NONE
+        };
+        surface =
+            egl.createPbufferSurface(display, config, surfaceAttributes);
+    }
+    auto offscreenContext = new OffscreenEGLContext();
+    offscreenContext->display_ = display;
+    offscreenContext->context_ = context;
+    offscreenContext->surface_ = surface;
+    if (!egl.makeCurrent(display, surface, surface, context))
+    {
+        delete offscreenContext;
+        return nullptr;
+    }
+    return offscreenContext;
+}
+
+//----------------------------------------------------------------------------//
+
+OffscreenEGLContext::~OffscreenEGLContext()
+{
+    egl.makeCurrent(display_, nullptr, nullptr, nullptr);
+    if (surface_ != nullptr)
+        egl.destroySurface(display_, surface_);
+    egl.destroyContext(display_, context_);
+    egl.terminate(display_);
+}
+
+//----------------------------------------------------------------------------//
+
+void* OffscreenEGLContext::procAddress(const char* name)
+{
+    // Core functions are only guaranteed to be returned by eglGetProcAddress
+    // with EGL_KHR_get_all_proc_addresses (always the case with Mesa)
+    void* address = egl.getProcAddress(name);
+    if (address == nullptr)
+        address = dlsym(RTLD_DEFAULT, name);
+    return address;
+}
+
+#else
+
+bool OffscreenEGLContext::loadLibrary()
+{
+    return false;
+}
+
+OffscreenEGLContext* OffscreenEGLContext::create
+(
+    const std::vector<std::pair<int, int>>& glVersions,
+    uint32_t width,
+    uint32_t height
+)
+{
+    (void)glVersions;
+    (void)width;
+    (void)height;
+    return nullptr;
+}
+
+OffscreenEGLContext::~OffscreenEGLContext(){}
+
+void* OffscreenEGLContext::procAddress(const char* name)
+{
+    (void)name;
+    return nullptr;
+}
+
+#endif
+
+}
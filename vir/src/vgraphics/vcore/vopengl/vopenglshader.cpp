@@ -64,6 +64,21 @@ unsigned int OpenGLShader::createShaderFromSource
 
 //----------------------------------------------------------------------------//
 
+unsigned int OpenGLShader::submitShaderSource
+(
+    const std::string& sourceString, 
+    GLuint shaderType
+)
+{
+    const char* source = sourceString.c_str();
+    unsigned int shader = glCreateShader(shaderType);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    return shader;
+}
+
+//----------------------------------------------------------------------------//
+
 void OpenGLShader::parseCompilationErrorLog
 (
     const std::string& log,
@@ -120,13 +135,205 @@ void OpenGLShader::parseCompilationErrorLog
     }
 }
 
+//----------------------------------------------------------------------------//
+
+bool OpenGLShader::isBinaryCacheSupported()
+{
+    static bool isSupported = [](){
+        if (!GLAD_GL_VERSION_4_1 && !GLAD_GL_ARB_get_program_binary)
+            return false;
+        GLint nFormats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &nFormats);
+        return nFormats > 0;
+    }();
+    return isSupported;
+}
+
+//----------------------------------------------------------------------------//
+
+std::string OpenGLShader::binaryCacheFilepath
+(
+    const std::string& vertexSource,
+    const std::string& fragmentSource
+)
+{
+    static std::string device = 
+        std::string((const char*)glGetString(GL_VENDOR))+"|"+
+        std::string((const char*)glGetString(GL_RENDERER))+"|"+
+        std::string((const char*)glGetString(GL_VERSION));
+    uint64_t hash = Helpers::hashFnv1a(device);
+    hash = Helpers::hashFnv1a(currentContextShadingLanguageDirectives(), hash);
+    hash = Helpers::hashFnv1a(vertexSource, hash);
+    hash = Helpers::hashFnv1a(fragmentSource, hash);
+    char name[24];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)hash);
+    return (std::filesystem::path(binaryCacheDirectory_)/name).string();
+}
+
+//----------------------------------------------------------------------------//
+
+void OpenGLShader::evictBinaries()
+{
+    std::error_code error;
+    std::vector<std::filesystem::directory_entry> entries;
+    uint64_t size = 0;
+    for 
+    (
+        const auto& entry : 
+        std::filesystem::directory_iterator(binaryCacheDirectory_, error)
+    )
+    {
+        if (!entry.is_regular_file(error) || entry.path().extension() != ".bin")
+            continue;
+        size += entry.file_size(error);
+        entries.push_back(entry);
+    }
+    if (size <= binaryCacheMaxSize_)
+        return;
+    // Least recently used first, as binaries are touched when loaded
+    std::sort
+    (
+        entries.begin(), 
+        entries.end(), 
+        [&error](const auto& a, const auto& b)
+        {
+            return a.last_write_time(error) < b.last_write_time(error);
+        }
+    );
+    for (const auto& entry : entries)
+    {
+        if (size <= binaryCacheMaxSize_)
+            break;
+        uint64_t entrySize = entry.file_size(error);
+        if (std::filesystem::remove(entry.path(), error))
+            size -= std::min(entrySize, size);
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+void OpenGLShader::setActiveResourceStatistics()
+{
+    GLint nUniforms = 0;
+    if (GLAD_GL_VERSION_4_3 || GLAD_GL_ARB_program_interface_query)
+        glGetProgramInterfaceiv
+        (
+            id_, 
+            GL_UNIFORM, 
+            GL_ACTIVE_RESOURCES, 
+            &nUniforms
+        );
+    else
+        glGetProgramiv(id_, GL_ACTIVE_UNIFORMS, &nUniforms);
+    statistics_.nActiveUniforms = nUniforms;
+    statistics_.nActiveSamplers = 0;
+    for (GLuint index = 0; index < (GLuint)nUniforms; index++)
+    {
+        GLint type = 0;
+        glGetActiveUniformsiv(id_, 1, &index, GL_UNIFORM_TYPE, &type);
+        switch (type)
+        {
+            case GL_SAMPLER_2D :
+            case GL_SAMPLER_3D :
+            case GL_SAMPLER_CUBE :
+            case GL_SAMPLER_2D_ARRAY :
+            case GL_INT_SAMPLER_2D :
+            case GL_INT_SAMPLER_3D :
+            case GL_INT_SAMPLER_CUBE :
+            case GL_UNSIGNED_INT_SAMPLER_2D :
+            case GL_UNSIGNED_INT_SAMPLER_3D :
+            case GL_UNSIGNED_INT_SAMPLER_CUBE :
+                ++statistics_.nActiveSamplers;
+                break;
+            default :
+                break;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+bool OpenGLShader::loadBinary(const std::string& filepath)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file.is_open())
+        return false;
+    GLenum format;
+    file.read((char*)&format, sizeof(format));
+    std::vector<char> binary
+    (
+        (std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>()
+    );
+    file.close();
+    GLint linked = GL_FALSE;
+    if (!binary.empty())
+    {
+        id_ = glCreateProgram();
+        glProgramBinary(id_, format, binary.data(), (GLsizei)binary.size());
+        glGetProgramiv(id_, GL_LINK_STATUS, &linked);
+    }
+    std::error_code error;
+    if (linked == GL_FALSE)
+    {
+        if (!binary.empty())
+            glDeleteProgram(id_);
+        id_ = 0;
+        std::filesystem::remove(filepath, error);
+        return false;
+    }
+    std::filesystem::last_write_time
+    (
+        filepath, 
+        std::filesystem::file_time_type::clock::now(), 
+        error
+    );
+    return true;
+}
+
+//----------------------------------------------------------------------------//
+
+void OpenGLShader::storeBinary(const std::string& filepath) const
+{
+    GLint linked = GL_FALSE;
+    glGetProgramiv(id_, GL_LINK_STATUS, &linked);
+    GLint size = 0;
+    glGetProgramiv(id_, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (linked == GL_FALSE || size <= 0)
+        return;
+    std::vector<char> binary(size);
+    GLenum format;
+    glGetProgramBinary(id_, size, &size, &format, binary.data());
+    // Written to a temporary file first, so that other instances never read
+    // a partially written binary
+    std::string tmpFilepath = filepath+".tmp";
+    {
+        std::ofstream file(tmpFilepath, std::ios::binary);
+        if (!file.is_open())
+            return;
+        file.write((const char*)&format, sizeof(format));
+        file.write(binary.data(), size);
+        if (!file.good())
+            return;
+    }
+    std::error_code error;
+    std::filesystem::rename(tmpFilepath, filepath, error);
+    if (error)
+    {
+        std::filesystem::remove(tmpFilepath, error);
+        return;
+    }
+    evictBinaries();
+}
+
 // Public member functions ---------------------------------------------------//
 
 OpenGLShader::OpenGLShader
 (
     const std::string& vertextShaderSource,
     const std::string& fragmentShaderSource,
-    OpenGLShader::ConstructFrom cf
+    OpenGLShader::ConstructFrom cf,
+    bool async
 )
 {
     static bool currentContextExtensionStatusMapInitialized = false;
@@ -138,8 +345,72 @@ OpenGLShader::OpenGLShader
         currentContextExtensionStatusMapInitialized = true;
     }
 
+    typedef std::chrono::steady_clock Clock;
+    auto secondsSince = [](const Clock::time_point& start)
+    {
+        return std::chrono::duration<double>(Clock::now()-start).count();
+    };
+    if (cf == ConstructFrom::SourceCode)
+        statistics_.sourceLength = 
+            vertextShaderSource.size()+fragmentShaderSource.size();
+
+    std::string binaryFilepath;
+    if 
+    (
+        cf == ConstructFrom::SourceCode && 
+        !binaryCacheDirectory_.empty() && 
+        isBinaryCacheSupported()
+    )
+    {
+        binaryFilepath = binaryCacheFilepath
+        (
+            vertextShaderSource, 
+            fragmentShaderSource
+        );
+        auto start = Clock::now();
+        if (loadBinary(binaryFilepath))
+        {
+            statistics_.linkTime = secondsSince(start);
+            statistics_.isFromBinaryCache = true;
+            setActiveResourceStatistics();
+            return;
+        }
+    }
+
+    // Asynchronous compilation, whose status is polled by isCompiling(), with
+    // the link already requested so that it also happens in the background
+    if 
+    (
+        async && 
+        cf == ConstructFrom::SourceCode && 
+        isAsyncCompilationSupported()
+    )
+    {
+        compileStartTime_ = Clock::now();
+        statistics_.isAsync = true;
+        vertexShader_ = 
+            submitShaderSource(vertextShaderSource, GL_VERTEX_SHADER);
+        fragmentShader_ = 
+            submitShaderSource(fragmentShaderSource, GL_FRAGMENT_SHADER);
+        id_ = glCreateProgram();
+        glAttachShader(id_, vertexShader_);
+        glAttachShader(id_, fragmentShader_);
+        if (!binaryFilepath.empty())
+            glProgramParameteri
+            (
+                id_, 
+                GL_PROGRAM_BINARY_RETRIEVABLE_HINT, 
+                GL_TRUE
+            );
+        glLinkProgram(id_);
+        binaryFilepath_ = binaryFilepath;
+        isCompiling_ = true;
+        return;
+    }
+
     unsigned int vertexShader = 0;
     unsigned int fragmentShader = 0;
+    auto start = Clock::now();
     switch(cf)
     {
         case ConstructFrom::SourceFile :
@@ -175,12 +446,28 @@ OpenGLShader::OpenGLShader
             break;
         }
     }
+    statistics_.compileTime = secondsSince(start);
     if (valid())
     {
         id_ = glCreateProgram();
         glAttachShader(id_, vertexShader);
         glAttachShader(id_, fragmentShader);
+        if (!binaryFilepath.empty())
+            glProgramParameteri
+            (
+                id_, 
+                GL_PROGRAM_BINARY_RETRIEVABLE_HINT, 
+                GL_TRUE
+            );
+        start = Clock::now();
         glLinkProgram(id_);
+        // Querying the status waits for the link to complete
+        GLint linked;
+        glGetProgramiv(id_, GL_LINK_STATUS, &linked);
+        statistics_.linkTime = secondsSince(start);
+        setActiveResourceStatistics();
+        if (!binaryFilepath.empty())
+            storeBinary(binaryFilepath);
     }
     /*GLint valid;
     glGetProgramiv(id_, GL_COMPILE_STATUS, &valid);
@@ -201,6 +488,44 @@ OpenGLShader::OpenGLShader
 OpenGLShader::~OpenGLShader()
 {
     glDeleteProgram(id_);
+    if (!isCompiling_)
+        return;
+    glDeleteShader(fragmentShader_);
+    glDeleteShader(vertexShader_);
+}
+
+bool OpenGLShader::isCompiling()
+{
+    if (!isCompiling_)
+        return false;
+    GLint isComplete = GL_FALSE;
+    glGetProgramiv(id_, GL_COMPLETION_STATUS_KHR, &isComplete);
+    if (isComplete == GL_FALSE)
+        return true;
+    isCompiling_ = false;
+    statistics_.compileTime = std::chrono::duration<double>
+    (
+        std::chrono::steady_clock::now()-compileStartTime_
+    ).count();
+    std::string log;
+    checkValidShader(vertexShader_, log);
+    parseCompilationErrorLog(log, compilationErrors_.vertexErrors);
+    checkValidShader(fragmentShader_, log);
+    parseCompilationErrorLog(log, compilationErrors_.fragmentErrors);
+    if (!valid())
+    {
+        glDeleteProgram(id_);
+        id_ = 0;
+    }
+    else
+    {
+        setActiveResourceStatistics();
+        if (!binaryFilepath_.empty())
+            storeBinary(binaryFilepath_);
+    }
+    glDeleteShader(fragmentShader_);
+    glDeleteShader(vertexShader_);
+    return false;
 }
 
 void OpenGLShader::bind() const
@@ -368,6 +693,20 @@ std::string OpenGLShader::currentContextShadingLanguageDirectives()
     return directives;
 }
 
+bool OpenGLShader::isAsyncCompilationSupported()
+{
+    static bool isSupported = [](){
+        if (GLAD_GL_KHR_parallel_shader_compile)
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        else if (GLAD_GL_ARB_parallel_shader_compile)
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        else
+            return false;
+        return true;
+    }();
+    return isSupported;
+}
+
 bool OpenGLShader::setExtensionStatusInCurrentContextShadingLanguageDirectives
 (
     const std::string& extensionName,
@@ -115,6 +115,9 @@ std::vector<std::string> Shader::uniformNames =
 std::unordered_map<std::string, bool> 
     Shader::currentContextExtensionsStatusMap_ = {};
 
+std::string Shader::binaryCacheDirectory_ = "";
+uint64_t Shader::binaryCacheMaxSize_ = 0;
+
 Shader::Uniform::~Uniform()
 {
     resetValue();
@@ -193,7 +196,8 @@ Shader* Shader::create
 (
     const std::string& vs, 
     const std::string& fs, 
-    ConstructFrom cf
+    ConstructFrom cf,
+    bool async
 )
 {
     Window* window = nullptr;
@@ -202,7 +206,7 @@ Shader* Shader::create
     switch(window->context()->type())
     {
         case (GraphicsContext::Type::OpenGL) :
-            return new OpenGLShader(vs, fs, cf);
+            return new OpenGLShader(vs, fs, cf, async);
     }
     return nullptr;
 }
@@ -221,6 +225,18 @@ std::string Shader::currentContextShadingLanguageDirectives()
     }
 }
 
+bool Shader::isAsyncCompilationSupported()
+{
+    static auto* context = vir::GlobalPtr<vir::Window>::instance()->context();
+    switch (context->type())
+    {
+    case GraphicsContext::Type::OpenGL :
+        return OpenGLShader::isAsyncCompilationSupported();
+    default:
+        return false;
+    }
+}
+
 bool Shader::setExtensionStatusInCurrentContextShadingLanguageDirectives
 (
     const std::string& extensionName,
@@ -270,4 +286,20 @@ Shader::extensionsInCurrentContextShadingLanguageDirectives()
     return extensions;
 }
 
+void Shader::setBinaryCache
+(
+    const std::string& directory, 
+    uint64_t maxSize
+)
+{
+    binaryCacheDirectory_ = directory;
+    binaryCacheMaxSize_ = maxSize;
+    if (directory.empty())
+        return;
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+        binaryCacheDirectory_.clear();
+}
+
 }
\ No newline at end of file
@@ -14,6 +14,200 @@ GifEncoder::paletteModeToName =
 
 // Protected functions -------------------------------------------------------//
 
+GifEncoder::LZWEncoder::LZWEncoder():
+    generation_(0)
+{}
+
+void GifEncoder::LZWEncoder::resetCodeTree()
+{
+    // Only clear the whole tree on first use or on (very unlikely) generation
+    // counter overflow, otherwise stale nodes are cleared lazily in encode
+    if (codeTree_.empty())
+        codeTree_.resize(4096);
+    if (++generation_ == 0)
+    {
+        for (auto& node : codeTree_)
+            node.generation = 0;
+        generation_ = 1;
+    }
+}
+
+void GifEncoder::LZWEncoder::encode
+(
+    const unsigned char* indices,
+    uint32_t stride,
+    uint32_t width,
+    uint32_t height,
+    bool flipVertically,
+    const unsigned char* indexMap,
+    uint32_t minCodeSize,
+    std::vector<unsigned char>& output
+)
+{
+    // The LZW scheme is that of https://github.com/charlietangora/gif-h, much
+    // appreciated (licensed under the "Unlicense" license). Each pixel yields
+    // at most one code of at most 12 bits, and a clear code is emitted at most
+    // every ~3800 codes, so that 2 bytes per pixel are always sufficient
+    codeStream_.resize(2*(size_t)width*height+64);
+    unsigned char* stream = codeStream_.data();
+    uint64_t bitBuffer = 0;
+    uint32_t nBits = 0;
+    auto writeCode = [&](uint32_t code, uint32_t length)
+    {
+        bitBuffer |= (uint64_t)code << nBits;
+        nBits += length;
+        if (nBits >= 32)
+        {
+            stream[0] = bitBuffer & 0xff;
+            stream[1] = (bitBuffer >> 8) & 0xff;
+            stream[2] = (bitBuffer >> 16) & 0xff;
+            stream[3] = (bitBuffer >> 24) & 0xff;
+            stream += 4;
+            bitBuffer >>= 32;
+            nBits -= 32;
+        }
+    };
+
+    const uint32_t clearCode = 1 << minCodeSize;
+    uint32_t codeSize = minCodeSize + 1;
+    uint32_t maxCode = clearCode + 1;
+    int32_t curCode = -1;
+    resetCodeTree();
+    writeCode(clearCode, codeSize);
+    for (uint32_t y=0; y<height; ++y)
+    {
+        const unsigned char* row = 
+            indices + (size_t)(flipVertically ? height-1-y : y)*stride;
+        for (uint32_t x=0; x<width; ++x)
+        {
+            uint8_t nextValue = indexMap[row[x]];
+            if (curCode < 0)
+            {
+                curCode = nextValue;
+                continue;
+            }
+            Node& node = codeTree_[curCode];
+            if (node.generation == generation_ && node.next[nextValue])
+            {
+                curCode = node.next[nextValue];
+                continue;
+            }
+            writeCode((uint32_t)curCode, codeSize);
+            if (node.generation != generation_)
+            {
+                memset(node.next, 0, sizeof(node.next));
+                node.generation = generation_;
+            }
+            node.next[nextValue] = (uint16_t)++maxCode;
+            if (maxCode >= (1u << codeSize))
+                codeSize++;
+            if (maxCode == 4095)
+            {
+                writeCode(clearCode, codeSize);
+                resetCodeTree();
+                codeSize = minCodeSize + 1;
+                maxCode = clearCode + 1;
+            }
+            curCode = nextValue;
+        }
+    }
+    writeCode((uint32_t)curCode, codeSize);
+    writeCode(clearCode, codeSize);
+    writeCode(clearCode + 1, minCodeSize + 1);
+    while (nBits > 0) // Last byte is zero-padded
+    {
+        *(stream++) = bitBuffer & 0xff;
+        bitBuffer >>= 8;
+        nBits = nBits > 8 ? nBits-8 : 0;
+    }
+
+    // Split the code stream in data sub-blocks of up to 255 bytes, each 
+    // preceeded by its size
+    size_t size = stream - codeStream_.data();
+    output.reserve(output.size() + size + size/255 + 1);
+    for (size_t i=0; i<size; i+=255)
+    {
+        size_t blockSize = std::min(size-i, (size_t)255);
+        output.push_back((unsigned char)blockSize);
+        output.insert
+        (
+            output.end(), 
+            codeStream_.data()+i, 
+            codeStream_.data()+i+blockSize
+        );
+    }
+}
+
+GifEncoder::Region GifEncoder::findUpdatedRegion() const
+{
+    // Pixels left unchanged since the previous frame are marked by the
+    // quantizer with the reserved index paletteSize_. Rows are scanned 8 
+    // indices at a time by comparing them against a word filled with the
+    // reserved index, and only the side portions of rows not yet known to be
+    // within the region are scanned once the top and bottom rows are found
+    const unsigned char unchanged = (unsigned char)paletteSize_;
+    const uint64_t unchangedWord = 0x0101010101010101ull*unchanged;
+    auto firstChanged = [&](const unsigned char* row, uint32_t x, uint32_t end)
+    {
+        for (; x+8<=end; x+=8)
+        {
+            uint64_t word;
+            memcpy(&word, row+x, 8);
+            if (word != unchangedWord)
+                break;
+        }
+        for (; x<end; x++)
+            if (row[x] != unchanged)
+                return x;
+        return end;
+    };
+    auto lastChanged = [&](const unsigned char* row, uint32_t begin, uint32_t x)
+    {
+        // Returns one past the last changed index in [begin, x), or begin
+        for (; x>=begin+8; x-=8)
+        {
+            uint64_t word;
+            memcpy(&word, row+x-8, 8);
+            if (word != unchangedWord)
+                break;
+        }
+        for (; x>begin; x--)
+            if (row[x-1] != unchanged)
+                return x;
+        return begin;
+    };
+    
+    uint32_t y0 = 0;
+    uint32_t x0 = width_;
+    for (; y0<height_; y0++)
+    {
+        x0 = firstChanged(indexedTexture_+y0*width_, 0, width_);
+        if (x0 < width_)
+            break;
+    }
+    // Nothing changed, but a 1x1 region is still required to encode the delay
+    if (y0 == height_)
+        return {0, 0, 1, 1};
+    uint32_t y1 = height_;
+    for (; y1>y0+1; y1--)
+        if (firstChanged(indexedTexture_+(y1-1)*width_, 0, width_) < width_)
+            break;
+    uint32_t x1 = lastChanged(indexedTexture_+y0*width_, x0, width_);
+    for (uint32_t y=y0; y<y1; y++)
+    {
+        const unsigned char* row = indexedTexture_+y*width_;
+        x0 = std::min(x0, firstChanged(row, 0, x0));
+        x1 = std::max(x1, lastChanged(row, x1, width_));
+    }
+    return {x0, y0, x1-x0, y1-y0};
+}
+
+void GifEncoder::writeBytes(const char* bytes)
+{
+    while (*bytes)
+        writeByte(*(bytes++));
+}
+
 void GifEncoder::writePaletteData()
 {
     if (file_ == nullptr || palette_ == nullptr)
@@ -22,16 +216,16 @@ void GifEncoder::writePaletteData()
     // Write dummy color which will be used for transparency only
     if (indexMode_ != Quantizer::Settings::IndexMode::Default)
     {
-        fputc(0, file_);
-        fputc(0, file_);
-        fputc(0, file_);
+        writeByte(0);
+        writeByte(0);
+        writeByte(0);
     }
     // Write palette data
     for(uint32_t i=0; i<paletteSize_; i++)
     {
-        fputc((int)palette_[3*i], file_);
-        fputc((int)palette_[3*i+1], file_);
-        fputc((int)palette_[3*i+2], file_);
+        writeByte(palette_[3*i]);
+        writeByte(palette_[3*i+1]);
+        writeByte(palette_[3*i+2]);
     }
 
     // Pad palette if necessary. This only happens if 
@@ -42,9 +236,9 @@ void GifEncoder::writePaletteData()
     int ps = paletteSize_;
     while (ps < ((1<<paletteBitDepth_)-1))
     {
-        fputc(0, file_);
-        fputc(0, file_);
-        fputc(0, file_);
+        writeByte(0);
+        writeByte(0);
+        writeByte(0);
         ++ps;
     }
 }
@@ -61,13 +255,13 @@ void GifEncoder::encodeIndexedFrame
         // specification at https://www.w3.org/Graphics/GIF/spec-gif89a.txt
 
         // 17. HEADER, bytes 0-2 "GIF", bytes 3-5 "89a" ------------------------
-        fputs("GIF89a", file_);
+        writeBytes("GIF89a");
 
         // 18. LOGICAL SCREEN DESCRIPTOR, bytes 0-3 ----------------------------
-        fputc(width_ & 0xff, file_);
-        fputc((width_ >> 8) & 0xff, file_);
-        fputc(height_ & 0xff, file_);
-        fputc((height_ >> 8) & 0xff, file_);
+        writeByte(width_ & 0xff);
+        writeByte((width_ >> 8) & 0xff);
+        writeByte(height_ & 0xff);
+        writeByte((height_ >> 8) & 0xff);
         
         // Byte 4 of LOGICAL SCREEN DESCRIPTOR
         uint8_t packedFields = 0;
@@ -80,10 +274,10 @@ void GifEncoder::encodeIndexedFrame
                                                   // global palette
             packedFields |= ((paletteBitDepth_-1) << 0);
 
-        fputc(packedFields, file_);
-        fputc(0, file_); // Byte 5, background color index (always 0 in my
-                         // setup)
-        fputc(0, file_); // Byte 6, '0' means square pixel aspect ratio
+        writeByte(packedFields);
+        writeByte(0); // Byte 5, background color index (always 0 in my
+                      // setup)
+        writeByte(0); // Byte 6, '0' means square pixel aspect ratio
         
         // 19. GLOBAL COLOR TABLE ----------------------------------------------
         if (paletteMode_ != PaletteMode::Dynamic)
@@ -98,73 +292,79 @@ void GifEncoder::encodeIndexedFrame
              // though). So I keep the global color table just in case
         {
             for (int i=0; i<6; i++)
-                fputc(0, file_);
+                writeByte(0);
         }
 
         // 26. APPLICATION EXTENSION -------------------------------------------
-        fputc(0x21, file_); // EXTENSION INTRODUCER (fixed value, 0x21)
-        fputc(0xff, file_); // EXTENSION LABEL (fixed value, 0xff)
-        fputc(11, file_); // EXTENSION SIZE (fixed value, 11)
-        fputs("ANIMEXTS1.0", file_); // APPLICATION IDENTIFIER (ANIMEXTS) and
-                                     // AUTHENTICATION CODE for animated GIFs,
-                                     // (same as NETSCAPE2.0)
-        fputc(3, file_); // Size of ANIMEXTS1 APPLICATION DATA (3 bytes)
-        fputc(1, file_); // Byte 0 of ANIMEXTS data, 1 -> looping on
-        fputc(0, file_); // Bytes 1,2 of ANIMEXTS data, 00 -> loop infinitely
-        fputc(0, file_);
-        fputc(0, file_); // Block terminator
+        writeByte(0x21); // EXTENSION INTRODUCER (fixed value, 0x21)
+        writeByte(0xff); // EXTENSION LABEL (fixed value, 0xff)
+        writeByte(11); // EXTENSION SIZE (fixed value, 11)
+        writeBytes("ANIMEXTS1.0"); // APPLICATION IDENTIFIER (ANIMEXTS) and
+                                   // AUTHENTICATION CODE for animated GIFs,
+                                   // (same as NETSCAPE2.0)
+        writeByte(3); // Size of ANIMEXTS1 APPLICATION DATA (3 bytes)
+        writeByte(1); // Byte 0 of ANIMEXTS data, 1 -> looping on
+        writeByte(0); // Bytes 1,2 of ANIMEXTS data, 00 -> loop infinitely
+        writeByte(0);
+        writeByte(0); // Block terminator
     }
 
     // 23. GRAPHIC CONTROL EXTENSION preceeding the image descriptor -----------
-    fputc(0x21, file_); // Byte 0, EXTENSION INTRODUCER (fixed value)
-    fputc(0xf9, file_); // Byte 1, GRAPHIC CONTROL LABEL (fixed value)
-                        // Byte 2, BLOCK SIZE
-    fputc(0x04, file_); 
+    writeByte(0x21); // Byte 0, EXTENSION INTRODUCER (fixed value)
+    writeByte(0xf9); // Byte 1, GRAPHIC CONTROL LABEL (fixed value)
+                     // Byte 2, BLOCK SIZE
+    writeByte(0x04); 
 
     // Byte 3 - packed data
     switch(indexMode_)
     {
         case Quantizer::Settings::IndexMode::Default :
-            fputc(0b00001000, file_);   // Old frame reset to no color,
-                                        // no transparency
+            writeByte(0b00001000);  // Old frame reset to no color,
+                                    // no transparency
             break;
         case Quantizer::Settings::IndexMode::Alpha :
-            fputc(0b00001001, file_);   // Old frame reset to no color, 
-                                        // enable transparency
+            writeByte(0b00001001);  // Old frame reset to no color, 
+                                    // enable transparency
             break;
         case Quantizer::Settings::IndexMode::Delta :
-            fputc(0b00000101, file_);   // Old frame left in place, 
-                                        // enable transparency
+            writeByte(0b00000101);  // Old frame left in place, 
+                                    // enable transparency
             break;
     }
     
     // Bytes 4,5 - delay
-    fputc(delay & 0xff, file_);
-    fputc((delay >> 8) & 0xff, file_);
+    writeByte(delay & 0xff);
+    writeByte((delay >> 8) & 0xff);
     
     // Byte 6 - transparent color palette index (even if not applicable)
-    fputc(0, file_);
+    writeByte(0);
     
-    fputc(0, file_); // Block terminator for GRAPHIC CONTROL EXTENSION
+    writeByte(0); // Block terminator for GRAPHIC CONTROL EXTENSION
 
     // 20. IMAGE DESCRIPTOR BLOCK ----------------------------------------------
-    // A lot of optimizations might be implemented acting here, as I could e.g.,
-    // only write the actual region of the GIF which has been updated, compared
-    // to the previous frame. I am not doing this, presently
-
-    fputc(0x2c, file_); // IMAGE SEPARATOR (fixed value, 0x2c)
-    fputc(0 & 0xff, file_); // IMAGE POSITION (i.e., coordinates of the top-left
-                            // image corner with respect to an origin at the 
-                            // top-left GIF corder; bytes 0,1 are for the 
-                            // horizontal offset, bytes 2,3 for the vertical one
-    fputc((0 >> 8) & 0xff, file_);
-    fputc(0 & 0xff, file_);
-    fputc((0 >> 8) & 0xff, file_);
-
-    fputc(width_ & 0xff, file_); // IMAGE WIDTH (bytes 4-5)
-    fputc((width_ >> 8) & 0xff, file_);
-    fputc(height_ & 0xff, file_); // IMAGE HEIGHT (bytes 6-7)
-    fputc((height_ >> 8) & 0xff, file_);
+    // In delta mode, only the region of the GIF which has been updated compared
+    // to the previous frame is written (the first frame is always written in
+    // full). The region is expressed in indexedTexture_ coordinates first
+    Region region = {0, 0, width_, height_};
+    if (indexMode_ == Quantizer::Settings::IndexMode::Delta && !firstFrame_)
+        region = findUpdatedRegion();
+    uint32_t top = 
+        flipVertically ? height_-region.y-region.height : region.y;
+
+    writeByte(0x2c); // IMAGE SEPARATOR (fixed value, 0x2c)
+    writeByte(region.x & 0xff); // IMAGE POSITION (i.e., coordinates of the 
+                                // top-left image corner with respect to an 
+                                // origin at the top-left GIF corder; bytes 0,1
+                                // are for the horizontal offset, bytes 2,3 for
+                                // the vertical one
+    writeByte((region.x >> 8) & 0xff);
+    writeByte(top & 0xff);
+    writeByte((top >> 8) & 0xff);
+
+    writeByte(region.width & 0xff); // IMAGE WIDTH (bytes 4-5)
+    writeByte((region.width >> 8) & 0xff);
+    writeByte(region.height & 0xff); // IMAGE HEIGHT (bytes 6-7)
+    writeByte((region.height >> 8) & 0xff);
 
     uint8_t packedFields = 0;
     if (paletteMode_ == PaletteMode::Dynamic)
@@ -174,117 +374,204 @@ void GifEncoder::encodeIndexedFrame
                                   // to OFF, while bits 4,3 are reserved and
                                   // should not be set
         packedFields += paletteBitDepth_-1;// Bits 2,1,0 are log2(paletteSize)-1
-        fputc(packedFields, file_);
+        writeByte(packedFields);
         // 21. LOCAL COLOR TABLE -----------------------------------------------
         writePaletteData();
     }
     else
-        fputc(packedFields, file_); // No local color table
+        writeByte(packedFields); // No local color table
 
-    const int minCodeSize = paletteBitDepth_;
-    const uint32_t clearCode = 1 << paletteBitDepth_;
-    fputc(paletteBitDepth_, file_);
+    writeByte(paletteBitDepth_); // LZW minimum code size
     
     // 22. TABLE BASED IMAGE DATA ----------------------------------------------
-    // This is pure magic I took from https://github.com/charlietangora/gif-h,
-    // much appreciated (licensed under the "Unlicense" license)
-
-    GifLZWNode* codetree = (GifLZWNode*)malloc(sizeof(GifLZWNode)*4096);
-    memset(codetree, 0, sizeof(GifLZWNode)*4096);
-    int32_t curCode = -1;
-    uint32_t codeSize = (uint32_t)minCodeSize + 1;
-    uint32_t maxCode = clearCode+1;
-    GifBitStatus stat;
-    stat.byte = 0;
-    stat.bitIndex = 0;
-    stat.chunkIndex = 0;
-
-    auto GifWriteBit = [](GifBitStatus* stat, uint32_t bit)
+    if (!workers_.empty())
     {
-        bit = bit & 1;
-        bit = bit << stat->bitIndex;
-        stat->byte |= bit;
-        ++stat->bitIndex;
-        if( stat->bitIndex > 7 )
+        // Wait for a free job slot, then hand the frame indices and the frame
+        // header assembled so far to the workers
+        FrameJob* job = nullptr;
         {
-            stat->chunk[stat->chunkIndex++] = stat->byte;
-            stat->bitIndex = 0;
-            stat->byte = 0;
+            std::unique_lock<std::mutex> lock(jobsMutex_);
+            jobWritten_.wait
+            (
+                lock, 
+                [&]
+                {
+                    return 
+                        !freeJobs_.empty() || 
+                        nJobs_ < maxFramesInFlight_;
+                }
+            );
+            if (freeJobs_.empty())
+            {
+                job = new FrameJob();
+                ++nJobs_;
+            }
+            else
+            {
+                job = freeJobs_.back();
+                freeJobs_.pop_back();
+            }
         }
-    };
+        // Only the indices of the region to be encoded are stored
+        job->indices.resize(region.width*region.height);
+        for (uint32_t y=0; y<region.height; y++)
+            memcpy
+            (
+                job->indices.data()+y*region.width,
+                indexedTexture_+(region.y+y)*width_+region.x,
+                region.width
+            );
+        job->width = region.width;
+        job->height = region.height;
+        job->flipVertically = flipVertically;
+        job->isEncoded = false;
+        std::swap(job->data, frameData_);
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex_);
+            pendingJobs_.push_back(job);
+            inFlightJobs_.push_back(job);
+        }
+        jobAvailable_.notify_one();
+        return;
+    }
+    auto start = EncoderStats::Clock::now();
+    lzwEncoder_.encode
+    (
+        indexedTexture_+region.y*width_+region.x, 
+        width_,
+        region.width, 
+        region.height, 
+        flipVertically, 
+        indexMap_, 
+        paletteBitDepth_, 
+        frameData_
+    );
+    stats_.record
+    (
+        EncoderStats::Stage::Encoding, 
+        EncoderStats::secondsSince(start)
+    );
 
-    auto GifWriteChunk = [](FILE* file, GifBitStatus* stat)
-    {
-        fputc((int)stat->chunkIndex, file);
-        fwrite(stat->chunk, 1, stat->chunkIndex, file);
-        stat->bitIndex = 0;
-        stat->byte = 0;
-        stat->chunkIndex = 0;
-    };
+    // Image block terminator for TABLE BASED IMAGE DATA
+    writeByte(0);
 
-    auto GifWriteCode = [GifWriteBit, GifWriteChunk]
+    // Flush the whole frame to file at once
+    start = EncoderStats::Clock::now();
+    fwrite(frameData_.data(), 1, frameData_.size(), file_);
+    stats_.record
     (
-        FILE* file, 
-        GifBitStatus* stat, 
-        uint32_t code, 
-        uint32_t length
-    )
+        EncoderStats::Stage::Writing, 
+        EncoderStats::secondsSince(start)
+    );
+    stats_.recordBytesWritten(frameData_.size());
+    frameData_.clear();
+}
+
+void GifEncoder::startWorkers()
+{
+    stopWorkers_ = false;
+    for (unsigned int i=0; i<nWorkers_; i++)
+        workers_.emplace_back(&GifEncoder::workerLoop, this);
+}
+
+void GifEncoder::stopWorkers()
+{
+    if (workers_.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex_);
+        stopWorkers_ = true;
+    }
+    jobAvailable_.notify_all();
+    // Workers only quit once all pending jobs have been compressed, and the
+    // last worker to finish also writes any remaining frames to file
+    for (auto& worker : workers_)
+        worker.join();
+    workers_.clear();
+    for (auto job : freeJobs_)
+        delete job;
+    freeJobs_.clear();
+    nJobs_ = 0;
+}
+
+void GifEncoder::workerLoop()
+{
+    // Each worker has its own code tree and code stream, re-used across frames
+    LZWEncoder lzwEncoder;
+    while (true)
     {
-        for( uint32_t ii=0; ii<length; ++ii )
+        FrameJob* job = nullptr;
         {
-            GifWriteBit(stat, code);
-            code = code >> 1;
-            if( stat->chunkIndex == 255 )
-                GifWriteChunk(file, stat);
+            std::unique_lock<std::mutex> lock(jobsMutex_);
+            jobAvailable_.wait
+            (
+                lock, 
+                [&]{return stopWorkers_ || !pendingJobs_.empty();}
+            );
+            if (pendingJobs_.empty())
+                return;
+            job = pendingJobs_.front();
+            pendingJobs_.pop_front();
         }
-    };
+        auto start = EncoderStats::Clock::now();
+        lzwEncoder.encode
+        (
+            job->indices.data(),
+            job->width,
+            job->width,
+            job->height,
+            job->flipVertically,
+            indexMap_,
+            paletteBitDepth_,
+            job->data
+        );
+        stats_.record
+        (
+            EncoderStats::Stage::Encoding, 
+            EncoderStats::secondsSince(start)
+        );
+        job->data.push_back(0); // Image block terminator
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex_);
+            job->isEncoded = true;
+        }
+        writeEncodedFrames();
+    }
+}
 
-    GifWriteCode(file_, &stat, clearCode, codeSize);
-    for(uint32_t y=0; y<height_; ++y)
+void GifEncoder::writeEncodedFrames()
+{
+    // Holding the file lock while collecting the ready jobs guarantees that
+    // frames are written in order even if multiple workers get here at once
+    std::lock_guard<std::mutex> fileLock(fileMutex_);
+    std::vector<FrameJob*> jobs;
     {
-        for(uint32_t x=0; x<width_; ++x)
+        std::lock_guard<std::mutex> lock(jobsMutex_);
+        while (!inFlightJobs_.empty() && inFlightJobs_.front()->isEncoded)
         {
-            uint8_t nextValue = indexedTexture_
-            [
-                flipVertically ? (height_-1-y)*width_+x : y*width_+x
-            ];
-            if (indexMode_ != Quantizer::Settings::IndexMode::Default)
-            {
-                if (nextValue == paletteSize_)
-                    nextValue = 0;
-                else
-                    ++nextValue;
-            }
-            if( curCode < 0 )
-                curCode = nextValue;
-            else if( codetree[curCode].next[nextValue] )
-                curCode = codetree[curCode].next[nextValue];
-            else
-            {
-                GifWriteCode(file_, &stat, (uint32_t)curCode, codeSize);
-                codetree[curCode].next[nextValue] = (uint16_t)++maxCode;
-                if( maxCode >= (1ul << codeSize) )
-                    codeSize++;
-                if( maxCode == 4095 )
-                {
-                    GifWriteCode(file_, &stat, clearCode, codeSize);
-                    memset(codetree, 0, sizeof(GifLZWNode)*4096);
-                    codeSize = (uint32_t)(minCodeSize + 1);
-                    maxCode = clearCode+1;
-                }
-                curCode = nextValue;
-            }
+            jobs.push_back(inFlightJobs_.front());
+            inFlightJobs_.pop_front();
         }
     }
-    GifWriteCode(file_, &stat, (uint32_t)curCode, codeSize);
-    GifWriteCode(file_, &stat, clearCode, codeSize);
-    GifWriteCode(file_, &stat, clearCode + 1, (uint32_t)minCodeSize + 1);
-    while( stat.bitIndex ) GifWriteBit(&stat, 0);
-    if( stat.chunkIndex ) GifWriteChunk(file_, &stat);
-
-    // Image block terminator for TABLE BASED IMAGE DATA
-    fputc(0, file_); 
-    free(codetree);
+    if (jobs.empty())
+        return;
+    for (auto job : jobs)
+    {
+        auto start = EncoderStats::Clock::now();
+        fwrite(job->data.data(), 1, job->data.size(), file_);
+        stats_.record
+        (
+            EncoderStats::Stage::Writing, 
+            EncoderStats::secondsSince(start)
+        );
+        stats_.recordBytesWritten(job->data.size());
+        job->data.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex_);
+        freeJobs_.insert(freeJobs_.end(), jobs.begin(), jobs.end());
+    }
+    jobWritten_.notify_all();
 }
 
 // Public functions ----------------------------------------------------------//
@@ -298,14 +585,52 @@ GifEncoder::GifEncoder():
     paletteSize_(0),
     frameCounter_(0),
     paletteMode_(PaletteMode::Dynamic),
-    indexMode_(IndexMode::Default)
+    indexMode_(IndexMode::Default),
+    quantizer_(nullptr),
+    quantizerDevice_(Quantizer::Device::GPU),
+    isGPUQuantizerAvailable_(true)
 {
-    quantizer_ = Quantizer::create();
+    setQuantizerDevice(Quantizer::Device::GPU);
 }
 
 GifEncoder::~GifEncoder()
 {
+    stopWorkers();
+    delete quantizer_;
+}
+
+void GifEncoder::setQuantizerDevice(Quantizer::Device device)
+{
+    if (file_ != nullptr)
+        return;
+    if (device == Quantizer::Device::GPU && !isGPUQuantizerAvailable_)
+        device = Quantizer::Device::CPU;
+    if (quantizer_ != nullptr && device == quantizerDevice_)
+        return;
     delete quantizer_;
+    quantizer_ = Quantizer::create(device);
+    if 
+    (
+        device == Quantizer::Device::GPU && 
+        !quantizer_->canRunOnDeviceInUse()
+    )
+    {
+        isGPUQuantizerAvailable_ = false;
+        delete quantizer_;
+        device = Quantizer::Device::CPU;
+        quantizer_ = Quantizer::create(device);
+    }
+    quantizerDevice_ = device;
+}
+
+void GifEncoder::setAsyncEncoding
+(
+    unsigned int nWorkers, 
+    unsigned int maxFramesInFlight
+)
+{
+    nWorkers_ = nWorkers;
+    maxFramesInFlight_ = std::max(maxFramesInFlight, 1u);
 }
 
 bool GifEncoder::openFile
@@ -326,6 +651,8 @@ bool GifEncoder::openFile
     #endif
     if(!file_ || paletteBitDepth < 1 || width*height == 0) 
         return false;
+    stopWorkers();
+    startWorkers();
 
     width_ = width;
     height_ = height;
@@ -346,6 +673,17 @@ bool GifEncoder::openFile
             paletteSize_ -= 1;
     }
 
+    // The quantizer reserves index paletteSize_ for transparent pixels, which
+    // is moved to index 0 (i.e., the dummy transparent color written in front
+    // of the palette), while all other indices are shifted by one
+    for (uint32_t i=0; i<256; i++)
+    {
+        if (indexMode_ == Quantizer::Settings::IndexMode::Default)
+            indexMap_[i] = i;
+        else
+            indexMap_[i] = i == paletteSize_ ? 0 : (uint8_t)(i+1);
+    }
+
     return true;
 }
 
@@ -354,6 +692,9 @@ bool GifEncoder::closeFile()
     if (file_ == nullptr)
         return false;
 
+    // Wait for all in-flight frames to be written
+    stopWorkers();
+
     // https://www.w3.org/Graphics/GIF/spec-gif89a.txt
     // 27. TRAILER
     fputc(0x3b, file_); // END OF GIF (fixed value, 0x3b) 
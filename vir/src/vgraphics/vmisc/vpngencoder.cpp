@@ -0,0 +1,233 @@
+#include "vpch.h"
+#include <cstdio>
+#include <cstring>
+#include "vgraphics/vmisc/vpngencoder.h"
+#include "thirdparty/stb/stb_image_write.h"
+
+namespace vir
+{
+
+// Private functions ---------------------------------------------------------//
+
+void PngEncoder::startWorkers()
+{
+    stopWorkers_ = false;
+    for (unsigned int i=0; i<nWorkers_; i++)
+        workers_.emplace_back(&PngEncoder::workerLoop, this);
+}
+
+void PngEncoder::stopWorkers()
+{
+    if (workers_.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex_);
+        stopWorkers_ = true;
+    }
+    jobAvailable_.notify_all();
+    // Workers only quit once all pending jobs have been written
+    for (auto& worker : workers_)
+        worker.join();
+    workers_.clear();
+    for (auto job : freeJobs_)
+        delete job;
+    freeJobs_.clear();
+    nJobs_ = 0;
+}
+
+void PngEncoder::workerLoop()
+{
+    while (true)
+    {
+        FrameJob* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(jobsMutex_);
+            jobAvailable_.wait
+            (
+                lock, 
+                [&]{return stopWorkers_ || !pendingJobs_.empty();}
+            );
+            if (pendingJobs_.empty())
+                return;
+            job = pendingJobs_.front();
+            pendingJobs_.pop_front();
+        }
+        bool written = writeFrame(*job);
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex_);
+            if (!written)
+                ++nFailedFrames_;
+            freeJobs_.push_back(job);
+        }
+        jobWritten_.notify_all();
+    }
+}
+
+bool PngEncoder::writeFrame(const FrameJob& job)
+{
+    // Flipping is achieved by starting from the last row with a negative 
+    // stride, rather than by swapping the rows in memory
+    int stride = job.nChannels*job.width;
+    const unsigned char* data = job.data.data();
+    if (job.flipVertically)
+    {
+        data += (size_t)stride*(job.height-1);
+        stride = -stride;
+    }
+    // The file is written by a callback invoked with the whole compressed
+    // data, so that compression and writing can be timed separately
+    struct WriteContext
+    {
+        FILE*    file;
+        bool     written;
+        int      size;
+        double   seconds;
+    };
+    auto writeToFile = [](void* context, void* data, int size)
+    {
+        auto* write = (WriteContext*)context;
+        auto start = EncoderStats::Clock::now();
+        write->written = fwrite(data, 1, size, write->file) == (size_t)size;
+        write->size = size;
+        write->seconds += EncoderStats::secondsSince(start);
+    };
+    auto start = EncoderStats::Clock::now();
+    WriteContext context = {nullptr, false, 0, 0};
+    #if defined(_MSC_VER) && (_MSC_VER >= 1400)
+        fopen_s(&context.file, job.filepath.c_str(), "wb");
+    #else
+        context.file = fopen(job.filepath.c_str(), "wb");
+    #endif
+    if (context.file == nullptr)
+        return false;
+    context.seconds = EncoderStats::secondsSince(start);
+    bool encoded = stbi_write_png_to_func
+    (
+        writeToFile,
+        &context,
+        job.width,
+        job.height,
+        job.nChannels,
+        (const void*)data,
+        stride
+    ) != 0;
+    double encodingSeconds = 
+        EncoderStats::secondsSince(start)-context.seconds;
+    auto closeStart = EncoderStats::Clock::now();
+    bool written = 
+        (fclose(context.file) == 0) && encoded && context.written;
+    context.seconds += EncoderStats::secondsSince(closeStart);
+    stats_.record(EncoderStats::Stage::Encoding, encodingSeconds);
+    stats_.record(EncoderStats::Stage::Writing, context.seconds);
+    if (written)
+        stats_.recordBytesWritten(context.size);
+    return written;
+}
+
+// Public functions ----------------------------------------------------------//
+
+PngEncoder::~PngEncoder()
+{
+    stopWorkers();
+}
+
+void PngEncoder::setAsyncEncoding
+(
+    unsigned int nWorkers, 
+    unsigned int maxFramesInFlight
+)
+{
+    stopWorkers();
+    nWorkers_ = nWorkers;
+    maxFramesInFlight_ = std::max(maxFramesInFlight, 1u);
+}
+
+void PngEncoder::setCompressionLevel(int level)
+{
+    // The compression level is a global of stb_image_write, so it can only be
+    // changed while no workers are running
+    stopWorkers();
+    compressionLevel_ = std::min(std::max(level, 0), 9);
+}
+
+void PngEncoder::encodeFrame
+(
+    const unsigned char* data,
+    uint32_t width,
+    uint32_t height,
+    uint32_t nChannels,
+    const std::string& filepath,
+    bool flipVertically
+)
+{
+    if (data == nullptr || width*height*nChannels == 0)
+        return;
+    size_t size = (size_t)width*height*nChannels;
+    if (nWorkers_ == 0)
+    {
+        stbi_write_png_compression_level = compressionLevel_;
+        job_.data.assign(data, data+size);
+        job_.filepath = filepath;
+        job_.width = width;
+        job_.height = height;
+        job_.nChannels = nChannels;
+        job_.flipVertically = flipVertically;
+        if (!writeFrame(job_))
+            ++nFailedFrames_;
+        return;
+    }
+    if (workers_.empty())
+    {
+        stbi_write_png_compression_level = compressionLevel_;
+        startWorkers();
+    }
+
+    // Wait for a free job slot (backpressure), then hand a copy of the frame
+    // to the workers
+    FrameJob* job = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(jobsMutex_);
+        jobWritten_.wait
+        (
+            lock, 
+            [&]
+            {
+                return 
+                    !freeJobs_.empty() || 
+                    nJobs_ < maxFramesInFlight_;
+            }
+        );
+        if (freeJobs_.empty())
+        {
+            job = new FrameJob();
+            ++nJobs_;
+        }
+        else
+        {
+            job = freeJobs_.back();
+            freeJobs_.pop_back();
+        }
+    }
+    job->data.resize(size);
+    std::memcpy(job->data.data(), data, size);
+    job->filepath = filepath;
+    job->width = width;
+    job->height = height;
+    job->nChannels = nChannels;
+    job->flipVertically = flipVertically;
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex_);
+        pendingJobs_.push_back(job);
+    }
+    jobAvailable_.notify_one();
+}
+
+unsigned int PngEncoder::finish()
+{
+    stopWorkers();
+    unsigned int nFailedFrames = nFailedFrames_;
+    nFailedFrames_ = 0;
+    return nFailedFrames;
+}
+
+}
@@ -0,0 +1,450 @@
+#include "vpch.h"
+#include <algorithm>
+#include <cstring>
+#include "vgraphics/vmisc/vpngstreamencoder.h"
+
+namespace vir
+{
+
+namespace
+{
+
+// Same tables as in stb_image_write, with one trailing sentinel each
+const uint16_t lengthBases[] =
+{
+    3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,
+    163,195,227,258,259
+};
+const uint8_t lengthExtraBits[] =
+{
+    0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0
+};
+const uint16_t distanceBases[] =
+{
+    1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,
+    3073,4097,6145,8193,12289,16385,24577,32769
+};
+const uint8_t distanceExtraBits[] =
+{
+    0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13
+};
+
+// Max length of the hash chains searched for matches, by compression level
+const uint32_t maxChainLengths[] = {0, 2, 4, 6, 8, 12, 16, 32, 64, 128};
+
+uint32_t crc32(uint32_t crc, const unsigned char* data, uint32_t size)
+{
+    static uint32_t table[256] = {};
+    if (table[1] == 0)
+    {
+        for (uint32_t i=0; i<256; i++)
+        {
+            uint32_t c = i;
+            for (int j=0; j<8; j++)
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    }
+    crc = ~crc;
+    for (uint32_t i=0; i<size; i++)
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+void writeUInt32BE(unsigned char* data, uint32_t value)
+{
+    data[0] = (value >> 24) & 0xff;
+    data[1] = (value >> 16) & 0xff;
+    data[2] = (value >> 8) & 0xff;
+    data[3] = value & 0xff;
+}
+
+int paethPredictor(int a, int b, int c)
+{
+    int p = a+b-c;
+    int pa = std::abs(p-a);
+    int pb = std::abs(p-b);
+    int pc = std::abs(p-c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    if (pb <= pc)
+        return b;
+    return c;
+}
+
+}
+
+// Private functions ---------------------------------------------------------//
+
+void PngStreamEncoder::writeChunk
+(
+    const char* type,
+    const unsigned char* data,
+    uint32_t size
+)
+{
+    unsigned char header[8];
+    writeUInt32BE(header, size);
+    std::memcpy(header+4, type, 4);
+    uint32_t crc = crc32(0, header+4, 4);
+    if (size > 0)
+        crc = crc32(crc, data, size);
+    unsigned char footer[4];
+    writeUInt32BE(footer, crc);
+    auto start = EncoderStats::Clock::now();
+    if
+    (
+        fwrite(header, 1, 8, file_) != 8 ||
+        (size > 0 && fwrite(data, 1, size, file_) != size) ||
+        fwrite(footer, 1, 4, file_) != 4
+    )
+        hasFailed_ = true;
+    writingSeconds_ += EncoderStats::secondsSince(start);
+    nBytesWritten_ += 12+size;
+}
+
+void PngStreamEncoder::flushIdat()
+{
+    if (idat_.empty())
+        return;
+    writeChunk("IDAT", idat_.data(), idat_.size());
+    idat_.clear();
+}
+
+void PngStreamEncoder::writeBits(uint32_t bits, uint32_t nBits)
+{
+    bitBuffer_ |= uint64_t(bits) << nBits_;
+    nBits_ += nBits;
+    while (nBits_ >= 8)
+    {
+        idat_.push_back(bitBuffer_ & 0xff);
+        bitBuffer_ >>= 8;
+        nBits_ -= 8;
+    }
+}
+
+void PngStreamEncoder::writeHuffmanCode(uint32_t code, uint32_t nBits)
+{
+    // Huffman codes are packed starting from their most significant bit
+    uint32_t reversed = 0;
+    for (uint32_t i=0; i<nBits; i++)
+        reversed |= ((code >> i) & 1) << (nBits-1-i);
+    writeBits(reversed, nBits);
+}
+
+void PngStreamEncoder::writeSymbol(uint32_t symbol)
+{
+    // Fixed Huffman literal/length codes (RFC 1951, 3.2.6)
+    if (symbol <= 143)
+        writeHuffmanCode(0x30+symbol, 8);
+    else if (symbol <= 255)
+        writeHuffmanCode(0x190+symbol-144, 9);
+    else if (symbol <= 279)
+        writeHuffmanCode(symbol-256, 7);
+    else
+        writeHuffmanCode(0xc0+symbol-280, 8);
+}
+
+void PngStreamEncoder::writeMatch(uint32_t length, uint32_t distance)
+{
+    uint32_t i = 0;
+    while (lengthBases[i+1] <= length)
+        ++i;
+    writeSymbol(257+i);
+    if (lengthExtraBits[i] > 0)
+        writeBits(length-lengthBases[i], lengthExtraBits[i]);
+    i = 0;
+    while (distanceBases[i+1] <= distance)
+        ++i;
+    writeHuffmanCode(i, 5);
+    if (distanceExtraBits[i] > 0)
+        writeBits(distance-distanceBases[i], distanceExtraBits[i]);
+}
+
+void PngStreamEncoder::insertHash(uint64_t position)
+{
+    const unsigned char* p = window_.data()+(position-windowStart_);
+    uint32_t hash =
+        ((uint32_t(p[0]) << 16 | uint32_t(p[1]) << 8 | p[2])*2654435761u) >>
+        (32-hashBits_);
+    hashChains_[position & (windowSize_-1)] = hashHeads_[hash];
+    hashHeads_[hash] = position;
+}
+
+void PngStreamEncoder::deflate(bool finish)
+{
+    uint64_t end = windowStart_+window_.size();
+    // Unless finishing, keep enough data for a full-length match at the end
+    while (position_ < end && (finish || end-position_ >= maxMatchLength_))
+    {
+        const unsigned char* p = window_.data()+(position_-windowStart_);
+        uint32_t available = std::min<uint64_t>(end-position_, maxMatchLength_);
+        uint32_t bestLength = 0;
+        uint32_t bestDistance = 0;
+        if (maxChainLength_ > 0 && available >= minMatchLength_)
+        {
+            uint32_t hash =
+                ((uint32_t(p[0]) << 16 | uint32_t(p[1]) << 8 | p[2])*
+                2654435761u) >> (32-hashBits_);
+            int64_t candidate = hashHeads_[hash];
+            uint32_t chainLength = maxChainLength_;
+            while (candidate >= 0 && chainLength-- > 0)
+            {
+                uint64_t distance = position_-candidate;
+                if (distance > windowSize_)
+                    break;
+                const unsigned char* q =
+                    window_.data()+(candidate-windowStart_);
+                uint32_t length = 0;
+                while (length < available && q[length] == p[length])
+                    ++length;
+                if (length > bestLength)
+                {
+                    bestLength = length;
+                    bestDistance = distance;
+                    if (length == available)
+                        break;
+                }
+                candidate = hashChains_[candidate & (windowSize_-1)];
+            }
+        }
+        if (bestLength >= minMatchLength_)
+        {
+            writeMatch(bestLength, bestDistance);
+            for (uint32_t i=0; i<bestLength; i++, position_++)
+            {
+                if (position_+minMatchLength_ <= end)
+                    insertHash(position_);
+            }
+        }
+        else
+        {
+            writeSymbol(*p);
+            if (maxChainLength_ > 0 && available >= minMatchLength_)
+                insertHash(position_);
+            ++position_;
+        }
+    }
+
+    // Drop the data which can no longer be referenced by any match, but only
+    // once enough of it has accumulated, to limit the cost of the shift
+    uint64_t nDroppable =
+        position_ > windowStart_+windowSize_ ?
+        position_-windowStart_-windowSize_ : 0;
+    if (nDroppable >= 2*windowSize_)
+    {
+        window_.erase(window_.begin(), window_.begin()+nDroppable);
+        windowStart_ += nDroppable;
+    }
+    if (idat_.size() >= idatChunkSize_)
+        flushIdat();
+}
+
+void PngStreamEncoder::filterRow(const unsigned char* row)
+{
+    // Same heuristic as stb_image_write, i.e., use the filter type which
+    // minimizes the sum of the absolute values of the filtered bytes
+    uint32_t rowSize = width_*nChannels_;
+    uint32_t bpp = nChannels_;
+    const unsigned char* prior = previousRow_.data();
+    uint64_t bestScore = UINT64_MAX;
+    int nFilterTypes = maxChainLength_ > 0 ? 5 : 1;
+    for (int filterType=0; filterType<nFilterTypes; filterType++)
+    {
+        unsigned char* filtered = filteredRow_.data()+1;
+        filteredRow_[0] = filterType;
+        for (uint32_t i=0; i<rowSize; i++)
+        {
+            int a = i >= bpp ? row[i-bpp] : 0;
+            int b = prior[i];
+            int c = i >= bpp ? prior[i-bpp] : 0;
+            int predictor = 0;
+            switch (filterType)
+            {
+                case 1 : predictor = a; break;
+                case 2 : predictor = b; break;
+                case 3 : predictor = (a+b) >> 1; break;
+                case 4 : predictor = paethPredictor(a, b, c); break;
+                default : break;
+            }
+            filtered[i] = (unsigned char)(row[i]-predictor);
+        }
+        uint64_t score = 0;
+        for (uint32_t i=0; i<rowSize; i++)
+            score += std::abs((int)(signed char)filtered[i]);
+        if (score < bestScore)
+        {
+            bestScore = score;
+            std::swap(filteredRow_, bestFilteredRow_);
+        }
+    }
+    std::memcpy(previousRow_.data(), row, rowSize);
+
+    // Update the Adler-32 checksum of the uncompressed data and append the
+    // filtered row to the data to be compressed
+    const unsigned char* data = bestFilteredRow_.data();
+    uint32_t size = rowSize+1;
+    while (size > 0)
+    {
+        uint32_t n = std::min(size, 5552u);
+        for (uint32_t i=0; i<n; i++)
+        {
+            adlerA_ += data[i];
+            adlerB_ += adlerA_;
+        }
+        adlerA_ %= 65521;
+        adlerB_ %= 65521;
+        data += n;
+        size -= n;
+    }
+    window_.insert
+    (
+        window_.end(),
+        bestFilteredRow_.begin(),
+        bestFilteredRow_.begin()+rowSize+1
+    );
+}
+
+void PngStreamEncoder::recordStats(EncoderStats::Clock::time_point start)
+{
+    // Chunks are written while encoding, so the writing time is subtracted
+    // from the total
+    double seconds = EncoderStats::secondsSince(start);
+    stats_.record(EncoderStats::Stage::Encoding, seconds-writingSeconds_);
+    stats_.record(EncoderStats::Stage::Writing, writingSeconds_);
+    stats_.recordBytesWritten(nBytesWritten_);
+    writingSeconds_ = 0;
+    nBytesWritten_ = 0;
+}
+
+// Public functions ----------------------------------------------------------//
+
+PngStreamEncoder::~PngStreamEncoder()
+{
+    if (file_ != nullptr)
+        closeFile();
+}
+
+bool PngStreamEncoder::openFile
+(
+    const std::string& filepath,
+    uint32_t width,
+    uint32_t height,
+    uint32_t nChannels,
+    int compressionLevel
+)
+{
+    if (file_ != nullptr)
+        closeFile();
+    if (width == 0 || height == 0 || nChannels == 0 || nChannels > 4)
+        return false;
+    #if defined(_MSC_VER) && (_MSC_VER >= 1400)
+        file_ = 0;
+        fopen_s(&file_, filepath.c_str(), "wb");
+    #else
+        file_ = fopen(filepath.c_str(), "wb");
+    #endif
+    if (!file_)
+        return false;
+    width_ = width;
+    height_ = height;
+    nChannels_ = nChannels;
+    nRowsWritten_ = 0;
+    maxChainLength_ = maxChainLengths[std::min(std::max(compressionLevel,0),9)];
+    hasFailed_ = false;
+    writingSeconds_ = 0;
+    nBytesWritten_ = 0;
+
+    uint32_t rowSize = width_*nChannels_;
+    previousRow_.assign(rowSize, 0);
+    filteredRow_.resize(rowSize+1);
+    bestFilteredRow_.resize(rowSize+1);
+    window_.clear();
+    windowStart_ = 0;
+    position_ = 0;
+    hashHeads_.assign(1 << hashBits_, -1);
+    hashChains_.assign(windowSize_, -1);
+    bitBuffer_ = 0;
+    nBits_ = 0;
+    adlerA_ = 1;
+    adlerB_ = 0;
+    idat_.clear();
+    idat_.reserve(idatChunkSize_+maxMatchLength_);
+
+    static const unsigned char signature[] =
+        {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    if (fwrite(signature, 1, 8, file_) != 8)
+        hasFailed_ = true;
+    static const unsigned char colorTypes[] = {0, 4, 2, 6};
+    unsigned char header[13];
+    writeUInt32BE(header, width_);
+    writeUInt32BE(header+4, height_);
+    header[8] = 8;                          // Bit depth
+    header[9] = colorTypes[nChannels_-1];   // Color type
+    header[10] = 0;                         // Compression method
+    header[11] = 0;                         // Filter method
+    header[12] = 0;                         // Interlace method
+    writeChunk("IHDR", header, 13);
+
+    // zlib header, followed by the header of the single final deflate block
+    // with fixed Huffman codes
+    idat_.push_back(0x78);
+    idat_.push_back(0x5e);
+    writeBits(1, 1);
+    writeBits(1, 2);
+    return !hasFailed_;
+}
+
+void PngStreamEncoder::encodeRows
+(
+    const unsigned char* data,
+    uint32_t nRows,
+    bool flipVertically
+)
+{
+    if (file_ == nullptr || data == nullptr)
+        return;
+    auto start = EncoderStats::Clock::now();
+    uint64_t rowSize = width_*nChannels_;
+    nRows = std::min(nRows, height_-nRowsWritten_);
+    for (uint32_t i=0; i<nRows; i++)
+    {
+        uint32_t row = flipVertically ? nRows-1-i : i;
+        filterRow(data+row*rowSize);
+        deflate(false);
+    }
+    nRowsWritten_ += nRows;
+    recordStats(start);
+}
+
+bool PngStreamEncoder::closeFile()
+{
+    if (file_ == nullptr)
+        return false;
+    auto start = EncoderStats::Clock::now();
+    deflate(true);
+    writeSymbol(256); // End of block
+    if (nBits_ > 0)
+        writeBits(0, 8-nBits_);
+    unsigned char adler[4];
+    writeUInt32BE(adler, (adlerB_ << 16) | adlerA_);
+    idat_.insert(idat_.end(), adler, adler+4);
+    flushIdat();
+    writeChunk("IEND", nullptr, 0);
+    if (fclose(file_) != 0)
+        hasFailed_ = true;
+    recordStats(start);
+    file_ = nullptr;
+    bool success = !hasFailed_ && nRowsWritten_ == height_;
+    window_.clear();
+    window_.shrink_to_fit();
+    hashHeads_.clear();
+    hashHeads_.shrink_to_fit();
+    hashChains_.clear();
+    hashChains_.shrink_to_fit();
+    idat_.clear();
+    idat_.shrink_to_fit();
+    return success;
+}
+
+}
@@ -0,0 +1,525 @@
+#include "vpch.h"
+#include <cstring>
+#include <numeric>
+#include "vgraphics/vmisc/vrawvideoencoder.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define V_RAW_VIDEO_ENCODER_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace vir
+{
+
+namespace
+{
+
+// Size of the write buffer of the output file stream
+constexpr size_t fileBufferSize = 1<<23;
+
+// The Y4M output uses full-range BT.601 (i.e., JPEG) YUV, with the following
+// coefficients (scaled by 256), and with U, V offset by 128*256:
+// Y =  77*R + 150*G +  29*B
+// U = -43*R -  85*G + 128*B
+// V = 128*R - 107*G -  21*B
+// Chroma samples are computed from the average of each 2x2 pixel block, with
+// the same rounding as _mm_avg_epu8 (first vertically, then horizontally), so
+// that all conversion functions produce identical results
+constexpr int chromaBias = 128*256+128;
+
+inline unsigned char average(unsigned char a, unsigned char b)
+{
+    return (a+b+1)>>1;
+}
+
+inline unsigned char luma(const unsigned char* p)
+{
+    return (77*p[0]+150*p[1]+29*p[2]+128)>>8;
+}
+
+// Convert the pixels [x0, width) of a pair of RGBA8 rows to two rows of luma
+// samples and one row of chroma samples. For the last row of odd-height 
+// frames, row1 is the same as row0 and y1 is nullptr. The value of x0 is even
+typedef void(*RowPairToYUV420Function)
+(
+    const unsigned char*,
+    const unsigned char*,
+    uint32_t,
+    uint32_t,
+    unsigned char*,
+    unsigned char*,
+    unsigned char*,
+    unsigned char*
+);
+
+void rowPairToYUV420Scalar
+(
+    const unsigned char* row0,
+    const unsigned char* row1,
+    uint32_t x0,
+    uint32_t width,
+    unsigned char* y0,
+    unsigned char* y1,
+    unsigned char* u,
+    unsigned char* v
+)
+{
+    for (uint32_t x=x0; x<width; x++)
+    {
+        y0[x] = luma(row0+4*x);
+        if (y1 != nullptr)
+            y1[x] = luma(row1+4*x);
+    }
+    for (uint32_t x=x0; x<width; x+=2)
+    {
+        uint32_t x1 = std::min(x+1, width-1);
+        int c[3];
+        for (int i=0; i<3; i++)
+            c[i] = average
+            (
+                average(row0[4*x+i], row1[4*x+i]), 
+                average(row0[4*x1+i], row1[4*x1+i])
+            );
+        u[x/2] = std::min((-43*c[0]-85*c[1]+128*c[2]+chromaBias)>>8, 255);
+        v[x/2] = std::min((128*c[0]-107*c[1]-21*c[2]+chromaBias)>>8, 255);
+    }
+}
+
+#ifdef V_RAW_VIDEO_ENCODER_X86
+
+// Returns {a0+a1, a2+a3, b0+b1, b2+b3}
+__attribute__((target("sse2")))
+inline __m128i addPairs(__m128i a, __m128i b)
+{
+    __m128 fa = _mm_castsi128_ps(a);
+    __m128 fb = _mm_castsi128_ps(b);
+    __m128i even = _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(2,0,2,0)));
+    __m128i odd = _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(3,1,3,1)));
+    return _mm_add_epi32(even, odd);
+}
+
+// Luma samples (as int32, already scaled back) of four RGBA8 pixels
+__attribute__((target("sse2")))
+inline __m128i luma4(__m128i pixels)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i coeffs = _mm_setr_epi16(77, 150, 29, 0, 77, 150, 29, 0);
+    __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), coeffs);
+    __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), coeffs);
+    return _mm_srai_epi32(_mm_add_epi32(addPairs(lo, hi), _mm_set1_epi32(128)), 8);
+}
+
+// Luma samples of sixteen RGBA8 pixels
+__attribute__((target("sse2")))
+inline void luma16(const __m128i* pixels, unsigned char* y)
+{
+    __m128i lo = _mm_packs_epi32(luma4(pixels[0]), luma4(pixels[1]));
+    __m128i hi = _mm_packs_epi32(luma4(pixels[2]), luma4(pixels[3]));
+    _mm_storeu_si128((__m128i*)y, _mm_packus_epi16(lo, hi));
+}
+
+// Chroma samples (as int32, already scaled back) from two pairs of int16
+// RGBA colors
+__attribute__((target("sse2")))
+inline __m128i chroma4(__m128i c01, __m128i c23, __m128i coeffs)
+{
+    return _mm_srai_epi32
+    (
+        _mm_add_epi32
+        (
+            addPairs(_mm_madd_epi16(c01, coeffs), _mm_madd_epi16(c23, coeffs)),
+            _mm_set1_epi32(chromaBias)
+        ),
+        8
+    );
+}
+
+// Sixteen pixels (and eight chroma samples) per iteration, with the tail 
+// processed by the scalar version
+__attribute__((target("sse2")))
+void rowPairToYUV420SSE2
+(
+    const unsigned char* row0,
+    const unsigned char* row1,
+    uint32_t x0,
+    uint32_t width,
+    unsigned char* y0,
+    unsigned char* y1,
+    unsigned char* u,
+    unsigned char* v
+)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i uCoeffs = _mm_setr_epi16(-43, -85, 128, 0, -43, -85, 128, 0);
+    const __m128i vCoeffs = _mm_setr_epi16(128, -107, -21, 0, 128, -107, -21, 0);
+    uint32_t x = x0;
+    for (; x+16<=width; x+=16)
+    {
+        __m128i p0[4], p1[4], c[4];
+        for (int i=0; i<4; i++)
+        {
+            p0[i] = _mm_loadu_si128((const __m128i*)(row0+4*x+16*i));
+            p1[i] = _mm_loadu_si128((const __m128i*)(row1+4*x+16*i));
+
+            // Average vertically, then horizontally, so that the averaged 
+            // colors of pixels 0 & 1 and 2 & 3 are in pixels 0 and 2 
+            // respectively, which are then packed as int16
+            __m128i m = _mm_avg_epu8(p0[i], p1[i]);
+            m = _mm_avg_epu8(m, _mm_srli_si128(m, 4));
+            c[i] = _mm_unpacklo_epi64
+            (
+                _mm_unpacklo_epi8(m, zero), 
+                _mm_unpackhi_epi8(m, zero)
+            );
+        }
+        luma16(p0, y0+x);
+        if (y1 != nullptr)
+            luma16(p1, y1+x);
+        __m128i us = _mm_packs_epi32
+        (
+            chroma4(c[0], c[1], uCoeffs), 
+            chroma4(c[2], c[3], uCoeffs)
+        );
+        __m128i vs = _mm_packs_epi32
+        (
+            chroma4(c[0], c[1], vCoeffs), 
+            chroma4(c[2], c[3], vCoeffs)
+        );
+        _mm_storel_epi64((__m128i*)(u+x/2), _mm_packus_epi16(us, zero));
+        _mm_storel_epi64((__m128i*)(v+x/2), _mm_packus_epi16(vs, zero));
+    }
+    rowPairToYUV420Scalar(row0, row1, x, width, y0, y1, u, v);
+}
+
+#endif
+
+RowPairToYUV420Function selectRowPairToYUV420Function()
+{
+#ifdef V_RAW_VIDEO_ENCODER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        return rowPairToYUV420SSE2;
+#endif
+    return rowPairToYUV420Scalar;
+}
+
+const RowPairToYUV420Function rowPairToYUV420 = 
+    selectRowPairToYUV420Function();
+
+}
+
+std::map<RawVideoEncoder::Format, const char*> 
+    RawVideoEncoder::formatToName = 
+{
+    {RawVideoEncoder::Format::RGBA, "Raw RGBA"},
+    {RawVideoEncoder::Format::Y4M, "Y4M (YUV 4:2:0)"}
+};
+
+std::map<RawVideoEncoder::Format, const char*> 
+    RawVideoEncoder::formatToExtension = 
+{
+    {RawVideoEncoder::Format::RGBA, "rgba"},
+    {RawVideoEncoder::Format::Y4M, "y4m"}
+};
+
+// Private functions ---------------------------------------------------------//
+
+void RawVideoEncoder::startWorker()
+{
+    stopWorker_ = false;
+    worker_ = std::thread(&RawVideoEncoder::workerLoop, this);
+}
+
+void RawVideoEncoder::stopWorker()
+{
+    if (!worker_.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex_);
+        stopWorker_ = true;
+    }
+    jobAvailable_.notify_all();
+    // The worker only quits once all pending jobs have been written
+    worker_.join();
+    for (auto job : freeJobs_)
+        delete job;
+    freeJobs_.clear();
+    nJobs_ = 0;
+}
+
+void RawVideoEncoder::workerLoop()
+{
+    while (true)
+    {
+        FrameJob* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(jobsMutex_);
+            jobAvailable_.wait
+            (
+                lock, 
+                [&]{return stopWorker_ || !pendingJobs_.empty();}
+            );
+            if (pendingJobs_.empty())
+                return;
+            job = pendingJobs_.front();
+            pendingJobs_.pop_front();
+        }
+        writeFrame(*job);
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex_);
+            freeJobs_.push_back(job);
+        }
+        jobWritten_.notify_all();
+    }
+}
+
+void RawVideoEncoder::writeFrame(const FrameJob& job)
+{
+    uint32_t stride = 4*width_;
+    auto row = [&](uint32_t y)
+    {
+        return 
+            job.data.data() + 
+            (size_t)stride*(job.flipVertically ? height_-1-y : y);
+    };
+    auto start = EncoderStats::Clock::now();
+    const unsigned char* frameData = job.data.data();
+    if (format_ == Format::RGBA)
+    {
+        if (job.flipVertically)
+        {
+            frameData_.resize(frameSize());
+            for (uint32_t y=0; y<height_; y++)
+                std::memcpy(frameData_.data()+(size_t)stride*y, row(y), stride);
+            frameData = frameData_.data();
+        }
+    }
+    else
+    {
+        static const char frameHeader[] = "FRAME\n";
+        uint32_t chromaWidth = (width_+1)/2;
+        uint32_t chromaHeight = (height_+1)/2;
+        frameData_.resize(frameSize());
+        std::memcpy(frameData_.data(), frameHeader, sizeof(frameHeader)-1);
+        unsigned char* Y = frameData_.data()+sizeof(frameHeader)-1;
+        unsigned char* U = Y+(size_t)width_*height_;
+        unsigned char* V = U+(size_t)chromaWidth*chromaHeight;
+        for (uint32_t y=0; y<height_; y+=2)
+        {
+            bool hasSecondRow = y+1 < height_;
+            rowPairToYUV420
+            (
+                row(y),
+                row(hasSecondRow ? y+1 : y),
+                0,
+                width_,
+                Y+(size_t)width_*y,
+                hasSecondRow ? Y+(size_t)width_*(y+1) : nullptr,
+                U+(size_t)chromaWidth*(y/2),
+                V+(size_t)chromaWidth*(y/2)
+            );
+        }
+        frameData = frameData_.data();
+    }
+    stats_.record
+    (
+        EncoderStats::Stage::Encoding, 
+        EncoderStats::secondsSince(start)
+    );
+    start = EncoderStats::Clock::now();
+    size_t size = frameSize();
+    if (fwrite(frameData, 1, size, file_) != size)
+        hasWriteFailed_ = true;
+    else
+        stats_.recordBytesWritten(size);
+    stats_.record
+    (
+        EncoderStats::Stage::Writing, 
+        EncoderStats::secondsSince(start)
+    );
+}
+
+uint64_t RawVideoEncoder::frameSize() const
+{
+    if (format_ == Format::RGBA)
+        return 4ull*width_*height_;
+    uint64_t chromaSize = (uint64_t)((width_+1)/2)*((height_+1)/2);
+    return 6+(uint64_t)width_*height_+2*chromaSize; // 6 = "FRAME\n"
+}
+
+// Public functions ----------------------------------------------------------//
+
+RawVideoEncoder::~RawVideoEncoder()
+{
+    closeFile();
+}
+
+void RawVideoEncoder::setAsyncEncoding(unsigned int maxFramesInFlight)
+{
+    maxFramesInFlight_ = maxFramesInFlight;
+}
+
+bool RawVideoEncoder::openFile
+(
+    const std::string& filepath,
+    uint32_t width,
+    uint32_t height,
+    float fps,
+    Format format,
+    uint32_t nFrames
+)
+{
+    closeFile();
+    if (width*height == 0 || fps <= 0)
+        return false;
+    isStdout_ = filepath == "-";
+    if (isStdout_)
+    {
+        file_ = stdout;
+        #if defined(_WIN32)
+            _setmode(_fileno(stdout), _O_BINARY);
+        #endif
+    }
+    else
+    {
+        #if defined(_MSC_VER) && (_MSC_VER >= 1400)
+            file_ = 0;
+            fopen_s(&file_, filepath.c_str(), "wb");
+        #else
+            file_ = fopen(filepath.c_str(), "wb");
+        #endif
+    }
+    if (!file_)
+        return false;
+    width_ = width;
+    height_ = height;
+    format_ = format;
+    hasWriteFailed_ = false;
+
+    std::string header;
+    if (format_ == Format::Y4M)
+    {
+        // Frame rate as a ratio of integers, to the third decimal place
+        uint32_t fpsNum = (uint32_t)(1000.0f*fps+.5f);
+        uint32_t fpsDen = 1000;
+        uint32_t gcd = std::gcd(fpsNum, fpsDen);
+        header = 
+            "YUV4MPEG2 W"+std::to_string(width_)+" H"+std::to_string(height_)+
+            " F"+std::to_string(fpsNum/gcd)+":"+std::to_string(fpsDen/gcd)+
+            " Ip A1:1 C420jpeg\n";
+    }
+    if (!isStdout_)
+    {
+        fileBuffer_.resize(fileBufferSize);
+        setvbuf(file_, fileBuffer_.data(), _IOFBF, fileBuffer_.size());
+        #if defined(__linux__)
+            // Reserve the file storage upfront so that it is not grown (and 
+            // possibly fragmented) frame by frame. The file size is set to the
+            // actual amount of data written when closing the file
+            if (nFrames > 0)
+                posix_fallocate
+                (
+                    fileno(file_), 
+                    0, 
+                    (off_t)(header.size()+nFrames*frameSize())
+                );
+        #else
+            (void)nFrames;
+        #endif
+    }
+    if 
+    (
+        !header.empty() && 
+        fwrite(header.data(), 1, header.size(), file_) != header.size()
+    )
+        hasWriteFailed_ = true;
+    if (maxFramesInFlight_ > 0)
+        startWorker();
+    return true;
+}
+
+bool RawVideoEncoder::closeFile()
+{
+    if (file_ == nullptr)
+        return false;
+    stopWorker();
+    if (fflush(file_) != 0)
+        hasWriteFailed_ = true;
+    if (!isStdout_)
+    {
+        #if defined(__linux__)
+            // Drop any pre-allocated storage that was not written to
+            long size = ftell(file_);
+            if (size >= 0 && ftruncate(fileno(file_), (off_t)size) != 0)
+                hasWriteFailed_ = true;
+        #endif
+        fclose(file_);
+    }
+    file_ = nullptr;
+    fileBuffer_.clear();
+    fileBuffer_.shrink_to_fit();
+    return !hasWriteFailed_;
+}
+
+void RawVideoEncoder::encodeFrame
+(
+    const unsigned char* data, 
+    bool flipVertically
+)
+{
+    if (file_ == nullptr || data == nullptr)
+        return;
+    size_t size = 4ull*width_*height_;
+    if (!worker_.joinable())
+    {
+        job_.data.assign(data, data+size);
+        job_.flipVertically = flipVertically;
+        writeFrame(job_);
+        return;
+    }
+
+    // Wait for a free job slot (backpressure), then hand a copy of the frame
+    // to the worker
+    FrameJob* job = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(jobsMutex_);
+        jobWritten_.wait
+        (
+            lock, 
+            [&]
+            {
+                return 
+                    !freeJobs_.empty() || 
+                    nJobs_ < maxFramesInFlight_;
+            }
+        );
+        if (freeJobs_.empty())
+        {
+            job = new FrameJob();
+            ++nJobs_;
+        }
+        else
+        {
+            job = freeJobs_.back();
+            freeJobs_.pop_back();
+        }
+    }
+    job->data.resize(size);
+    std::memcpy(job->data.data(), data, size);
+    job->flipVertically = flipVertically;
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex_);
+        pendingJobs_.push_back(job);
+    }
+    jobAvailable_.notify_one();
+}
+
+}
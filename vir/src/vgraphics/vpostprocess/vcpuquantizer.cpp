@@ -0,0 +1,956 @@
+#include "vpch.h"
+#include <cmath>
+#include <cstring>
+#include "vgraphics/vpostprocess/vcpuquantizer.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define V_CPU_QUANTIZER_X86
+#include <immintrin.h>
+#endif
+
+namespace vir
+{
+
+namespace
+{
+
+// Max squared distance between two RGB8 colors, i.e., 3*255*255
+constexpr uint32_t maxSqrDist = 195075;
+
+// Same dither masks as in the OpenGLQuantizer compute shaders
+const float ditherMask2x2[4] =
+{
+    0.0f/4.0f-3.0f/8.0f,
+    2.0f/4.0f-3.0f/8.0f,
+
+    3.0f/4.0f-3.0f/8.0f,
+    1.0f/4.0f-3.0f/8.0f
+};
+
+const float ditherMask4x4[16] =
+{
+    0.0f /16.0f-15.0f/32.0f,
+    8.0f /16.0f-15.0f/32.0f,
+    2.0f /16.0f-15.0f/32.0f,
+    10.0f/16.0f-15.0f/32.0f,
+
+    12.0f/16.0f-15.0f/32.0f,
+    4.0f /16.0f-15.0f/32.0f,
+    14.0f/16.0f-15.0f/32.0f,
+    6.0f /16.0f-15.0f/32.0f,
+
+    3.0f /16.0f-15.0f/32.0f,
+    11.0f/16.0f-15.0f/32.0f,
+    1.0f /16.0f-15.0f/32.0f,
+    9.0f /16.0f-15.0f/32.0f,
+
+    15.0f/16.0f-15.0f/32.0f,
+    7.0f /16.0f-15.0f/32.0f,
+    13.0f/16.0f-15.0f/32.0f,
+    5.0f /16.0f-15.0f/32.0f
+};
+
+// The packed palette is made of blocks of 8 colors, each block being 32 int16
+// values: 8 interleaved (r, g) pairs followed by 8 interleaved (b, 0) pairs.
+// This way, a single madd of a color difference with itself yields
+// dr*dr+dg*dg (resp. db*db) for all 8 colors at once. Unused colors of the
+// last block are padded with far-away values so that they are never selected
+constexpr uint32_t paletteBlockSize = 8;
+constexpr int16_t  paletteBlockPadding = 4095;
+
+// All nearest-color functions return the index of the palette color closest
+// to (r, g, b), or 0 if none is closer than maxSqrDist (same as the GPU
+// shaders), and store the corresponding squared distance in d2
+typedef uint32_t (*NearestColorFunction)
+(
+    const int16_t* palette,
+    uint32_t nBlocks,
+    int r,
+    int g,
+    int b,
+    uint32_t& d2
+);
+
+uint32_t nearestColorScalar
+(
+    const int16_t* palette,
+    uint32_t nBlocks,
+    int r,
+    int g,
+    int b,
+    uint32_t& d2
+)
+{
+    int d2m = maxSqrDist;
+    uint32_t index = 0;
+    for (uint32_t i=0; i<nBlocks*paletteBlockSize; i++)
+    {
+        const int16_t* block = palette + 4*paletteBlockSize*(i/paletteBlockSize);
+        uint32_t j = 2*(i%paletteBlockSize);
+        int dr = block[j]-r;
+        int dg = block[j+1]-g;
+        int db = block[j+2*paletteBlockSize]-b;
+        int d = dr*dr + dg*dg + db*db;
+        if (d < d2m)
+        {
+            d2m = d;
+            index = i;
+        }
+    }
+    d2 = d2m;
+    return index;
+}
+
+#ifdef V_CPU_QUANTIZER_X86
+
+// Reduce the per-lane minima to the overall minimum, with ties resolved in
+// favor of the lowest index, so to match the strict less-than search of the
+// scalar version
+inline uint32_t reduceNearestColor
+(
+    const int32_t* d2s,
+    const int32_t* indices,
+    uint32_t n,
+    uint32_t& d2
+)
+{
+    int32_t d2m = d2s[0];
+    int32_t index = indices[0];
+    for (uint32_t i=1; i<n; i++)
+    {
+        if (d2s[i] < d2m || (d2s[i] == d2m && indices[i] < index))
+        {
+            d2m = d2s[i];
+            index = indices[i];
+        }
+    }
+    if (d2m >= (int32_t)maxSqrDist)
+    {
+        d2 = maxSqrDist;
+        return 0;
+    }
+    d2 = d2m;
+    return index;
+}
+
+__attribute__((target("sse2")))
+uint32_t nearestColorSSE2
+(
+    const int16_t* palette,
+    uint32_t nBlocks,
+    int r,
+    int g,
+    int b,
+    uint32_t& d2
+)
+{
+    const __m128i rg = _mm_set1_epi32
+    (
+        (int32_t)(((uint32_t)(uint16_t)g << 16) | (uint16_t)r)
+    );
+    const __m128i b0 = _mm_set1_epi32((int32_t)(uint16_t)b);
+    const __m128i step = _mm_set1_epi32(paletteBlockSize);
+    __m128i minD2[2] =
+    {
+        _mm_set1_epi32(INT32_MAX),
+        _mm_set1_epi32(INT32_MAX)
+    };
+    __m128i minIndex[2] = {_mm_setzero_si128(), _mm_setzero_si128()};
+    __m128i index[2] = {_mm_setr_epi32(0,1,2,3), _mm_setr_epi32(4,5,6,7)};
+    for (uint32_t k=0; k<nBlocks; k++)
+    {
+        const int16_t* block = palette + 4*paletteBlockSize*k;
+        for (int h=0; h<2; h++)
+        {
+            __m128i drg = _mm_sub_epi16
+            (
+                _mm_loadu_si128((const __m128i*)(block+8*h)),
+                rg
+            );
+            __m128i db = _mm_sub_epi16
+            (
+                _mm_loadu_si128((const __m128i*)(block+16+8*h)),
+                b0
+            );
+            __m128i d = _mm_add_epi32
+            (
+                _mm_madd_epi16(drg, drg),
+                _mm_madd_epi16(db, db)
+            );
+            __m128i closer = _mm_cmpgt_epi32(minD2[h], d);
+            minD2[h] = _mm_or_si128
+            (
+                _mm_and_si128(closer, d),
+                _mm_andnot_si128(closer, minD2[h])
+            );
+            minIndex[h] = _mm_or_si128
+            (
+                _mm_and_si128(closer, index[h]),
+                _mm_andnot_si128(closer, minIndex[h])
+            );
+            index[h] = _mm_add_epi32(index[h], step);
+        }
+    }
+    alignas(16) int32_t d2s[8];
+    alignas(16) int32_t indices[8];
+    _mm_store_si128((__m128i*)d2s, minD2[0]);
+    _mm_store_si128((__m128i*)(d2s+4), minD2[1]);
+    _mm_store_si128((__m128i*)indices, minIndex[0]);
+    _mm_store_si128((__m128i*)(indices+4), minIndex[1]);
+    return reduceNearestColor(d2s, indices, 8, d2);
+}
+
+__attribute__((target("avx2")))
+uint32_t nearestColorAVX2
+(
+    const int16_t* palette,
+    uint32_t nBlocks,
+    int r,
+    int g,
+    int b,
+    uint32_t& d2
+)
+{
+    const __m256i rg = _mm256_set1_epi32
+    (
+        (int32_t)(((uint32_t)(uint16_t)g << 16) | (uint16_t)r)
+    );
+    const __m256i b0 = _mm256_set1_epi32((int32_t)(uint16_t)b);
+    const __m256i step = _mm256_set1_epi32(paletteBlockSize);
+    __m256i minD2 = _mm256_set1_epi32(INT32_MAX);
+    __m256i minIndex = _mm256_setzero_si256();
+    __m256i index = _mm256_setr_epi32(0,1,2,3,4,5,6,7);
+    for (uint32_t k=0; k<nBlocks; k++)
+    {
+        const int16_t* block = palette + 4*paletteBlockSize*k;
+        __m256i drg = _mm256_sub_epi16
+        (
+            _mm256_loadu_si256((const __m256i*)block),
+            rg
+        );
+        __m256i db = _mm256_sub_epi16
+        (
+            _mm256_loadu_si256((const __m256i*)(block+16)),
+            b0
+        );
+        __m256i d = _mm256_add_epi32
+        (
+            _mm256_madd_epi16(drg, drg),
+            _mm256_madd_epi16(db, db)
+        );
+        __m256i closer = _mm256_cmpgt_epi32(minD2, d);
+        minD2 = _mm256_min_epi32(minD2, d);
+        minIndex = _mm256_blendv_epi8(minIndex, index, closer);
+        index = _mm256_add_epi32(index, step);
+    }
+    alignas(32) int32_t d2s[8];
+    alignas(32) int32_t indices[8];
+    _mm256_store_si256((__m256i*)d2s, minD2);
+    _mm256_store_si256((__m256i*)indices, minIndex);
+    return reduceNearestColor(d2s, indices, 8, d2);
+}
+
+#endif
+
+NearestColorFunction selectNearestColorFunction()
+{
+#ifdef V_CPU_QUANTIZER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return nearestColorAVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return nearestColorSSE2;
+#endif
+    return nearestColorScalar;
+}
+
+const NearestColorFunction nearestColor = selectNearestColorFunction();
+
+// Deterministic integer hash, used in place of the sin-based pseudo-random
+// generator of the GPU shaders for re-seeding empty clusters
+inline uint32_t hash(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+}
+
+// CPUQuantizer::ThreadPool --------------------------------------------------//
+
+CPUQuantizer::ThreadPool::ThreadPool(unsigned int nThreads)
+{
+    for (unsigned int i=1; i<std::max(nThreads, 1u); i++)
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+CPUQuantizer::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    taskAvailable_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+void CPUQuantizer::ThreadPool::runChunk(uint32_t chunk)
+{
+    uint32_t begin = (uint64_t)n_*chunk/size();
+    uint32_t end = (uint64_t)n_*(chunk+1)/size();
+    if (begin < end)
+        (*task_)(chunk, begin, end);
+}
+
+void CPUQuantizer::ThreadPool::workerLoop(uint32_t chunk)
+{
+    uint64_t generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            taskAvailable_.wait
+            (
+                lock,
+                [&]{return stop_ || generation_ != generation;}
+            );
+            if (stop_)
+                return;
+            generation = generation_;
+        }
+        runChunk(chunk);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--nBusyWorkers_ == 0)
+                taskDone_.notify_one();
+        }
+    }
+}
+
+void CPUQuantizer::ThreadPool::run(uint32_t n, const Task& task)
+{
+    if (workers_.size() == 0 || n < 2)
+    {
+        task(0, 0, n);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        n_ = n;
+        nBusyWorkers_ = workers_.size();
+        ++generation_;
+    }
+    taskAvailable_.notify_all();
+    runChunk(0);
+    std::unique_lock<std::mutex> lock(mutex_);
+    taskDone_.wait(lock, [&]{return nBusyWorkers_ == 0;});
+    task_ = nullptr;
+}
+
+// Private member functions --------------------------------------------------//
+
+void CPUQuantizer::packPalette()
+{
+    uint32_t nBlocks = (paletteSize_+paletteBlockSize-1)/paletteBlockSize;
+    packedPalette_.assign(4*paletteBlockSize*nBlocks, paletteBlockPadding);
+    for (uint32_t i=0; i<nBlocks*paletteBlockSize; i++)
+    {
+        int16_t* block = &packedPalette_[4*paletteBlockSize*(i/paletteBlockSize)];
+        uint32_t j = 2*(i%paletteBlockSize);
+        block[j+2*paletteBlockSize+1] = 0;
+        if (i >= paletteSize_)
+            continue;
+        block[j]                    = palette_[3*i];
+        block[j+1]                  = palette_[3*i+1];
+        block[j+2*paletteBlockSize] = palette_[3*i+2];
+    }
+}
+
+// Deterministic KMeans++-like seeding, same as in the OpenGLQuantizer: the
+// first palette color is the first pixel, each next one is the pixel furthest
+// away from all the palette colors selected so far (the first such pixel on
+// ties). The min squared distance of each pixel to the palette is updated
+// incrementally, so that each step only compares against the latest color
+void CPUQuantizer::seedPalette(const unsigned char* data, uint32_t nPixels)
+{
+    std::vector<uint32_t> minD2(nPixels, UINT32_MAX);
+    std::vector<std::pair<uint32_t, uint32_t>> maxD2(threadPool_.size());
+    palette_[0] = data[0];
+    palette_[1] = data[1];
+    palette_[2] = data[2];
+    for (uint32_t counter=1; counter<paletteSize_; counter++)
+    {
+        const unsigned char* last = &palette_[3*(counter-1)];
+        std::fill(maxD2.begin(), maxD2.end(), std::make_pair(0u, 0u));
+        threadPool_.run
+        (
+            nPixels,
+            [&](uint32_t chunk, uint32_t begin, uint32_t end)
+            {
+                std::pair<uint32_t, uint32_t> localMax = {0, begin};
+                for (uint32_t i=begin; i<end; i++)
+                {
+                    int dr = data[4*i]-last[0];
+                    int dg = data[4*i+1]-last[1];
+                    int db = data[4*i+2]-last[2];
+                    uint32_t d2 = std::min(minD2[i], (uint32_t)(dr*dr+dg*dg+db*db));
+                    minD2[i] = d2;
+                    if (d2 > localMax.first)
+                        localMax = {d2, i};
+                }
+                maxD2[chunk] = localMax;
+            }
+        );
+        std::pair<uint32_t, uint32_t> globalMax = {0, 0};
+        for (auto& localMax : maxD2)
+        {
+            if (localMax.first > globalMax.first)
+                globalMax = localMax;
+        }
+        palette_[3*counter]   = data[4*globalMax.second];
+        palette_[3*counter+1] = data[4*globalMax.second+1];
+        palette_[3*counter+2] = data[4*globalMax.second+2];
+    }
+}
+
+// Downsample kMeansData_ by level successive 2x2 box filters, mimicking the
+// mipmap level selection of the OpenGLQuantizer
+void CPUQuantizer::downsample(uint32_t& width, uint32_t& height, uint32_t level)
+{
+    std::vector<unsigned char> source;
+    for (uint32_t l=0; l<level && (width > 1 || height > 1); l++)
+    {
+        source.swap(kMeansData_);
+        uint32_t sWidth = width;
+        uint32_t sHeight = height;
+        width = std::max(width/2, 1u);
+        height = std::max(height/2, 1u);
+        kMeansData_.resize(4*width*height);
+        threadPool_.run
+        (
+            height,
+            [&](uint32_t, uint32_t begin, uint32_t end)
+            {
+                for (uint32_t y=begin; y<end; y++)
+                {
+                    uint32_t y0 = std::min(2*y, sHeight-1);
+                    uint32_t y1 = std::min(2*y+1, sHeight-1);
+                    for (uint32_t x=0; x<width; x++)
+                    {
+                        uint32_t x0 = std::min(2*x, sWidth-1);
+                        uint32_t x1 = std::min(2*x+1, sWidth-1);
+                        for (uint32_t c=0; c<4; c++)
+                        {
+                            uint32_t sum =
+                                source[4*(y0*sWidth+x0)+c] +
+                                source[4*(y0*sWidth+x1)+c] +
+                                source[4*(y1*sWidth+x0)+c] +
+                                source[4*(y1*sWidth+x1)+c];
+                            kMeansData_[4*(y*width+x)+c] =
+                                (unsigned char)((sum+2)/4);
+                        }
+                    }
+                }
+            }
+        );
+    }
+}
+
+void CPUQuantizer::quantizeData
+(
+    const unsigned char* data,
+    uint32_t width,
+    uint32_t height,
+    unsigned int paletteSize,
+    const Settings& settings
+)
+{
+    // Cache for possibly re-initializing buffers
+    bool paletteSizeChanged(paletteSize_ != paletteSize);
+
+    // Cache settings
+    settings_ = settings;
+
+    // Limit and adjust palette size, same as in the OpenGLQuantizer
+    paletteSize =
+        std::min
+        (
+            std::max(paletteSize, 2u),
+            settings_.indexMode != Settings::IndexMode::Default ? 255u : 256u
+        );
+
+    //
+    if
+    (
+        settings_.indexMode == Settings::IndexMode::Alpha &&
+        settings_.alphaCutoff == -1
+    )
+    {
+        settings_.alphaCutoff = 127;
+    }
+
+    // Resize per-pixel buffers if necessary
+    uint32_t nPixels = width*height;
+    if (width_ != width || height_ != height)
+    {
+        width_ = width;
+        height_ = height;
+        indexedData_.resize(nPixels);
+        oldQuantizedInput_.clear();
+    }
+    if
+    (
+        settings_.indexMode == Settings::IndexMode::Delta &&
+        oldQuantizedInput_.size() != 4*nPixels
+    )
+        oldQuantizedInput_.assign(4*nPixels, 0);
+    outputData_.resize(4*nPixels);
+
+    // Resize palette data if necessary
+    if (paletteSizeChanged)
+    {
+        settings_.reseedPalette = true;
+        settings_.recalculatePalette = true;
+        paletteSize_ = paletteSize;
+        palette_.assign(3*paletteSize, 0);
+        cumulatedPaletteData_.clear();
+    }
+
+    // If provided, use the palette instead of running the KMeans
+    if (settings_.paletteData != nullptr)
+    {
+        settings_.recalculatePalette = false;
+        std::memcpy(palette_.data(), settings_.paletteData, 3*paletteSize);
+    }
+
+    if (settings_.recalculatePalette)
+    {
+        // Determine the (downsampled) data on which the KMeans should run
+        const unsigned char* kData = data;
+        uint32_t kWidth = width;
+        uint32_t kHeight = height;
+        if (settings_.fastKMeans && nPixels > 2500)
+        {
+            auto log4 = [](float x)
+            {
+                static float log2f4(std::log2(4.0f));
+                return uint32_t(ceil(std::log2(x)/log2f4));
+            };
+            uint32_t maxNPixels = 128*128/log4(paletteSize);
+            uint32_t maxLevel =
+                (uint32_t)std::floor(std::log2((float)std::max(width, height)));
+            uint32_t targetLevel = std::min
+            (
+                log4(std::max(nPixels/maxNPixels, 1u)), maxLevel
+            );
+            if (targetLevel > 0)
+            {
+                kMeansData_.assign(data, data+4*nPixels);
+                downsample(kWidth, kHeight, targetLevel);
+                kData = kMeansData_.data();
+            }
+        }
+        uint32_t nKPixels = kWidth*kHeight;
+
+        // Build initial palette
+        if (settings_.reseedPalette)
+            seedPalette(kData, nKPixels);
+
+        // Run K-Means
+        uint32_t nThreads = threadPool_.size();
+        clusterData_.resize(4*paletteSize*nThreads);
+        clusteringErrors_.resize(nThreads);
+        uint32_t nBlocks = (paletteSize+paletteBlockSize-1)/paletteBlockSize;
+        double sqErr0 = 3.0*255.0*255.0*nKPixels;
+        settings_.relTol = std::min(std::max(settings_.relTol, 0.0f), 1.0f);
+        for (uint32_t iteration=1;; iteration++)
+        {
+            // Cluster colors around current palette colors
+            packPalette();
+            std::fill(clusterData_.begin(), clusterData_.end(), 0);
+            std::fill(clusteringErrors_.begin(), clusteringErrors_.end(), 0);
+            threadPool_.run
+            (
+                nKPixels,
+                [&](uint32_t chunk, uint32_t begin, uint32_t end)
+                {
+                    uint64_t* clusters = &clusterData_[4*paletteSize*chunk];
+                    uint64_t error = 0;
+                    for (uint32_t i=begin; i<end; i++)
+                    {
+                        const unsigned char* c = kData+4*i;
+                        uint32_t d2;
+                        uint32_t index = nearestColor
+                        (
+                            packedPalette_.data(),
+                            nBlocks,
+                            c[0],
+                            c[1],
+                            c[2],
+                            d2
+                        );
+                        clusters[4*index]   += c[0];
+                        clusters[4*index+1] += c[1];
+                        clusters[4*index+2] += c[2];
+                        clusters[4*index+3] += 1;
+                        error += d2;
+                    }
+                    clusteringErrors_[chunk] = error;
+                }
+            );
+            uint64_t sqErr = 0;
+            for (uint32_t chunk=0; chunk<nThreads; chunk++)
+            {
+                sqErr += clusteringErrors_[chunk];
+                if (chunk == 0)
+                    continue;
+                for (uint32_t i=0; i<4*paletteSize; i++)
+                    clusterData_[i] += clusterData_[4*paletteSize*chunk+i];
+            }
+
+            // Quantize with currently available palette on break
+            if (sqErr >= (1.0-settings_.relTol)*sqErr0)
+                break;
+            sqErr0 = (double)sqErr;
+
+            // Update palette based on current clusters. Empty clusters are
+            // re-seeded with a (deterministically) randomly selected pixel
+            if (settings_.cumulatePalette)
+                cumulatedPaletteData_.resize
+                (
+                    std::max
+                    (
+                        cumulatedPaletteData_.size(),
+                        (size_t)4*paletteSize*(cumulatedPaletteRow_+1)
+                    ),
+                    0
+                );
+            for (uint32_t i=0; i<paletteSize; i++)
+            {
+                uint64_t* cluster = &clusterData_[4*i];
+                if (cluster[3] == 0)
+                {
+                    uint32_t p = hash((uint32_t)sqErr ^ hash(i+1)) % nKPixels;
+                    cluster[0] = kData[4*p];
+                    cluster[1] = kData[4*p+1];
+                    cluster[2] = kData[4*p+2];
+                    cluster[3] = 1;
+                }
+                for (uint32_t c=0; c<3; c++)
+                    palette_[3*i+c] = (unsigned char)(cluster[c]/cluster[3]);
+                if (settings_.cumulatePalette)
+                {
+                    unsigned char* color = &cumulatedPaletteData_
+                    [
+                        4*(paletteSize*cumulatedPaletteRow_+i)
+                    ];
+                    std::memcpy(color, &palette_[3*i], 3);
+                    color[3] = 255;
+                }
+            }
+            if (iteration == settings_.maxIterations)
+                break;
+        }
+
+        cumulatedPaletteRow_ =
+            settings_.cumulatePalette ?
+            (
+                ++cumulatedPaletteRow_ < maxNCumulatedPalettes_ ?
+                cumulatedPaletteRow_ : 0u
+            ) : 0u;
+    }
+
+    // Quantize input with k-means-determined palette
+    packPalette();
+    if (settings_.ditherMode != Settings::DitherMode::None)
+    {
+        if (settings_.ditherThreshold == 0)
+            settings_.ditherThreshold = 1.0f/std::sqrt(float(paletteSize));
+        else
+            settings_.ditherThreshold =
+                std::min(std::max(settings_.ditherThreshold,0.0f),1.0f);
+    }
+    int ditherOffsets2x2[4];
+    int ditherOffsets4x4[16];
+    for (int i=0; i<16; i++)
+    {
+        if (i < 4)
+            ditherOffsets2x2[i] =
+                int(256.0f*ditherMask2x2[i]*settings_.ditherThreshold+0.5f);
+        ditherOffsets4x4[i] =
+            int(256.0f*ditherMask4x4[i]*settings_.ditherThreshold+0.5f);
+    }
+    threadPool_.run
+    (
+        height,
+        [&](uint32_t, uint32_t begin, uint32_t end)
+        {
+            uint32_t nBlocks = (paletteSize+paletteBlockSize-1)/paletteBlockSize;
+            for (uint32_t y=begin; y<end; y++)
+            {
+                for (uint32_t x=0; x<width; x++)
+                {
+                    uint32_t i = y*width+x;
+                    const unsigned char* img = data+4*i;
+                    int offset = 0;
+                    switch (settings_.ditherMode)
+                    {
+                        case Settings::DitherMode::None :
+                            break;
+                        case Settings::DitherMode::Order2 :
+                            offset = ditherOffsets2x2[2*(y%2)+(x%2)];
+                            break;
+                        case Settings::DitherMode::Order4 :
+                            offset = ditherOffsets4x4[4*(y%4)+(x%4)];
+                            break;
+                    }
+                    uint32_t d2;
+                    uint32_t index = nearestColor
+                    (
+                        packedPalette_.data(),
+                        nBlocks,
+                        img[0]+offset,
+                        img[1]+offset,
+                        img[2]+offset,
+                        d2
+                    );
+                    unsigned char* newColor = &outputData_[4*i];
+                    std::memcpy(newColor, &palette_[3*index], 3);
+                    newColor[3] =
+                        (settings_.alphaCutoff != -1) ?
+                        (img[3] >= settings_.alphaCutoff ? 255 : 0) : img[3];
+                    if
+                    (
+                        settings_.indexMode == Settings::IndexMode::Alpha &&
+                        newColor[3] == 0
+                    )
+                        index = paletteSize;
+                    else if (settings_.indexMode == Settings::IndexMode::Delta)
+                    {
+                        unsigned char* oldColor = &oldQuantizedInput_[4*i];
+                        if
+                        (
+                            oldColor[3] > 0 &&
+                            std::memcmp(oldColor, newColor, 3) == 0
+                        )
+                            index = paletteSize;
+                        std::memcpy(oldColor, newColor, 4);
+                    }
+                    indexedData_[i] = (unsigned char)index;
+                }
+            }
+        }
+    );
+}
+
+// Expand the data read back in transferData_ to RGBA8 in inputData_ (a 
+// missing alpha channel is fully opaque, other missing channels are 0, as in
+// a GPU image load)
+void CPUQuantizer::expandInput
+(
+    uint32_t width,
+    uint32_t height,
+    uint32_t nChannels
+)
+{
+    inputData_.resize(4*width*height);
+    for (uint32_t i=0; i<width*height; i++)
+    {
+        for (uint32_t c=0; c<4; c++)
+            inputData_[4*i+c] = c < nChannels ?
+                transferData_[nChannels*i+c] : (c == 3 ? 255 : 0);
+    }
+}
+
+void CPUQuantizer::readInput(TextureBuffer2D* input)
+{
+    uint32_t width = input->width();
+    uint32_t height = input->height();
+    uint32_t nChannels = input->nChannels();
+    auto& target = nChannels == 4 ? inputData_ : transferData_;
+    target.resize(nChannels*width*height);
+    unsigned char* data = target.data();
+    input->readData(data);
+    if (nChannels != 4)
+        expandInput(width, height, nChannels);
+}
+
+void CPUQuantizer::readInput(Framebuffer* input)
+{
+    uint32_t width = input->width();
+    uint32_t height = input->height();
+    uint32_t nChannels = input->colorBufferNChannels();
+    auto& target = nChannels == 4 ? inputData_ : transferData_;
+    target.resize(nChannels*width*height);
+    unsigned char* data = target.data();
+    input->readColorBufferData(data);
+    if (nChannels != 4)
+        expandInput(width, height, nChannels);
+}
+
+// Pack the RGBA8 quantized data in transferData_ with the provided number of
+// channels, ready for upload
+void CPUQuantizer::packOutput(uint32_t nChannels)
+{
+    uint32_t nPixels = width_*height_;
+    transferData_.resize(nChannels*nPixels);
+    for (uint32_t i=0; i<nPixels; i++)
+    {
+        for (uint32_t c=0; c<nChannels; c++)
+            transferData_[nChannels*i+c] = outputData_[4*i+c];
+    }
+}
+
+//----------------------------------------------------------------------------//
+// Constructor
+
+CPUQuantizer::CPUQuantizer() :
+threadPool_(std::thread::hardware_concurrency())
+{
+    canRunOnDeviceInUse_ = true;
+}
+
+//
+void CPUQuantizer::quantize
+(
+    TextureBuffer2D* input,
+    unsigned int paletteSize,
+    const Settings& settings
+)
+{
+    if (input == nullptr)
+        return;
+    readInput(input);
+    quantizeData
+    (
+        inputData_.data(),
+        input->width(),
+        input->height(),
+        paletteSize,
+        settings
+    );
+    uint32_t nChannels = input->nChannels();
+    const unsigned char* data = outputData_.data();
+    if (nChannels != 4)
+    {
+        packOutput(nChannels);
+        data = transferData_.data();
+    }
+    if (settings_.overwriteInput)
+    {
+        input->writeData(data);
+        if (settings_.regenerateMipmap)
+            input->updateMipmap(false);
+        return;
+    }
+    prepareOutput(input);
+    output_->writeColorBufferData(data);
+    if (settings_.regenerateMipmap)
+        output_->updateColorBufferMipmap(false);
+}
+
+//
+void CPUQuantizer::quantize
+(
+    Framebuffer* input,
+    unsigned int paletteSize,
+    const Settings& settings
+)
+{
+    if (input == nullptr)
+        return;
+    readInput(input);
+    quantizeData
+    (
+        inputData_.data(),
+        input->width(),
+        input->height(),
+        paletteSize,
+        settings
+    );
+    uint32_t nChannels = input->colorBufferNChannels();
+    const unsigned char* data = outputData_.data();
+    if (nChannels != 4)
+    {
+        packOutput(nChannels);
+        data = transferData_.data();
+    }
+    if (settings_.overwriteInput)
+    {
+        input->writeColorBufferData(data);
+        if (settings_.regenerateMipmap)
+            input->updateColorBufferMipmap(false);
+        return;
+    }
+    prepareOutput(input);
+    output_->writeColorBufferData(data);
+    if (settings_.regenerateMipmap)
+        output_->updateColorBufferMipmap(false);
+}
+
+void CPUQuantizer::getPalette
+(
+    unsigned char*& data,
+    bool allocate,
+    bool cumulated
+)
+{
+    // Same as in the OpenGLQuantizer, requesting the cumulated palette amounts
+    // to quantizing the cumulated palettes image and returning the resulting
+    // palette
+    if (cumulated && cumulatedPaletteRow_ > 0)
+    {
+        Settings settings = {};
+        settings.fastKMeans = false;
+        settings.recalculatePalette = true;
+        settings.regenerateMipmap = false;
+        settings.reseedPalette = true;
+        std::vector<unsigned char> cumulatedPaletteData
+        (
+            cumulatedPaletteData_.begin(),
+            cumulatedPaletteData_.begin()+4*paletteSize_*cumulatedPaletteRow_
+        );
+        quantizeData
+        (
+            cumulatedPaletteData.data(),
+            paletteSize_,
+            cumulatedPaletteRow_,
+            paletteSize_,
+            settings
+        );
+        getPalette(data, allocate, false);
+        return;
+    }
+    bool nonDefaultIndexing(settings_.indexMode != Settings::IndexMode::Default);
+    int paletteSize = nonDefaultIndexing ? paletteSize_ + 1 : paletteSize_;
+    if (allocate)
+        data = new unsigned char[3*paletteSize];
+    std::memcpy(data, palette_.data(), 3*paletteSize_);
+    // Add a dummy color to correspond to the alpha/delta index
+    if (nonDefaultIndexing)
+    {
+        data[3*paletteSize-3] = (unsigned char)0;
+        data[3*paletteSize-2] = (unsigned char)0;
+        data[3*paletteSize-1] = (unsigned char)0;
+    }
+}
+
+void CPUQuantizer::getIndexedTexture
+(
+    unsigned char*& data,
+    bool allocate
+)
+{
+    int nPixels(width_*height_);
+    if (allocate)
+        data = new unsigned char[nPixels];
+    std::memcpy(data, indexedData_.data(), nPixels*sizeof(unsigned char));
+}
+
+}
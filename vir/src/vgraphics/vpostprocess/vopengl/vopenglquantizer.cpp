@@ -1,5 +1,6 @@
 #include "vpch.h"
 #include <cmath>
+#include <cstring>
 #include "vgraphics/vpostprocess/vopengl/vopenglquantizer.h"
 #include "vgraphics/vcore/vopengl/vopenglmisc.h"
 
@@ -10,16 +11,46 @@ namespace vir
 
 bool OpenGLQuantizer::computeShaderStagesCompiled = false;
 
-OpenGLComputeShader 
+// All compute stages operating on image pixels run on work groups of 
+// tileSize x tileSize invocations (must match their local_size), which 
+// cache the palette in shared memory and reduce their results locally before
+// touching global memory
+static const int tileSize = 16;
+
+static int nTiles(int n)
+{
+    return (n+tileSize-1)/tileSize;
+}
+
+// Size of the clustering error, convergence flag and previous clustering 
+// error at the start of the SSBO, followed by any per-pixel or per-work-group
+// data
+static const GLsizeiptr ssboHeaderSize = 3*sizeof(uint32_t);
+
+// Max number of pixels of the (possibly downsampled) image for which the 
+// palette seeding is carried out in a single work group
+static const int maxNPixelsSingleDispatchSeeding = 1<<18;
+
+OpenGLComputeShader
     OpenGLQuantizer::computeShader_findMaxSqrDistColSF32
     (
 R"(#version 430 core
+#define TILE_SIZE 256
 uniform int counter;
 uniform int paletteSize;
-layout(std430) coherent buffer ssbo {uint clusteringError;};
+layout(std430) coherent buffer ssbo
+{
+    uint clusteringError;
+    uint converged;
+    float sqErr0;
+    uint groupData[];
+};
 layout(rgba32f, binding=0) uniform image2D image;
 layout(r32ui, binding=1) uniform uimage2D paletteData;
-layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+shared ivec3 palette[256];
+shared uint groupD2[TILE_SIZE];
+shared uint groupPos[TILE_SIZE];
 uvec4 to8ui(vec4 v)
 {
     return uvec4(255.0*min(max(v, 0), 1)+.5);
@@ -27,7 +58,7 @@ uvec4 to8ui(vec4 v)
 void main()
 {
     ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
-    ivec2 d2MaxPos = ivec2(paletteSize+1,2);
+    int lid = int(gl_LocalInvocationIndex);
     if (counter == 0)
     {
         if (gid == ivec2(0,0))
@@ -43,30 +74,64 @@ void main()
             imageAtomicExchange(paletteData, ivec2(0, 0), img.r);
             imageAtomicExchange(paletteData, ivec2(1, 0), img.g);
             imageAtomicExchange(paletteData, ivec2(2, 0), img.b);
-            imageAtomicExchange(paletteData, d2MaxPos, 0);
             atomicExchange(clusteringError, 0);
         }
         return;
     }
-    uint d2m = 195075;
-    ivec3 img = ivec3(to8ui(imageLoad(image, gid)).rgb);
-    for (int i=0; i<counter; i++)
+    if (lid < counter)
     {
-        uint pr = imageLoad(paletteData, ivec2(3*i, 0)).r;
-        uint pg = imageLoad(paletteData, ivec2(3*i+1, 0)).r;
-        uint pb = imageLoad(paletteData, ivec2(3*i+2, 0)).r;
-        ivec3 dif = img-ivec3(pr,pg,pb);
-        uint d2 = dif.x*dif.x + dif.y*dif.y + dif.z*dif.z;
-        if (d2 < d2m)
+        palette[lid] = ivec3
+        (
+            imageLoad(paletteData, ivec2(3*lid,   0)).r,
+            imageLoad(paletteData, ivec2(3*lid+1, 0)).r,
+            imageLoad(paletteData, ivec2(3*lid+2, 0)).r
+        );
+    }
+    memoryBarrierShared();
+    barrier();
+    ivec2 size = imageSize(image);
+    uint d2m = 0;
+    uint pos = 0xFFFFFFFFu;
+    if (all(lessThan(gid, size)))
+    {
+        d2m = 195075;
+        ivec3 img = ivec3(to8ui(imageLoad(image, gid)).rgb);
+        for (int i=0; i<counter; i++)
         {
-            d2m = d2;
+            ivec3 dif = img-palette[i];
+            d2m = min(d2m, uint(dif.x*dif.x + dif.y*dif.y + dif.z*dif.z));
         }
+        pos = uint(gid.y*size.x+gid.x);
     }
-    uint d2m0 = imageAtomicMax(paletteData, d2MaxPos, d2m);
-    if (d2m0 < d2m)
+    groupD2[lid] = d2m;
+    groupPos[lid] = pos;
+    memoryBarrierShared();
+    barrier();
+    for (int s=TILE_SIZE/2; s>0; s>>=1)
     {
-        imageAtomicExchange(paletteData, ivec2(paletteSize+2,2), uint(gid.x));
-        imageAtomicExchange(paletteData, ivec2(paletteSize+3,2), uint(gid.y));
+        if 
+        (
+            lid < s && 
+            (
+                groupD2[lid+s] > groupD2[lid] || 
+                (
+                    groupD2[lid+s] == groupD2[lid] && 
+                    groupPos[lid+s] < groupPos[lid]
+                )
+            )
+        )
+        {
+            groupD2[lid] = groupD2[lid+s];
+            groupPos[lid] = groupPos[lid+s];
+        }
+        memoryBarrierShared();
+        barrier();
+    }
+    if (lid == 0)
+    {
+        uint group = gl_WorkGroupID.y*gl_NumWorkGroups.x+gl_WorkGroupID.x;
+        groupData[2*group] = groupD2[0];
+        groupData[2*group+1] = groupPos[0];
     }
 })" );
 
@@ -74,27 +139,181 @@ OpenGLComputeShader
     OpenGLQuantizer::computeShader_setNextPaletteColSF32
     (
 R"(#version 430 core
+#define TILE_SIZE 256
 uniform int counter;
+uniform int nGroups;
+layout(std430) coherent buffer ssbo
+{
+    uint clusteringError;
+    uint converged;
+    float sqErr0;
+    uint groupData[];
+};
+layout(rgba32f, binding=0) uniform image2D image;
+layout(r32ui, binding=1) uniform uimage2D paletteData;
+layout(local_size_x = TILE_SIZE, local_size_y = 1, local_size_z = 1) in;
+shared uint groupD2[TILE_SIZE];
+shared uint groupPos[TILE_SIZE];
+uvec4 to8ui(vec4 v)
+{
+    return uvec4(255.0*min(max(v, 0), 1)+.5);
+}
+void main()
+{
+    int lid = int(gl_LocalInvocationIndex);
+    uint d2m = 0;
+    uint pos = 0xFFFFFFFFu;
+    for (int i=lid; i<nGroups; i+=TILE_SIZE)
+    {
+        uint d2 = groupData[2*i];
+        uint p = groupData[2*i+1];
+        if (d2 > d2m || (d2 == d2m && p < pos))
+        {
+            d2m = d2;
+            pos = p;
+        }
+    }
+    groupD2[lid] = d2m;
+    groupPos[lid] = pos;
+    memoryBarrierShared();
+    barrier();
+    for (int s=TILE_SIZE/2; s>0; s>>=1)
+    {
+        if 
+        (
+            lid < s && 
+            (
+                groupD2[lid+s] > groupD2[lid] || 
+                (
+                    groupD2[lid+s] == groupD2[lid] && 
+                    groupPos[lid+s] < groupPos[lid]
+                )
+            )
+        )
+        {
+            groupD2[lid] = groupD2[lid+s];
+            groupPos[lid] = groupPos[lid+s];
+        }
+        memoryBarrierShared();
+        barrier();
+    }
+    if (lid == 0)
+    {
+        int width = imageSize(image).x;
+        ivec2 xy = ivec2(groupPos[0]%uint(width), groupPos[0]/uint(width));
+        uvec4 img = to8ui(imageLoad(image, xy));
+        imageStore(paletteData, ivec2(3*counter,0), uvec4(img.r,0,0,1));
+        imageStore(paletteData, ivec2(3*counter+1,0), uvec4(img.g,0,0,1));
+        imageStore(paletteData, ivec2(3*counter+2,0), uvec4(img.b,0,0,1));
+    }
+})" );
+
+OpenGLComputeShader
+    OpenGLQuantizer::computeShader_seedPaletteSF32
+    (
+R"(#version 430 core
+#define GROUP_SIZE 1024
 uniform int paletteSize;
+layout(std430) coherent buffer ssbo
+{
+    uint clusteringError;
+    uint converged;
+    float sqErr0;
+    uint minSqrDist[];
+};
 layout(rgba32f, binding=0) uniform image2D image;
 layout(r32ui, binding=1) uniform uimage2D paletteData;
-layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+layout(local_size_x = GROUP_SIZE, local_size_y = 1, local_size_z = 1) in;
+shared uint groupD2[GROUP_SIZE];
+shared uint groupPos[GROUP_SIZE];
+shared ivec3 nextColor;
 uvec4 to8ui(vec4 v)
 {
-    return uvec4(255*min(max(v, 0), 1)+.5);
+    return uvec4(255.0*min(max(v, 0), 1)+.5);
+}
+ivec3 loadPixel(int i, int width)
+{
+    return ivec3(to8ui(imageLoad(image, ivec2(i%width, i/width))).rgb);
 }
 void main()
 {
-    if (counter == 0)
-        return;
-    uint x = imageLoad(paletteData, ivec2(paletteSize+2,2)).r;
-    uint y = imageLoad(paletteData, ivec2(paletteSize+3,2)).r;
-    uvec4 img = to8ui(imageLoad(image, ivec2(x,y)));
-    imageStore(paletteData, ivec2(3*counter,0), uvec4(img.r,0,0,1));
-    imageStore(paletteData, ivec2(3*counter+1,0), uvec4(img.g,0,0,1));
-    imageStore(paletteData, ivec2(3*counter+2,0), uvec4(img.b,0,0,1));
-    ivec2 d2MaxPos = ivec2(paletteSize+1,2);
-    imageStore(paletteData, d2MaxPos, uvec4(0,0,0,0));
+    int lid = int(gl_LocalInvocationIndex);
+    ivec2 size = imageSize(image);
+    int nPixels = size.x*size.y;
+    for (int i=lid; i<9*paletteSize; i+=GROUP_SIZE)
+        imageStore(paletteData, ivec2(i%(3*paletteSize), i/(3*paletteSize)), uvec4(0));
+    // Each invocation only ever accesses its own (strided) pixels in 
+    // minSqrDist, i.e., the min squared distance of each pixel from the 
+    // palette colors selected so far
+    for (int i=lid; i<nPixels; i+=GROUP_SIZE)
+        minSqrDist[i] = 195075;
+    if (lid == 0)
+    {
+        atomicExchange(clusteringError, 0);
+        nextColor = loadPixel(0, size.x);
+    }
+    memoryBarrierImage();
+    memoryBarrierShared();
+    barrier();
+    for (int counter=0; counter<paletteSize; counter++)
+    {
+        ivec3 color = nextColor;
+        if (lid == 0)
+        {
+            imageStore(paletteData, ivec2(3*counter,0), uvec4(color.r,0,0,1));
+            imageStore(paletteData, ivec2(3*counter+1,0), uvec4(color.g,0,0,1));
+            imageStore(paletteData, ivec2(3*counter+2,0), uvec4(color.b,0,0,1));
+        }
+        if (counter == paletteSize-1)
+            break;
+        // Find the pixel furthest away from all palette colors so far (the
+        // first one on ties), which becomes the next palette color
+        uint d2m = 0;
+        uint pos = uint(min(lid, nPixels-1));
+        for (int i=lid; i<nPixels; i+=GROUP_SIZE)
+        {
+            ivec3 dif = loadPixel(i, size.x)-color;
+            uint d2 = min
+            (
+                minSqrDist[i], 
+                uint(dif.x*dif.x + dif.y*dif.y + dif.z*dif.z)
+            );
+            minSqrDist[i] = d2;
+            if (d2 > d2m)
+            {
+                d2m = d2;
+                pos = uint(i);
+            }
+        }
+        groupD2[lid] = d2m;
+        groupPos[lid] = pos;
+        memoryBarrierShared();
+        barrier();
+        for (int s=GROUP_SIZE/2; s>0; s>>=1)
+        {
+            if 
+            (
+                lid < s && 
+                (
+                    groupD2[lid+s] > groupD2[lid] || 
+                    (
+                        groupD2[lid+s] == groupD2[lid] && 
+                        groupPos[lid+s] < groupPos[lid]
+                    )
+                )
+            )
+            {
+                groupD2[lid] = groupD2[lid+s];
+                groupPos[lid] = groupPos[lid+s];
+            }
+            memoryBarrierShared();
+            barrier();
+        }
+        if (lid == 0)
+            nextColor = loadPixel(int(groupPos[0]), size.x);
+        memoryBarrierShared();
+        barrier();
+    }
 })" );
 
 OpenGLComputeShader
@@ -102,45 +321,93 @@ OpenGLComputeShader
     (
 R"(#version 430 core
 uniform int paletteSize;
-layout(std430) coherent buffer ssbo {uint clusteringError;};
+layout(std430) coherent buffer ssbo
+{
+    uint clusteringError;
+    uint converged;
+    float sqErr0;
+};
 layout(rgba32f, binding=1) uniform image2D image;
 layout(r32ui, binding=2) uniform uimage2D paletteData;
-layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+shared ivec3 palette[256];
+shared uint clusters[4*256];
+shared uint groupError;
 uvec4 to8ui(vec4 v)
 {
-    return uvec4(255*min(max(v, 0), 1)+.5);
+    return uvec4(255.0*min(max(v, 0), 1)+.5);
 }
 void main() 
 { 
+    // Nothing to do once the KMeans has converged
+    if (converged != 0)
+        return;
     ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
-    uvec4 img = to8ui(imageLoad(image, gid));
-    int d2m = 195075; // max d2 is 3*255*255 = 195075
-    int index = 0;
-    for (int i=0; i<paletteSize; i++)
+    int lid = int(gl_LocalInvocationIndex);
+    if (lid < paletteSize)
     {
-        ivec3 d = ivec3(img);
-        d.x -= int(imageLoad(paletteData, ivec2(i*3,   0)).r);
-        d.y -= int(imageLoad(paletteData, ivec2(i*3+1, 0)).r);
-        d.z -= int(imageLoad(paletteData, ivec2(i*3+2, 0)).r);
-        int d2 = d.x*d.x + d.y*d.y + d.z*d.z;
-        if (d2 < d2m)
+        palette[lid] = ivec3
+        (
+            imageLoad(paletteData, ivec2(3*lid,   0)).r,
+            imageLoad(paletteData, ivec2(3*lid+1, 0)).r,
+            imageLoad(paletteData, ivec2(3*lid+2, 0)).r
+        );
+        clusters[4*lid]   = 0;
+        clusters[4*lid+1] = 0;
+        clusters[4*lid+2] = 0;
+        clusters[4*lid+3] = 0;
+    }
+    if (lid == 0)
+        groupError = 0;
+    memoryBarrierShared();
+    barrier();
+    if (all(lessThan(gid, imageSize(image))))
+    {
+        uvec4 img = to8ui(imageLoad(image, gid));
+        int d2m = 195075; // max d2 is 3*255*255 = 195075
+        int index = 0;
+        for (int i=0; i<paletteSize; i++)
         {
-            d2m = d2;
-            index = i;
+            ivec3 d = ivec3(img.rgb)-palette[i];
+            int d2 = d.x*d.x + d.y*d.y + d.z*d.z;
+            if (d2 < d2m)
+            {
+                d2m = d2;
+                index = i;
+            }
         }
+        atomicAdd(clusters[4*index],   img.r);
+        atomicAdd(clusters[4*index+1], img.g);
+        atomicAdd(clusters[4*index+2], img.b);
+        atomicAdd(clusters[4*index+3], 1u);
+        atomicAdd(groupError, uint(d2m));
     }
-    imageAtomicAdd(paletteData, ivec2(index*3,   1), img.r);
-    imageAtomicAdd(paletteData, ivec2(index*3+1, 1), img.g);
-    imageAtomicAdd(paletteData, ivec2(index*3+2, 1), img.b);
-    imageAtomicAdd(paletteData, ivec2(index,     2), 1);
-    atomicAdd(clusteringError, uint(d2m));
+    memoryBarrierShared();
+    barrier();
+    // Flush the work group partial sums, one global atomic per non-empty
+    // cluster instead of one per pixel
+    if (lid < paletteSize && clusters[4*lid+3] > 0)
+    {
+        imageAtomicAdd(paletteData, ivec2(lid*3,   1), clusters[4*lid]);
+        imageAtomicAdd(paletteData, ivec2(lid*3+1, 1), clusters[4*lid+1]);
+        imageAtomicAdd(paletteData, ivec2(lid*3+2, 1), clusters[4*lid+2]);
+        imageAtomicAdd(paletteData, ivec2(lid,     2), clusters[4*lid+3]);
+    }
+    if (lid == 0 && groupError > 0)
+        atomicAdd(clusteringError, groupError);
 })" );
 
 OpenGLComputeShader
     OpenGLQuantizer::computeShader_updatePaletteFromClustersSF32
     (
 R"(#version 430 core
-layout(std430) coherent buffer ssbo {uint clusteringError;};
+uniform int paletteSize;
+layout(std430) coherent buffer ssbo
+{
+    uint clusteringError;
+    uint converged;
+    float sqErr0;
+};
 layout(r32ui, binding=1) uniform uimage2D paletteData;
 layout(rgba32f, binding=2) uniform image2D image;
 layout(rgba8ui, binding=3) uniform uimage2D cumulatedPaletteData;
@@ -148,24 +415,67 @@ uniform int imageWidth;
 uniform int imageHeight;
 uniform int cumulatedPaletteRow;
 uniform int cumulatePalette;
-layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+uniform int checkConvergence;
+uniform float relTol;
+layout(local_size_x = 256, local_size_y = 1, local_size_z = 1) in;
+shared float error;
+shared bool skip;
+shared bool hasConverged;
 float rand(vec2 seed)
 {
     return fract(sin(dot(seed.xy, vec2(12.9898, 78.233)))*43758.5453);
 }
 uvec4 to8ui(vec4 v)
 {
-    return uvec4(255*min(max(v, 0), 1)+.5);
+    return uvec4(255.0*min(max(v, 0), 1)+.5);
 }
 void main() 
 { 
-    uint gid = gl_GlobalInvocationID.x;
+    uint gid = gl_LocalInvocationIndex;
+    // Read & clear the clustering error for the next iteration, once all 
+    // invocations have read it. If requested, check for convergence here
+    // instead of on the host: on convergence, the palette is left as is and
+    // all following KMeans dispatches are skipped
+    if (gid == 0)
+    {
+        error = float(clusteringError);
+        skip = converged != 0;
+        hasConverged = false;
+        if (checkConvergence == 1 && !skip)
+        {
+            if (error >= (1.0-relTol)*sqErr0)
+            {
+                converged = 1;
+                skip = true;
+                hasConverged = true;
+            }
+            else
+                sqErr0 = error;
+        }
+    }
+    memoryBarrierShared();
+    barrier();
+    if (gid == 0 && (!skip || hasConverged))
+        atomicExchange(clusteringError, 0);
+    if (gid >= paletteSize)
+        return;
+    if (skip)
+    {
+        // Clear the accumulators left by the last clustering
+        if (hasConverged)
+        {
+            imageAtomicExchange(paletteData, ivec2(gid*3, 1), 0);
+            imageAtomicExchange(paletteData, ivec2(gid*3+1, 1), 0);
+            imageAtomicExchange(paletteData, ivec2(gid*3+2, 1), 0);
+            imageAtomicExchange(paletteData, ivec2(gid, 2), 0);
+        }
+        return;
+    }
     // Read & clear accumulators for next counter loop iteration
     uint r = imageAtomicExchange(paletteData, ivec2(gid*3, 1), 0);
     uint g = imageAtomicExchange(paletteData, ivec2(gid*3+1, 1), 0);
     uint b = imageAtomicExchange(paletteData, ivec2(gid*3+2, 1), 0);
     uint count = imageAtomicExchange(paletteData, ivec2(gid, 2), 0);
-    float error = float(atomicExchange(clusteringError, 0));
     if (count == 0)
     {
         count = 1;
@@ -200,7 +510,8 @@ layout(rgba32f, binding=4) uniform image2D outputImage;
 layout(r32ui, binding=1) uniform uimage2D paletteData;
 layout(r8ui, binding=2) uniform uimage2D indexedImage;
 layout(rgba32f, binding=3) uniform image2D oldQuantizedImage;
-layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+shared ivec3 palette[256];
 const float ditherMask2x2[4] = float[4]
 (
     0.0 /4.0-3.0/8.0,
@@ -233,7 +544,7 @@ const float ditherMask4x4[16] = float[16]
 );
 uvec4 to8ui(vec4 v)
 {
-    return uvec4(255*min(max(v, 0), 1)+.5);
+    return uvec4(255.0*min(max(v, 0), 1)+.5);
 }
 vec4 to32f(uvec4 v)
 {
@@ -242,6 +553,20 @@ vec4 to32f(uvec4 v)
 void main() 
 { 
     ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
+    int lid = int(gl_LocalInvocationIndex);
+    if (lid < paletteSize)
+    {
+        palette[lid] = ivec3
+        (
+            imageLoad(paletteData, ivec2(3*lid,   0)).r,
+            imageLoad(paletteData, ivec2(3*lid+1, 0)).r,
+            imageLoad(paletteData, ivec2(3*lid+2, 0)).r
+        );
+    }
+    memoryBarrierShared();
+    barrier();
+    if (any(greaterThanEqual(gid, imageSize(inputImage))))
+        return;
     uvec4 img = to8ui(imageLoad(inputImage, gid));
     switch (ditherLevel)
     {
@@ -266,10 +591,7 @@ void main()
     int index = 0;
     for (int i=0; i<paletteSize; i++)
     {
-        ivec3 d = ivec3(img);
-        d.x -= int(imageLoad(paletteData, ivec2(i*3,   0)).r);
-        d.y -= int(imageLoad(paletteData, ivec2(i*3+1, 0)).r);
-        d.z -= int(imageLoad(paletteData, ivec2(i*3+2, 0)).r);
+        ivec3 d = ivec3(img.rgb)-palette[i];
         int d2 = d.x*d.x + d.y*d.y + d.z*d.z;
         if (d2 < d2m)
         {
@@ -277,11 +599,9 @@ void main()
             index = i;
         }
     }
-    uint r = imageLoad(paletteData, ivec2(index*3,   0)).r;
-    uint g = imageLoad(paletteData, ivec2(index*3+1, 0)).r;
-    uint b = imageLoad(paletteData, ivec2(index*3+2, 0)).r;
+    uvec3 color = uvec3(palette[index]);
     uint a = (alphaCutoff != -1) ? ((img.a >= alphaCutoff ? 255 : 0)) : img.a;
-    uvec4 newColor = uvec4(r,g,b,a);
+    uvec4 newColor = uvec4(color,a);
     if (indexMode == 1 && a == 0)
         index = paletteSize;
     else if (indexMode == 2)
@@ -300,20 +620,31 @@ void main()
 // Same compute shaders as above, but to operate on unsigned int and unsigned
 // normlaized int -type of textures
 
+
 OpenGLComputeShader
     OpenGLQuantizer::computeShader_findMaxSqrDistColUI8
     (
 R"(#version 430 core
+#define TILE_SIZE 256
 uniform int counter;
 uniform int paletteSize;
-layout(std430) coherent buffer ssbo {uint clusteringError;};
+layout(std430) coherent buffer ssbo
+{
+    uint clusteringError;
+    uint converged;
+    float sqErr0;
+    uint groupData[];
+};
 layout(rgba8ui, binding=0) uniform uimage2D image;
 layout(r32ui, binding=1) uniform uimage2D paletteData;
-layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+shared ivec3 palette[256];
+shared uint groupD2[TILE_SIZE];
+shared uint groupPos[TILE_SIZE];
 void main()
 {
     ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
-    ivec2 d2MaxPos = ivec2(paletteSize+1,2);
+    int lid = int(gl_LocalInvocationIndex);
     if (counter == 0)
     {
         if (gid == ivec2(0,0))
@@ -329,30 +660,64 @@ void main()
             imageAtomicExchange(paletteData, ivec2(0, 0), img.r);
             imageAtomicExchange(paletteData, ivec2(1, 0), img.g);
             imageAtomicExchange(paletteData, ivec2(2, 0), img.b);
-            imageAtomicExchange(paletteData, d2MaxPos, 0);
             atomicExchange(clusteringError, 0);
         }
         return;
     }
-    uint d2m = 195075;
-    ivec3 img = ivec3(imageLoad(image, gid).rgb);
-    for (int i=0; i<counter; i++)
+    if (lid < counter)
     {
-        uint pr = imageLoad(paletteData, ivec2(3*i, 0)).r;
-        uint pg = imageLoad(paletteData, ivec2(3*i+1, 0)).r;
-        uint pb = imageLoad(paletteData, ivec2(3*i+2, 0)).r;
-        ivec3 dif = img-ivec3(pr,pg,pb);
-        uint d2 = dif.x*dif.x + dif.y*dif.y + dif.z*dif.z;
-        if (d2 < d2m)
+        palette[lid] = ivec3
+        (
+            imageLoad(paletteData, ivec2(3*lid,   0)).r,
+            imageLoad(paletteData, ivec2(3*lid+1, 0)).r,
+            imageLoad(paletteData, ivec2(3*lid+2, 0)).r
+        );
+    }
+    memoryBarrierShared();
+    barrier();
+    ivec2 size = imageSize(image);
+    uint d2m = 0;
+    uint pos = 0xFFFFFFFFu;
+    if (all(lessThan(gid, size)))
+    {
+        d2m = 195075;
+        ivec3 img = ivec3(imageLoad(image, gid).rgb);
+        for (int i=0; i<counter; i++)
         {
-            d2m = d2;
+            ivec3 dif = img-palette[i];
+            d2m = min(d2m, uint(dif.x*dif.x + dif.y*dif.y + dif.z*dif.z));
+        }
+        pos = uint(gid.y*size.x+gid.x);
+    }
+    groupD2[lid] = d2m;
+    groupPos[lid] = pos;
+    memoryBarrierShared();
+    barrier();
+    for (int s=TILE_SIZE/2; s>0; s>>=1)
+    {
+        if 
+        (
+            lid < s && 
+            (
+                groupD2[lid+s] > groupD2[lid] || 
+                (
+                    groupD2[lid+s] == groupD2[lid] && 
+                    groupPos[lid+s] < groupPos[lid]
+                )
+            )
+        )
+        {
+            groupD2[lid] = groupD2[lid+s];
+            groupPos[lid] = groupPos[lid+s];
         }
+        memoryBarrierShared();
+        barrier();
     }
-    uint d2m0 = imageAtomicMax(paletteData, d2MaxPos, d2m);
-    if (d2m0 < d2m)
+    if (lid == 0)
     {
-        imageAtomicExchange(paletteData, ivec2(paletteSize+2,2), uint(gid.x));
-        imageAtomicExchange(paletteData, ivec2(paletteSize+3,2), uint(gid.y));
+        uint group = gl_WorkGroupID.y*gl_NumWorkGroups.x+gl_WorkGroupID.x;
+        groupData[2*group] = groupD2[0];
+        groupData[2*group+1] = groupPos[0];
     }
 })" );
 
@@ -360,23 +725,173 @@ OpenGLComputeShader
     OpenGLQuantizer::computeShader_setNextPaletteColUI8
     (
 R"(#version 430 core
+#define TILE_SIZE 256
 uniform int counter;
+uniform int nGroups;
+layout(std430) coherent buffer ssbo
+{
+    uint clusteringError;
+    uint converged;
+    float sqErr0;
+    uint groupData[];
+};
+layout(rgba8ui, binding=0) uniform uimage2D image;
+layout(r32ui, binding=1) uniform uimage2D paletteData;
+layout(local_size_x = TILE_SIZE, local_size_y = 1, local_size_z = 1) in;
+shared uint groupD2[TILE_SIZE];
+shared uint groupPos[TILE_SIZE];
+void main()
+{
+    int lid = int(gl_LocalInvocationIndex);
+    uint d2m = 0;
+    uint pos = 0xFFFFFFFFu;
+    for (int i=lid; i<nGroups; i+=TILE_SIZE)
+    {
+        uint d2 = groupData[2*i];
+        uint p = groupData[2*i+1];
+        if (d2 > d2m || (d2 == d2m && p < pos))
+        {
+            d2m = d2;
+            pos = p;
+        }
+    }
+    groupD2[lid] = d2m;
+    groupPos[lid] = pos;
+    memoryBarrierShared();
+    barrier();
+    for (int s=TILE_SIZE/2; s>0; s>>=1)
+    {
+        if 
+        (
+            lid < s && 
+            (
+                groupD2[lid+s] > groupD2[lid] || 
+                (
+                    groupD2[lid+s] == groupD2[lid] && 
+                    groupPos[lid+s] < groupPos[lid]
+                )
+            )
+        )
+        {
+            groupD2[lid] = groupD2[lid+s];
+            groupPos[lid] = groupPos[lid+s];
+        }
+        memoryBarrierShared();
+        barrier();
+    }
+    if (lid == 0)
+    {
+        int width = imageSize(image).x;
+        ivec2 xy = ivec2(groupPos[0]%uint(width), groupPos[0]/uint(width));
+        uvec4 img = imageLoad(image, xy);
+        imageStore(paletteData, ivec2(3*counter,0), uvec4(img.r,0,0,1));
+        imageStore(paletteData, ivec2(3*counter+1,0), uvec4(img.g,0,0,1));
+        imageStore(paletteData, ivec2(3*counter+2,0), uvec4(img.b,0,0,1));
+    }
+})" );
+
+OpenGLComputeShader
+    OpenGLQuantizer::computeShader_seedPaletteUI8
+    (
+R"(#version 430 core
+#define GROUP_SIZE 1024
 uniform int paletteSize;
+layout(std430) coherent buffer ssbo
+{
+    uint clusteringError;
+    uint converged;
+    float sqErr0;
+    uint minSqrDist[];
+};
 layout(rgba8ui, binding=0) uniform uimage2D image;
 layout(r32ui, binding=1) uniform uimage2D paletteData;
-layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+layout(local_size_x = GROUP_SIZE, local_size_y = 1, local_size_z = 1) in;
+shared uint groupD2[GROUP_SIZE];
+shared uint groupPos[GROUP_SIZE];
+shared ivec3 nextColor;
+ivec3 loadPixel(int i, int width)
+{
+    return ivec3(imageLoad(image, ivec2(i%width, i/width)).rgb);
+}
 void main()
 {
-    if (counter == 0)
-        return;
-    uint x = imageLoad(paletteData, ivec2(paletteSize+2,2)).r;
-    uint y = imageLoad(paletteData, ivec2(paletteSize+3,2)).r;
-    uvec4 img = imageLoad(image, ivec2(x,y));
-    imageStore(paletteData, ivec2(3*counter,0), uvec4(img.r,0,0,1));
-    imageStore(paletteData, ivec2(3*counter+1,0), uvec4(img.g,0,0,1));
-    imageStore(paletteData, ivec2(3*counter+2,0), uvec4(img.b,0,0,1));
-    ivec2 d2MaxPos = ivec2(paletteSize+1,2);
-    imageStore(paletteData, d2MaxPos, uvec4(0,0,0,0));
+    int lid = int(gl_LocalInvocationIndex);
+    ivec2 size = imageSize(image);
+    int nPixels = size.x*size.y;
+    for (int i=lid; i<9*paletteSize; i+=GROUP_SIZE)
+        imageStore(paletteData, ivec2(i%(3*paletteSize), i/(3*paletteSize)), uvec4(0));
+    // Each invocation only ever accesses its own (strided) pixels in 
+    // minSqrDist, i.e., the min squared distance of each pixel from the 
+    // palette colors selected so far
+    for (int i=lid; i<nPixels; i+=GROUP_SIZE)
+        minSqrDist[i] = 195075;
+    if (lid == 0)
+    {
+        atomicExchange(clusteringError, 0);
+        nextColor = loadPixel(0, size.x);
+    }
+    memoryBarrierImage();
+    memoryBarrierShared();
+    barrier();
+    for (int counter=0; counter<paletteSize; counter++)
+    {
+        ivec3 color = nextColor;
+        if (lid == 0)
+        {
+            imageStore(paletteData, ivec2(3*counter,0), uvec4(color.r,0,0,1));
+            imageStore(paletteData, ivec2(3*counter+1,0), uvec4(color.g,0,0,1));
+            imageStore(paletteData, ivec2(3*counter+2,0), uvec4(color.b,0,0,1));
+        }
+        if (counter == paletteSize-1)
+            break;
+        // Find the pixel furthest away from all palette colors so far (the
+        // first one on ties), which becomes the next palette color
+        uint d2m = 0;
+        uint pos = uint(min(lid, nPixels-1));
+        for (int i=lid; i<nPixels; i+=GROUP_SIZE)
+        {
+            ivec3 dif = loadPixel(i, size.x)-color;
+            uint d2 = min
+            (
+                minSqrDist[i], 
+                uint(dif.x*dif.x + dif.y*dif.y + dif.z*dif.z)
+            );
+            minSqrDist[i] = d2;
+            if (d2 > d2m)
+            {
+                d2m = d2;
+                pos = uint(i);
+            }
+        }
+        groupD2[lid] = d2m;
+        groupPos[lid] = pos;
+        memoryBarrierShared();
+        barrier();
+        for (int s=GROUP_SIZE/2; s>0; s>>=1)
+        {
+            if 
+            (
+                lid < s && 
+                (
+                    groupD2[lid+s] > groupD2[lid] || 
+                    (
+                        groupD2[lid+s] == groupD2[lid] && 
+                        groupPos[lid+s] < groupPos[lid]
+                    )
+                )
+            )
+            {
+                groupD2[lid] = groupD2[lid+s];
+                groupPos[lid] = groupPos[lid+s];
+            }
+            memoryBarrierShared();
+            barrier();
+        }
+        if (lid == 0)
+            nextColor = loadPixel(int(groupPos[0]), size.x);
+        memoryBarrierShared();
+        barrier();
+    }
 })" );
 
 OpenGLComputeShader
@@ -384,41 +899,89 @@ OpenGLComputeShader
     (
 R"(#version 430 core
 uniform int paletteSize;
-layout(std430) coherent buffer ssbo {uint clusteringError;};
+layout(std430) coherent buffer ssbo
+{
+    uint clusteringError;
+    uint converged;
+    float sqErr0;
+};
 layout(rgba8ui, binding=1) uniform uimage2D image;
 layout(r32ui, binding=2) uniform uimage2D paletteData;
-layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+shared ivec3 palette[256];
+shared uint clusters[4*256];
+shared uint groupError;
 void main() 
 { 
+    // Nothing to do once the KMeans has converged
+    if (converged != 0)
+        return;
     ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
-    uvec4 img = uvec4(imageLoad(image, gid));
-    int d2m = 195075; // max d2 is 3*255*255 = 195075
-    int index = 0;
-    for (int i=0; i<paletteSize; i++)
+    int lid = int(gl_LocalInvocationIndex);
+    if (lid < paletteSize)
     {
-        ivec3 d = ivec3(img);
-        d.x -= int(imageLoad(paletteData, ivec2(i*3,   0)).r);
-        d.y -= int(imageLoad(paletteData, ivec2(i*3+1, 0)).r);
-        d.z -= int(imageLoad(paletteData, ivec2(i*3+2, 0)).r);
-        int d2 = d.x*d.x + d.y*d.y + d.z*d.z;
-        if (d2 < d2m)
+        palette[lid] = ivec3
+        (
+            imageLoad(paletteData, ivec2(3*lid,   0)).r,
+            imageLoad(paletteData, ivec2(3*lid+1, 0)).r,
+            imageLoad(paletteData, ivec2(3*lid+2, 0)).r
+        );
+        clusters[4*lid]   = 0;
+        clusters[4*lid+1] = 0;
+        clusters[4*lid+2] = 0;
+        clusters[4*lid+3] = 0;
+    }
+    if (lid == 0)
+        groupError = 0;
+    memoryBarrierShared();
+    barrier();
+    if (all(lessThan(gid, imageSize(image))))
+    {
+        uvec4 img = imageLoad(image, gid);
+        int d2m = 195075; // max d2 is 3*255*255 = 195075
+        int index = 0;
+        for (int i=0; i<paletteSize; i++)
         {
-            d2m = d2;
-            index = i;
+            ivec3 d = ivec3(img.rgb)-palette[i];
+            int d2 = d.x*d.x + d.y*d.y + d.z*d.z;
+            if (d2 < d2m)
+            {
+                d2m = d2;
+                index = i;
+            }
         }
+        atomicAdd(clusters[4*index],   img.r);
+        atomicAdd(clusters[4*index+1], img.g);
+        atomicAdd(clusters[4*index+2], img.b);
+        atomicAdd(clusters[4*index+3], 1u);
+        atomicAdd(groupError, uint(d2m));
     }
-    imageAtomicAdd(paletteData, ivec2(index*3,   1), img.r);
-    imageAtomicAdd(paletteData, ivec2(index*3+1, 1), img.g);
-    imageAtomicAdd(paletteData, ivec2(index*3+2, 1), img.b);
-    imageAtomicAdd(paletteData, ivec2(index,     2), 1);
-    atomicAdd(clusteringError, uint(d2m));
+    memoryBarrierShared();
+    barrier();
+    // Flush the work group partial sums, one global atomic per non-empty
+    // cluster instead of one per pixel
+    if (lid < paletteSize && clusters[4*lid+3] > 0)
+    {
+        imageAtomicAdd(paletteData, ivec2(lid*3,   1), clusters[4*lid]);
+        imageAtomicAdd(paletteData, ivec2(lid*3+1, 1), clusters[4*lid+1]);
+        imageAtomicAdd(paletteData, ivec2(lid*3+2, 1), clusters[4*lid+2]);
+        imageAtomicAdd(paletteData, ivec2(lid,     2), clusters[4*lid+3]);
+    }
+    if (lid == 0 && groupError > 0)
+        atomicAdd(clusteringError, groupError);
 })" );
 
 OpenGLComputeShader
     OpenGLQuantizer::computeShader_updatePaletteFromClustersUI8
     (
 R"(#version 430 core
-layout(std430) coherent buffer ssbo {uint clusteringError;};
+uniform int paletteSize;
+layout(std430) coherent buffer ssbo
+{
+    uint clusteringError;
+    uint converged;
+    float sqErr0;
+};
 layout(r32ui, binding=1) uniform uimage2D paletteData;
 layout(rgba8ui, binding=2) uniform uimage2D image;
 layout(rgba8ui, binding=3) uniform uimage2D cumulatedPaletteData;
@@ -426,20 +989,63 @@ uniform int imageWidth;
 uniform int imageHeight;
 uniform int cumulatedPaletteRow;
 uniform int cumulatePalette;
-layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+uniform int checkConvergence;
+uniform float relTol;
+layout(local_size_x = 256, local_size_y = 1, local_size_z = 1) in;
+shared float error;
+shared bool skip;
+shared bool hasConverged;
 float rand(vec2 seed)
 {
     return fract(sin(dot(seed.xy, vec2(12.9898, 78.233)))*43758.5453);
 }
 void main() 
 { 
-    uint gid = gl_GlobalInvocationID.x;
+    uint gid = gl_LocalInvocationIndex;
+    // Read & clear the clustering error for the next iteration, once all 
+    // invocations have read it. If requested, check for convergence here
+    // instead of on the host: on convergence, the palette is left as is and
+    // all following KMeans dispatches are skipped
+    if (gid == 0)
+    {
+        error = float(clusteringError);
+        skip = converged != 0;
+        hasConverged = false;
+        if (checkConvergence == 1 && !skip)
+        {
+            if (error >= (1.0-relTol)*sqErr0)
+            {
+                converged = 1;
+                skip = true;
+                hasConverged = true;
+            }
+            else
+                sqErr0 = error;
+        }
+    }
+    memoryBarrierShared();
+    barrier();
+    if (gid == 0 && (!skip || hasConverged))
+        atomicExchange(clusteringError, 0);
+    if (gid >= paletteSize)
+        return;
+    if (skip)
+    {
+        // Clear the accumulators left by the last clustering
+        if (hasConverged)
+        {
+            imageAtomicExchange(paletteData, ivec2(gid*3, 1), 0);
+            imageAtomicExchange(paletteData, ivec2(gid*3+1, 1), 0);
+            imageAtomicExchange(paletteData, ivec2(gid*3+2, 1), 0);
+            imageAtomicExchange(paletteData, ivec2(gid, 2), 0);
+        }
+        return;
+    }
     // Read & clear accumulators for next counter loop iteration
     uint r = imageAtomicExchange(paletteData, ivec2(gid*3, 1), 0);
     uint g = imageAtomicExchange(paletteData, ivec2(gid*3+1, 1), 0);
     uint b = imageAtomicExchange(paletteData, ivec2(gid*3+2, 1), 0);
     uint count = imageAtomicExchange(paletteData, ivec2(gid, 2), 0);
-    float error = float(atomicExchange(clusteringError, 0));
     if (count == 0)
     {
         count = 1;
@@ -474,8 +1080,8 @@ layout(rgba8ui, binding=4) uniform uimage2D outputImage;
 layout(r32ui, binding=1) uniform uimage2D paletteData;
 layout(r8ui, binding=2) uniform uimage2D indexedImage;
 layout(rgba8ui, binding=3) uniform uimage2D oldQuantizedImage;
-layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
-
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+shared ivec3 palette[256];
 const float ditherMask2x2[4] = float[4]
 (
     0.0 /4.0-3.0/8.0,
@@ -506,11 +1112,24 @@ const float ditherMask4x4[16] = float[16]
     13.0 /16.0-15.0/32.0,
     5.0 /16.0-15.0/32.0
 );
-
 void main() 
 { 
     ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
-    uvec4 img = uvec4(imageLoad(inputImage, gid));
+    int lid = int(gl_LocalInvocationIndex);
+    if (lid < paletteSize)
+    {
+        palette[lid] = ivec3
+        (
+            imageLoad(paletteData, ivec2(3*lid,   0)).r,
+            imageLoad(paletteData, ivec2(3*lid+1, 0)).r,
+            imageLoad(paletteData, ivec2(3*lid+2, 0)).r
+        );
+    }
+    memoryBarrierShared();
+    barrier();
+    if (any(greaterThanEqual(gid, imageSize(inputImage))))
+        return;
+    uvec4 img = imageLoad(inputImage, gid);
     switch (ditherLevel)
     {
         case 0 :
@@ -534,10 +1153,7 @@ void main()
     int index = 0;
     for (int i=0; i<paletteSize; i++)
     {
-        ivec3 d = ivec3(img);
-        d.x -= int(imageLoad(paletteData, ivec2(i*3,   0)).r);
-        d.y -= int(imageLoad(paletteData, ivec2(i*3+1, 0)).r);
-        d.z -= int(imageLoad(paletteData, ivec2(i*3+2, 0)).r);
+        ivec3 d = ivec3(img.rgb)-palette[i];
         int d2 = d.x*d.x + d.y*d.y + d.z*d.z;
         if (d2 < d2m)
         {
@@ -545,11 +1161,9 @@ void main()
             index = i;
         }
     }
-    uint r = imageLoad(paletteData, ivec2(index*3,   0)).r;
-    uint g = imageLoad(paletteData, ivec2(index*3+1, 0)).r;
-    uint b = imageLoad(paletteData, ivec2(index*3+2, 0)).r;
+    uvec3 color = uvec3(palette[index]);
     uint a = (alphaCutoff != -1) ? ((img.a >= alphaCutoff ? 255 : 0)) : img.a;
-    uvec4 newColor = uvec4(r,g,b,a);
+    uvec4 newColor = uvec4(color,a);
     if (indexMode == 1 && a == 0)
         index = paletteSize;
     else if (indexMode == 2)
@@ -569,6 +1183,23 @@ void main()
 //----------------------------------------------------------------------------//
 // Private member functions
 
+void OpenGLQuantizer::reserveSSBO(GLsizeiptr size)
+{
+    if (size <= ssboSize_)
+        return;
+    // The clustering error is reset on the seeding step, which is the only one
+    // requiring more storage, so there is no need to preserve it
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, clusteringError_);
+    glBufferData
+    (
+        GL_SHADER_STORAGE_BUFFER, 
+        size, 
+        NULL, 
+        GL_DYNAMIC_COPY
+    );
+    ssboSize_ = size;
+}
+
 void OpenGLQuantizer::quantizeOpenGLTexture
 (
     GLuint id,
@@ -585,6 +1216,7 @@ void OpenGLQuantizer::quantizeOpenGLTexture
 
     // Figure out which compute shaders to use based on input texture
     // internal format
+    OpenGLComputeShader* seedPalette;
     OpenGLComputeShader* findMaxSqrDistCol;
     OpenGLComputeShader* setNextPaletteCol;
     OpenGLComputeShader* buildClustersFromPalette;
@@ -592,6 +1224,7 @@ void OpenGLQuantizer::quantizeOpenGLTexture
     OpenGLComputeShader* quantizeInput;
     if(isFloat32)
     {
+        seedPalette = &computeShader_seedPaletteSF32;
         findMaxSqrDistCol = &computeShader_findMaxSqrDistColSF32;
         setNextPaletteCol = &computeShader_setNextPaletteColSF32;
         buildClustersFromPalette = 
@@ -602,6 +1235,7 @@ void OpenGLQuantizer::quantizeOpenGLTexture
     }
     else
     {
+        seedPalette = &computeShader_seedPaletteUI8;
         findMaxSqrDistCol = &computeShader_findMaxSqrDistColUI8;
         setNextPaletteCol = &computeShader_setNextPaletteColUI8;
         buildClustersFromPalette = 
@@ -737,8 +1371,12 @@ void OpenGLQuantizer::quantizeOpenGLTexture
             glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ssboBindingPoint_, 
                 clusteringError_);
             const char* ssboName = "ssbo";
+            seedPalette->bindShaderStorageBlock(ssboName, 
+                ssboBindingPoint_);
             findMaxSqrDistCol->bindShaderStorageBlock(ssboName, 
                 ssboBindingPoint_);
+            setNextPaletteCol->bindShaderStorageBlock(ssboName, 
+                ssboBindingPoint_);
             buildClustersFromPalette->bindShaderStorageBlock(ssboName, 
                 ssboBindingPoint_);
             updatePaletteFromClusters->bindShaderStorageBlock(ssboName, 
@@ -909,12 +1547,12 @@ void OpenGLQuantizer::quantizeOpenGLTexture
             "paletteSize", 
             paletteSize
         );
-        setNextPaletteCol->setUniformInt
+        buildClustersFromPalette->setUniformInt
         (
             "paletteSize", 
             paletteSize
         );
-        buildClustersFromPalette->setUniformInt
+        updatePaletteFromClusters->setUniformInt
         (
             "paletteSize", 
             paletteSize
@@ -974,16 +1612,78 @@ void OpenGLQuantizer::quantizeOpenGLTexture
     if (settings_.recalculatePalette || internalFormatChanged)
     {
         // Build initial palette
-
-        // I suspect that that the largest bottleneck is this first CPU-based 
-        // loop from which async OpenGL commands are issued. Is there a 
-        // smarter way?
-        if (settings_.reseedPalette || internalFormatChanged)
+        if 
+        (
+            (settings_.reseedPalette || internalFormatChanged) &&
+            mWidth*mHeight <= maxNPixelsSingleDispatchSeeding
+        )
+        {
+            // Seed the whole palette in a single dispatch (one work group
+            // looping over all palette colors), so that seeding costs one
+            // driver call regardless of the palette size
+            reserveSSBO(ssboHeaderSize+mWidth*mHeight*sizeof(uint32_t));
+            seedPalette->setUniformInt
+            (
+                "image", 
+                settings_.inputUnit
+            );
+            seedPalette->setUniformInt
+            (
+                "paletteData",
+                paletteDataUnit,
+                false
+            );
+            seedPalette->setUniformInt
+            (
+                "paletteSize",
+                paletteSize,
+                false
+            );
+            seedPalette->run(1, 1, 1);
+        }
+        else if (settings_.reseedPalette || internalFormatChanged)
         {
+            // For large images a single work group would leave most of the
+            // GPU idle, so two dispatches are issued per palette color 
+            // instead. Each work group of findMaxSqrDistCol writes its 
+            // furthest pixel to the SSBO, and setNextPaletteCol reduces these
+            // in a single work group
+            int nGroupsX = nTiles(mWidth);
+            int nGroupsY = nTiles(mHeight);
+            reserveSSBO(ssboHeaderSize+2*nGroupsX*nGroupsY*sizeof(uint32_t));
+            findMaxSqrDistCol->setUniformInt
+            (
+                "image", 
+                settings_.inputUnit
+            );
+            findMaxSqrDistCol->setUniformInt
+            (
+                "paletteData",
+                paletteDataUnit,
+                false
+            );
+            setNextPaletteCol->setUniformInt
+            (
+                "image", 
+                settings_.inputUnit
+            );
+            setNextPaletteCol->setUniformInt
+            (
+                "paletteData",
+                paletteDataUnit, 
+                false
+            );
+            setNextPaletteCol->setUniformInt
+            (
+                "nGroups",
+                nGroupsX*nGroupsY, 
+                false
+            );
             for (unsigned int counter = 0; counter < paletteSize; counter++)
             {
                 // Determine the pixel of the image which is the furthest away
                 // (in color-space) from the last palette color in paletteData
+                // (or initialize the palette data on the first counter)
                 findMaxSqrDistCol->setUniformInt
                 (
                     "counter", 
@@ -991,43 +1691,17 @@ void OpenGLQuantizer::quantizeOpenGLTexture
                 );
                 if (counter == 0)
                 {
-                    findMaxSqrDistCol->setUniformInt
-                    (
-                        "image", 
-                        settings_.inputUnit, 
-                        false
-                    );
-                    findMaxSqrDistCol->setUniformInt
-                    (
-                        "paletteData",
-                        paletteDataUnit,
-                        false
-                    );
+                    findMaxSqrDistCol->run(1, 1, 1);
+                    continue;
                 }
-                findMaxSqrDistCol->run(mWidth, mHeight, 1);
+                findMaxSqrDistCol->run(nGroupsX, nGroupsY, 1);
 
-                // Add the previously selected image pixel to the palette set,
-                // reset max distance
+                // Add the previously selected image pixel to the palette set
                 setNextPaletteCol->setUniformInt
                 (
                     "counter", 
                     counter
                 );
-                if (counter == 0)
-                {
-                    setNextPaletteCol->setUniformInt
-                    (
-                        "image", 
-                        settings_.inputUnit, 
-                        false
-                    );
-                    setNextPaletteCol->setUniformInt
-                    (
-                        "paletteData",
-                        paletteDataUnit, 
-                        false
-                    );
-                }
                 setNextPaletteCol->run(1, 1, 1);
             }
         }
@@ -1098,33 +1772,84 @@ void OpenGLQuantizer::quantizeOpenGLTexture
 
         // Run K-Means
         float sqErr0 = 3.0f*255.0f*255.0f*mWidth*mHeight;
-        auto sqErrPtr = new uint32_t;
         settings_.relTol = std::min(std::max(settings_.relTol, 0.0f), 1.0f);
-        while(true)
+        bool checkConvergenceOnDevice(settings_.maxIterations > 0);
+        updatePaletteFromClusters->setUniformInt
+        (
+            "checkConvergence", 
+            checkConvergenceOnDevice ? 1 : 0,
+            false
+        );
+        updatePaletteFromClusters->setUniformFloat
+        (
+            "relTol", 
+            settings_.relTol,
+            false
+        );
+
+        // Reset clustering error and convergence state (no sync required)
+        uint32_t ssboHeader[3] = {0, 0, 0};
+        std::memcpy(&ssboHeader[2], &sqErr0, sizeof(float));
+        glBufferSubData
+        (
+            GL_SHADER_STORAGE_BUFFER, 
+            0, 
+            ssboHeaderSize, 
+            ssboHeader
+        );
+        if (checkConvergenceOnDevice)
         {
-            // Cluster colors around current palette colors
-            buildClustersFromPalette->use();
-            buildClustersFromPalette->run(mWidth, mHeight, 1);
+            // Queue all iterations at once. Convergence is checked by 
+            // updatePaletteFromClusters, which flags it in the SSBO so that 
+            // all following dispatches return immediately. This way, the
+            // clustering error is never read back
+            for (unsigned int i=0; i<settings_.maxIterations; i++)
+            {
+                buildClustersFromPalette->use();
+                buildClustersFromPalette->run
+                (
+                    nTiles(mWidth), 
+                    nTiles(mHeight), 
+                    1
+                );
+                updatePaletteFromClusters->use();
+                updatePaletteFromClusters->run(1, 1, 1);
+            }
+        }
+        else
+        {
+            auto sqErrPtr = new uint32_t;
+            while(true)
+            {
+                // Cluster colors around current palette colors
+                buildClustersFromPalette->use();
+                buildClustersFromPalette->run
+                (
+                    nTiles(mWidth), 
+                    nTiles(mHeight), 
+                    1
+                );
 
-            // Read clustering error
-            glGetBufferSubData
-            (
-                GL_SHADER_STORAGE_BUFFER, 
-                0, 
-                sizeof(uint32_t), 
-                sqErrPtr
-            );
+                // Read clustering error
+                glGetBufferSubData
+                (
+                    GL_SHADER_STORAGE_BUFFER, 
+                    0, 
+                    sizeof(uint32_t), 
+                    sqErrPtr
+                );
 
-            // Quantize with currently available palette on break
-            if (*sqErrPtr >= (1.0f-settings_.relTol)*sqErr0)
-                break;
-            sqErr0 = *sqErrPtr;
-            
-            // Update palettes based on current clusters
-            updatePaletteFromClusters->use();
-            updatePaletteFromClusters->run(paletteSize, 1, 1);
+                // Quantize with currently available palette on break
+                if (*sqErrPtr >= (1.0f-settings_.relTol)*sqErr0)
+                    break;
+                sqErr0 = *sqErrPtr;
+                
+                // Update palettes based on current clusters
+                updatePaletteFromClusters->use();
+                updatePaletteFromClusters->run(1, 1, 1);
+            }
+            delete sqErrPtr;
         }
-        delete sqErrPtr;
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
         
         cumulatedPaletteRow_ = 
@@ -1237,7 +1962,7 @@ void OpenGLQuantizer::quantizeOpenGLTexture
         outputDataUnit
     );
     quantizeInput->use();
-    quantizeInput->run(width, height, 1);
+    quantizeInput->run(nTiles(width), nTiles(height), 1);
 
     OpenGLWaitSync();
 
@@ -1302,11 +2027,13 @@ OpenGLQuantizer::OpenGLQuantizer() //:
     // Compile compute shader stages
     if (!OpenGLQuantizer::computeShaderStagesCompiled)
     {
+        computeShader_seedPaletteSF32.compile();
         computeShader_findMaxSqrDistColSF32.compile();
         computeShader_setNextPaletteColSF32.compile();
         computeShader_buildClustersFromPaletteSF32.compile();
         computeShader_updatePaletteFromClustersSF32.compile();
         computeShader_quantizeInputSF32.compile();
+        computeShader_seedPaletteUI8.compile();
         computeShader_findMaxSqrDistColUI8.compile();
         computeShader_setNextPaletteColUI8.compile();
         computeShader_buildClustersFromPaletteUI8.compile();
@@ -1413,14 +2140,15 @@ OpenGLQuantizer::OpenGLQuantizer() //:
     // now using SSBOs
     glGenBuffers(1, &clusteringError_);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, clusteringError_);
-    uint32_t data(0);
+    uint32_t data[3] = {0, 0, 0};
     glBufferData
     (
         GL_SHADER_STORAGE_BUFFER, 
-        sizeof(uint32_t), 
-        &data, 
+        ssboHeaderSize, 
+        data, 
         GL_STATIC_READ
     );
+    ssboSize_ = ssboHeaderSize;
     ssboBindingPoint_ = findFreeSSBOBindingPoint();
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ssboBindingPoint_, 
         clusteringError_);
@@ -1,5 +1,6 @@
 #include "vpch.h"
 #include "vgraphics/vpostprocess/vquantizer.h"
+#include "vgraphics/vpostprocess/vcpuquantizer.h"
 #include "vgraphics/vpostprocess/vopengl/vopenglquantizer.h"
 
 namespace vir
@@ -25,8 +26,17 @@ std::unordered_map<DitherMode, std::string>
         {DitherMode::None, "None"}
     };
 
-Quantizer* Quantizer::create()
+std::unordered_map<Quantizer::Device, std::string> 
+    Quantizer::deviceToName = 
+    {
+        {Quantizer::Device::GPU, "GPU"},
+        {Quantizer::Device::CPU, "CPU"}
+    };
+
+Quantizer* Quantizer::create(Device device)
 {
+    if (device == Device::CPU)
+        return new CPUQuantizer();
     Window* window = nullptr;
     if (!GlobalPtr<Window>::valid(window))
         return nullptr;
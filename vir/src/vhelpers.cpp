@@ -17,6 +17,24 @@ void readFileToString(std::string filepath, std::string& target)
     sstream.str(std::string());
 }
 
+uint64_t hashFnv1a(const void* data, size_t size, uint64_t hash)
+{
+    auto bytes = (const unsigned char*)data;
+    for (size_t i=0; i<size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t hashFnv1a(const std::string& s, uint64_t hash)
+{
+    hash = hashFnv1a(s.data(), s.size(), hash);
+    hash ^= 0xff;
+    return hash*1099511628211ull;
+}
+
 }
 
 }
\ No newline at end of file
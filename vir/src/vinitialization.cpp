@@ -16,6 +16,7 @@ void initialize(const Settings& settings)
     {
         case PlatformType::GLFWOpenGL :
         {
+            GLFWWrapper::setHeadless(settings.headless);
             window = Window::initialize<GLFWOpenGLWindow>
             (
                 settings.width, 
@@ -46,6 +47,11 @@ void initialize(const Settings& settings)
     renderer->setDepthTesting(settings.enableDepthTesting);
     renderer->setBlending(settings.enableBlending);
     renderer->setFaceCulling(settings.enableFaceCulling);
+    Shader::setBinaryCache
+    (
+        settings.shaderBinaryCacheDirectory,
+        settings.shaderBinaryCacheMaxSize
+    );
     if (settings.initializeImGuiRenderer)
         vir::ImGuiRenderer::initialize();
 }
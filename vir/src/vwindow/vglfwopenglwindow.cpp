@@ -3,6 +3,7 @@
 #include "vtime/vglfwtime.h"
 #include "vgraphics/vcore/vbuffers.h"
 #include "vgraphics/vcore/vopengl/vopenglcontext.h"
+#include "vgraphics/vcore/vopengl/vopengloffscreeneglcontext.h"
 #include "thirdparty/stb/stb_image.h"
 
 namespace vir
@@ -36,6 +37,13 @@ GLFWOpenGLWindow::GLFWOpenGLWindow
         {4,0},
         {3,3} // <- I don't care about supporting OpenGL versions below this one
     };
+    // If headless, OSMesa contexts are tried first, as they do not require any
+    // GPU or render node. GLFW's own EGL contexts are not used, as they require
+    // a window surface, which cannot be created without a display server
+    int contextApi = 
+        GLFWWrapper::headless() ? 
+        GLFW_OSMESA_CONTEXT_API : 
+        GLFW_NATIVE_CONTEXT_API;
     for (auto glVersion : glVersions)
     {
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, glVersion.first);
@@ -43,6 +51,9 @@ GLFWOpenGLWindow::GLFWOpenGLWindow
         glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE); 
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
         glfwWindowHint(GLFW_TRANSPARENT_FRAMEBUFFER, GLFW_TRUE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, contextApi);
+        if (GLFWWrapper::headless())
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
         if (resizable)
             glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
         else
@@ -51,15 +62,44 @@ GLFWOpenGLWindow::GLFWOpenGLWindow
         if (glfwWindow_ != NULL)
             break;
     }
+    // Else, if headless, a context-less window is paired with an EGL context
+    // on Mesa's surfaceless platform
+    if (glfwWindow_ == NULL && GLFWWrapper::headless())
+    {
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        glfwWindow_ = glfwCreateWindow(width, height, name.c_str(), NULL, NULL);
+        if (glfwWindow_ != NULL)
+        {
+            eglContext_ = OffscreenEGLContext::create(glVersions, width, height);
+            if (eglContext_ == nullptr)
+            {
+                glfwDestroyWindow(glfwWindow_);
+                glfwWindow_ = NULL;
+            }
+        }
+    }
     if (glfwWindow_ == NULL)
     {
         glfwTerminate();
         throw std::runtime_error("Failed to create GLFW window");
     }
-    context_->initialize(glfwWindow_); 
+    if (eglContext_ != nullptr)
+        static_cast<OpenGLContext*>(context_)->initialize
+        (
+            glfwWindow_, 
+            OffscreenEGLContext::procAddress
+        );
+    else
+        context_->initialize(glfwWindow_); 
     setVSync(true);
 }
 
+GLFWOpenGLWindow::~GLFWOpenGLWindow()
+{
+    if (eglContext_ != nullptr)
+        delete eglContext_;
+}
+
 glm::vec2 GLFWOpenGLWindow::contentScale()
 {
     float x, y;
@@ -143,11 +183,14 @@ void GLFWOpenGLWindow::setIcon
 
 void GLFWOpenGLWindow::setVSync(bool state)
 {
+    VSync_ = state;
+    // There is nothing to be presented with an offscreen EGL context
+    if (eglContext_ != nullptr)
+        return;
     if (state)
         glfwSwapInterval(1);
     else
         glfwSwapInterval(0);
-    VSync_ = state;
 }
 
 void GLFWOpenGLWindow::setViewport(uint32_t vwidth, uint32_t vheight)
@@ -213,7 +256,7 @@ bool GLFWOpenGLWindow::isOpen()
 void GLFWOpenGLWindow::update(bool swapBuffers)
 {
     time_->update();
-    if (swapBuffers)
+    if (swapBuffers && eglContext_ == nullptr)
         glfwSwapBuffers(glfwWindow_);
     glfwPollEvents();
 }